@@ -1,8 +1,10 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <array>
 #include <string_view>
 #include <meow_enum.h>
+#include <meow/bytecode/super_ops.h>
 
 namespace meow {
 
@@ -78,6 +80,47 @@ enum class OpCode : uint8_t {
     JUMP_IF_GT_B, JUMP_IF_GE_B,
     JUMP_IF_LT_B, JUMP_IF_LE_B,
 
+    // --- Quickened (Interpreter tự ghi đè lúc chạy, cùng layout với bản generic) ---
+    ADD_II, SUB_II, MUL_II, ADD_FF, SUB_FF, MUL_FF,
+    ADD_II_B, SUB_II_B, MUL_II_B, ADD_FF_B, SUB_FF_B, MUL_FF_B,
+
+    EQ_II, NEQ_II, GT_II, GE_II, LT_II, LE_II,
+    EQ_II_B, NEQ_II_B, GT_II_B, GE_II_B, LT_II_B, LE_II_B,
+
+    JUMP_IF_EQ_II, JUMP_IF_NEQ_II,
+    JUMP_IF_GT_II, JUMP_IF_GE_II,
+    JUMP_IF_LT_II, JUMP_IF_LE_II,
+    JUMP_IF_EQ_II_B, JUMP_IF_NEQ_II_B,
+    JUMP_IF_GT_II_B, JUMP_IF_GE_II_B,
+    JUMP_IF_LT_II_B, JUMP_IF_LE_II_B,
+
+    GET_PROP_MONO,
+
+    // --- Register window: frame callee bắt đầu ngay tại arg_start của caller, không chép tham số ---
+    // masm chọn khi mọi register từ arg_start trở lên chết sau lệnh gọi; cùng layout với CALL / CALL_VOID
+    CALL_WINDOW, CALL_VOID_WINDOW,
+
+    // --- Immediate (hằng int16 nằm ngay trong lệnh, masm gộp từ LOAD_INT + phép toán) ---
+    ADD_I, SUB_I, MUL_I,
+    ADD_I_B, SUB_I_B, MUL_I_B,
+    EQ_I, NEQ_I, GT_I, GE_I, LT_I, LE_I,
+    EQ_I_B, NEQ_I_B, GT_I_B, GE_I_B, LT_I_B, LE_I_B,
+
+    JUMP_IF_EQ_I, JUMP_IF_NEQ_I,
+    JUMP_IF_GT_I, JUMP_IF_GE_I,
+    JUMP_IF_LT_I, JUMP_IF_LE_I,
+    JUMP_IF_EQ_I_B, JUMP_IF_NEQ_I_B,
+    JUMP_IF_GT_I_B, JUMP_IF_GE_I_B,
+    JUMP_IF_LT_I_B, JUMP_IF_LE_I_B,
+
+    // --- Superinstruction (masm gộp chuỗi lệnh, danh sách sinh bởi meow-supergen) ---
+    // Chỉ opcode của lệnh đầu bị thay, các lệnh sau vẫn nằm nguyên trong bytecode
+    #define MEOW_SUPER_ENUM2(NAME, ...) NAME,
+    #define MEOW_SUPER_ENUM3(NAME, ...) NAME,
+    MEOW_SUPER_OPS(MEOW_SUPER_ENUM2, MEOW_SUPER_ENUM3)
+    #undef MEOW_SUPER_ENUM2
+    #undef MEOW_SUPER_ENUM3
+
     TOTAL_OPCODES
 };
 
@@ -95,6 +138,7 @@ enum class ArgType : uint8_t {
     U16,        // Generic uint16 (Count, ArgStart...)
     U32,        // Generic uint32
     I64,        // Raw int64 (8 bytes) - Inline value
+    I16,        // Raw int16 (2 bytes) - Inline value (opcode _I)
     F64,        // Raw double (8 bytes) - Inline value
     OFFSET16,   // Jump offset (relative)
     OFFSET32,   // Jump offset (relative - long)
@@ -121,7 +165,7 @@ struct OpSchema {
         for (int i = 0; i < count; ++i) {
             switch (args[i]) {
                 case ArgType::REG8:  size += 1; break;
-                case ArgType::REG16: case ArgType::U16: 
+                case ArgType::REG16: case ArgType::U16: case ArgType::I16:
                 case ArgType::OFFSET16: case ArgType::CONST_IDX: size += 2; break;
                 case ArgType::U32: case ArgType::OFFSET32: size += 4; break;
                 case ArgType::I64: case ArgType::F64: size += 8; break;
@@ -135,4 +179,12 @@ struct OpSchema {
 const OpSchema& get_op_schema(OpCode op);
 OpInfo get_op_info(OpCode op);
 
+// Opcode quickened -> bản generic tương ứng, superinstruction -> lệnh đầu của chuỗi,
+// CALL_WINDOW -> CALL (opcode khác giữ nguyên). Ai đọc bytecode ngoài Interpreter (JIT, analysis, loader) nên quy về generic trước.
+OpCode generic_op(OpCode op);
+
+#define MEOW_SUPER_COUNT(...) + 1
+inline constexpr size_t SUPER_OP_COUNT = 0 MEOW_SUPER_OPS(MEOW_SUPER_COUNT, MEOW_SUPER_COUNT);
+#undef MEOW_SUPER_COUNT
+
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+// Sinh bởi meow-supergen (src/tools/supergen) - đừng sửa tay.
+// Nguồn: các vòng lặp trong docs/cg_vs_musttail.md (ADD + LT + JUMP), property/method call và vòng lặp đếm.
+// Sinh lại: meow-vm --profile-ngrams prof.txt <file> && meow-supergen prof.txt -o include/meow/bytecode/super_ops.h
+//
+// X2(NAME, A, A_BYTES, B)                  : A rồi B
+// X3(NAME, A, A_BYTES, B, B_BYTES, C)      : A rồi B rồi C
+// *_BYTES = get_op_info(op).operand_bytes (kể cả Inline Cache), kiểm bằng static_assert trong op_codes.cpp
+
+#pragma once
+
+#define MEOW_SUPER_OPS(X2, X3) \
+    X3(SUPER_ADD_B_LT_B_JUMP_IF_TRUE_B, ADD_B, 3, LT_B, 3, JUMP_IF_TRUE_B) \
+    X2(SUPER_LOAD_INT_B_ADD_B, LOAD_INT_B, 9, ADD_B) \
+    X2(SUPER_GET_PROP_INVOKE, GET_PROP, 86, INVOKE) \
+    X2(SUPER_INC_B_JUMP_IF_LT_B, INC_B, 1, JUMP_IF_LT_B) \
+    X2(SUPER_ADD_B_JUMP_IF_LT, ADD_B, 3, JUMP_IF_LT) \
+    X2(SUPER_MOVE_B_ADD_B, MOVE_B, 2, ADD_B)
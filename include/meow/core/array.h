@@ -4,6 +4,7 @@
 #include <meow/value.h>
 #include <meow/memory/gc_visitor.h>
 #include <meow/memory/memory_manager.h>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -92,6 +93,17 @@ public:
     template <typename Self>
     inline auto rend(this Self&& self) noexcept { return std::forward<Self>(self).elements_.rend(); }
 
-    void trace(GCVisitor& visitor) const noexcept override;
+    void trace(GCVisitor& visitor) noexcept override;
+
+    // Layout cho JIT: mã máy đọc begin/end của elements_ trực tiếp (size = (end - begin) / 8)
+    static size_t elements_data_offset() noexcept;
+    static size_t elements_end_offset() noexcept;
 };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+// libstdc++/libc++ đều đặt con trỏ begin rồi end ở đầu std::vector
+inline size_t ObjArray::elements_data_offset() noexcept { return offsetof(ObjArray, elements_); }
+inline size_t ObjArray::elements_end_offset() noexcept { return offsetof(ObjArray, elements_) + sizeof(value_t*); }
+#pragma GCC diagnostic pop
 }
\ No newline at end of file
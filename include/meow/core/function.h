@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -54,7 +55,7 @@ class ObjUpvalue : public ObjBase<ObjectType::UPVALUE> {
         return index_;
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) noexcept override;
 };
 
 class ObjFunctionProto : public ObjBase<ObjectType::PROTO> {
@@ -70,12 +71,22 @@ private:
     module_t module_ = nullptr;
     std::vector<UpvalueDesc> upvalue_descs_;
 
+    // --- JIT Tiering ---
+    uint32_t hotness_ = 0;        // Số lần được gọi (tier-up khi chạm JIT_THRESHOLD)
+    uint32_t backedges_ = 0;      // Số lần nhảy ngược trong Interpreter (OSR khi chạm JIT_OSR_THRESHOLD)
+    void* jit_entry_ = nullptr;   // jit::JitFunc (type-erased để core không phụ thuộc JIT)
+    bool jit_queued_ = false;     // Đang nằm trong hàng đợi compile nền
+    uint32_t deopt_count_ = 0;    // Số lần mã speculative bị deopt về Interpreter
+    std::vector<uint32_t> deopt_sites_; // Bytecode offset có guard đã fail (không speculate lại)
+    uint32_t dequickens_ = 0;     // Số lần opcode quickened bị ghi lại về bản generic
+
 public:
     explicit ObjFunctionProto(size_t registers, size_t upvalues, string_t name, chunk_t&& chunk) noexcept : num_registers_(registers), num_upvalues_(upvalues), name_(name), chunk_(std::move(chunk)) {
     }
     explicit ObjFunctionProto(size_t registers, size_t upvalues, string_t name, chunk_t&& chunk, std::vector<UpvalueDesc>&& descs) noexcept
         : num_registers_(registers), num_upvalues_(upvalues), name_(name), chunk_(std::move(chunk)), upvalue_descs_(std::move(descs)) {
     }
+    ~ObjFunctionProto() noexcept override;
 
     inline void set_module(module_t mod) noexcept { module_ = mod; }
     inline module_t get_module() const noexcept { return module_; }
@@ -104,7 +115,37 @@ public:
         return upvalue_descs_.size();
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    // JIT inline callee vào vùng register phía sau của caller -> frame phải đủ chỗ (chỉ tăng)
+    inline void reserve_registers(size_t count) noexcept {
+        if (count > num_registers_) num_registers_ = count;
+    }
+
+    inline uint32_t tick_hotness() noexcept { return ++hotness_; }
+    inline uint32_t get_hotness() const noexcept { return hotness_; }
+    inline void reset_hotness() noexcept { hotness_ = 0; backedges_ = 0; }
+
+    inline uint32_t tick_backedge() noexcept {
+        if (backedges_ != UINT32_MAX) ++backedges_;
+        return backedges_;
+    }
+
+    inline void* get_jit_entry() const noexcept { return jit_entry_; }
+    inline void set_jit_entry(void* entry) noexcept { jit_entry_ = entry; }
+    inline bool is_jit_queued() const noexcept { return jit_queued_; }
+    inline void set_jit_queued(bool queued) noexcept { jit_queued_ = queued; }
+
+    inline void record_deopt(uint32_t bc_offset) {
+        ++deopt_count_;
+        for (uint32_t site : deopt_sites_) if (site == bc_offset) return;
+        deopt_sites_.push_back(bc_offset);
+    }
+    inline uint32_t get_deopt_count() const noexcept { return deopt_count_; }
+    inline const std::vector<uint32_t>& get_deopt_sites() const noexcept { return deopt_sites_; }
+
+    inline void record_dequicken() noexcept { if (dequickens_ != UINT32_MAX) ++dequickens_; }
+    inline uint32_t get_dequicken_count() const noexcept { return dequickens_; }
+
+    void trace(visitor_t& visitor) noexcept override;
 };
 
 class ObjClosure : public ObjBase<ObjectType::FUNCTION> {
@@ -135,6 +176,14 @@ class ObjClosure : public ObjBase<ObjectType::FUNCTION> {
         return upvalues_.at(index);
     }
 
-    void trace(visitor_t& visitor) const noexcept override;
+    // Layout cho JIT: guard của hàm được inline so sánh proto_ trực tiếp
+    static size_t proto_offset() noexcept;
+
+    void trace(visitor_t& visitor) noexcept override;
 };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+inline size_t ObjClosure::proto_offset() noexcept { return offsetof(ObjClosure, proto_); }
+#pragma GCC diagnostic pop
 }
\ No newline at end of file
@@ -152,11 +152,11 @@ public:
     inline Iterator begin() { return Iterator(entries_, entries_ + capacity_); }
     inline Iterator end() { return Iterator(entries_ + capacity_, entries_ + capacity_); }
 
-    void trace(GCVisitor& visitor) const noexcept override {
+    void trace(GCVisitor& visitor) noexcept override {
         for (uint32_t i = 0; i < capacity_; i++) {
             if (entries_[i].first) {
                 visitor.visit_object(entries_[i].first);
-                visitor.visit_value(entries_[i].second);
+                visitor.visit_slot(entries_[i].second);
             }
         }
     }
@@ -23,7 +23,7 @@ struct MeowObject {
     explicit MeowObject(ObjectType type_tag) noexcept : type(type_tag) {}
     virtual ~MeowObject() = default;
     
-    virtual void trace(GCVisitor& visitor) const noexcept = 0;
+    virtual void trace(GCVisitor& visitor) noexcept = 0;
     
     inline ObjectType get_type() const noexcept { return type; }
     inline bool is_marked() const noexcept { return gc_state != GCState::UNMARKED; }
@@ -157,7 +157,7 @@ public:
     inline bool is_executed() const noexcept { return state == State::EXECUTED; }
 
     friend void obj_module_trace(const ObjModule* mod, visitor_t& visitor);
-    void trace(visitor_t& visitor) const noexcept override;
+    void trace(visitor_t& visitor) noexcept override;
     
     const auto& get_global_names_raw() const { return global_names_; }
     // Trả về map tên -> index để debug
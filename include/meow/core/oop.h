@@ -7,6 +7,7 @@
 #include <meow/memory/gc_visitor.h>
 #include <meow/core/shape.h>
 #include <meow_flat_map.h>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -49,7 +50,7 @@ public:
         methods_[name] = value;
     }
 
-    void trace(GCVisitor& visitor) const noexcept override;
+    void trace(GCVisitor& visitor) noexcept override;
 };
 
 class ObjInstance : public ObjBase<ObjectType::INSTANCE> {
@@ -92,15 +93,26 @@ public:
 
     inline size_t get_field_count() const noexcept { return fields_.size(); }
 
-    inline void trace(GCVisitor& visitor) const noexcept override {
+    // Layout cho JIT inline cache: mã máy đọc shape_ và fields_.data() trực tiếp
+    static size_t shape_offset() noexcept;
+    static size_t fields_data_offset() noexcept;
+
+    inline void trace(GCVisitor& visitor) noexcept override {
         visitor.visit_object(klass_);
         visitor.visit_object(shape_);
-        for (const auto& val : fields_) {
-            visitor.visit_value(val);
+        for (auto& val : fields_) {
+            visitor.visit_slot(val);
         }
     }
 };
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+inline size_t ObjInstance::shape_offset() noexcept { return offsetof(ObjInstance, shape_); }
+// libstdc++/libc++ đều đặt con trỏ begin ở đầu std::vector
+inline size_t ObjInstance::fields_data_offset() noexcept { return offsetof(ObjInstance, fields_); }
+#pragma GCC diagnostic pop
+
 class ObjBoundMethod : public ObjBase<ObjectType::BOUND_METHOD> {
 private:
     Value receiver_; 
@@ -112,9 +124,9 @@ public:
     inline Value get_receiver() const noexcept { return receiver_; }
     inline Value get_method() const noexcept { return method_; }
 
-    inline void trace(GCVisitor& visitor) const noexcept override {
-        visitor.visit_value(receiver_);
-        visitor.visit_value(method_);
+    inline void trace(GCVisitor& visitor) noexcept override {
+        visitor.visit_slot(receiver_);
+        visitor.visit_slot(method_);
     }
 };
 }
\ No newline at end of file
@@ -42,7 +42,7 @@ public:
         property_offsets_[name] = num_fields_++;
     }
 
-    void trace(GCVisitor& visitor) const noexcept override;
+    void trace(GCVisitor& visitor) noexcept override;
 };
 
 }
\ No newline at end of file
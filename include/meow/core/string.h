@@ -33,7 +33,7 @@ public:
 
     inline char get(size_t index) const noexcept { return chars_[index]; }
 
-    inline void trace(GCVisitor&) const noexcept override {}
+    inline void trace(GCVisitor&) noexcept override {}
 };
 
 struct ObjStringHasher {
@@ -0,0 +1,28 @@
+/**
+ * @file ngram_profile.h
+ * @brief Đếm cặp / bộ ba opcode Interpreter chạy liền nhau (nguồn cho meow-supergen)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace meow::diagnostics {
+
+    // Bật bằng `meow-vm --profile-ngrams <file>` trước khi chạy: Interpreter dispatch qua bảng có đếm,
+    // superinstruction được tách lại thành từng lệnh nên profile luôn nói về chuỗi lệnh generic
+    void enable_ngram_profile() noexcept;
+    bool ngram_profile_enabled() noexcept;
+
+    // ip trỏ vào opcode sắp chạy. Chỉ tính n-gram khi lệnh này nằm ngay sau lệnh trước
+    // (rơi xuống, không nhảy / gọi / return); opcode quickened được quy về bản generic.
+    void record_ngram(const uint8_t* ip) noexcept;
+
+    /**
+     * @brief Ghi profile dạng text, mỗi dòng `<count> <OP> <OP> [<OP>]`, giảm dần theo count
+     * @return false nếu không mở được file
+     */
+    bool write_ngram_profile(const std::filesystem::path& path);
+
+} // namespace meow::diagnostics
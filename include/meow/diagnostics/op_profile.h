@@ -0,0 +1,68 @@
+/**
+ * @file op_profile.h
+ * @brief Đếm số lần chạy và thời gian (TSC) của từng opcode trong Interpreter
+ *
+ * Interpreter có bảng dispatch thứ hai gồm các op_wrapper có đo: bật profile thì bảng này được
+ * chép đè lên dispatch_table, tắt thì chép lại bảng thường -> lúc tắt không tốn gì.
+ * Bật / tắt được giữa chừng (`system.profile(true)`), lệnh kế tiếp đã dùng bảng mới.
+ * Chỉ đo Interpreter: mã máy của JIT không đi qua dispatch. Handler tự chạy cả frame
+ * (nhảy ngược OSR vào mã máy, native gọi lại script) được tính cả phần đó vào opcode của nó.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace meow {
+class ObjFunctionProto;
+}
+
+namespace meow::diagnostics {
+
+    enum class ProfileFormat { Table, Json };
+
+    // per_site: đếm thêm theo (proto, offset), chậm hơn nhiều (tra bảng băm mỗi lệnh)
+    void set_op_profile(bool enabled, bool per_site = false) noexcept;
+    bool op_profile_enabled() noexcept;
+    void reset_op_profile() noexcept;
+
+    // Table: xếp giảm dần theo thời gian; Json: {"unit", "total_count", "total_ticks", "ops": [...], "sites": [...]}
+    std::string op_profile_report(ProfileFormat format);
+    bool write_op_profile(const std::filesystem::path& path, ProfileFormat format);
+
+    namespace detail {
+        struct OpCounter {
+            uint64_t count = 0;
+            uint64_t ticks = 0;
+        };
+        extern std::array<OpCounter, 256> op_counters;
+        extern bool op_per_site;
+    }
+
+    [[gnu::always_inline]]
+    inline uint64_t op_clock() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    [[gnu::always_inline]]
+    inline void record_op(uint8_t op, uint64_t ticks) noexcept {
+        detail::op_counters[op].count++;
+        detail::op_counters[op].ticks += ticks;
+    }
+
+    // op_ip trỏ vào opcode trong chunk của proto
+    void record_op_site(ObjFunctionProto* proto, const uint8_t* op_ip) noexcept;
+
+} // namespace meow::diagnostics
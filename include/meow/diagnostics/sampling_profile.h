@@ -0,0 +1,37 @@
+/**
+ * @file sampling_profile.h
+ * @brief Sampling profiler: SIGPROF định kỳ, lấy mẫu call stack của script ở safe point
+ *
+ * Signal handler chỉ chép bảng "sample" lên dispatch_table của Interpreter (vài trăm store, an toàn
+ * trong signal). Lệnh kế tiếp vào stub: trả lại bảng cũ, đi call_stack_ tới frame_ptr_, map IP ->
+ * tên proto + dòng (Chunk::get_line_info), rồi chạy lệnh như thường. Thời gian trong mã JIT / native
+ * được tính cho lệnh interpreter chạy ngay sau đó.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace meow {
+struct ExecutionContext;
+}
+
+namespace meow::diagnostics {
+
+    // interval tính theo CPU time của process. false nếu nền tảng không có setitimer / SIGPROF
+    bool start_sampling(uint32_t interval_us = 1000) noexcept;
+    void stop_sampling() noexcept;
+
+    // Gọi từ Interpreter ở safe point; ip trỏ vào opcode sắp chạy của frame trên cùng.
+    // Có cấp phát (stack mới, hàm mới trong bảng) nên không noexcept
+    void record_sample(const ExecutionContext& ctx, const uint8_t* ip);
+
+    // Mỗi dòng `root;caller;callee <samples>`, frame = `tên:dòng` (đưa thẳng vào flamegraph.pl)
+    bool write_folded_stacks(const std::filesystem::path& path);
+
+    // Bảng self / total theo hàm, giảm dần theo self
+    std::string sampling_report();
+
+} // namespace meow::diagnostics
@@ -6,14 +6,26 @@
 
 namespace meow {
 struct MeowObject;
+class Nursery;
 
 namespace gc_flags {
     static constexpr uint32_t GEN_YOUNG = 0;       // Bit 0 = 0
     static constexpr uint32_t GEN_OLD   = 1 << 0;  // Bit 0 = 1
     static constexpr uint32_t MARKED    = 1 << 1;  // Bit 1 = 1
     static constexpr uint32_t PERMANENT = 1 << 2;  // Bit 2 = 1
+    static constexpr uint32_t FORWARDED = 1 << 3;  // Object nursery đã copy đi, next_gc trỏ meta bản mới
+    static constexpr uint32_t PINNED    = 1 << 4;  // Object nursery bị native stack tham chiếu, không được dời
+    static constexpr uint32_t REMEMBERED = 1 << 5; // Object old đã nằm trong remembered set
 }
 
+// Ngân sách (micro giây) cho mỗi lát đánh dấu incremental của Major GC. 0 = đánh dấu xong trong một lần dừng
+void set_gc_slice_budget(uint32_t micros) noexcept;
+uint32_t gc_slice_budget() noexcept;
+
+// Số thread phụ đánh dấu song song (ngoài thread chạy VM). Mặc định min(số core, 8) - 1, 0 = tuần tự
+void set_gc_worker_threads(uint32_t threads) noexcept;
+uint32_t gc_worker_threads() noexcept;
+
 class GarbageCollector {
 protected:
     meow::heap* heap_ = nullptr;
@@ -25,5 +37,13 @@ public:
     virtual void register_permanent(const MeowObject* object) = 0;
     virtual size_t collect() noexcept = 0;
     virtual void write_barrier(MeowObject*, Value) noexcept {}
+    // Ghi nhiều slot của owner một lúc (import module...): coi như mọi slot đều vừa bị ghi
+    virtual void write_barrier_bulk(MeowObject*) noexcept {}
+
+    // Một lát công việc incremental, gọi xen giữa các lần cấp phát. true = cần collect() để chốt chu kỳ
+    virtual bool step() noexcept { return false; }
+
+    // GC nào có vùng bump-pointer cho object trẻ thì trả về, MemoryManager cấp phát thẳng từ đó
+    virtual Nursery* nursery() noexcept { return nullptr; }
 };
 }
\ No newline at end of file
@@ -12,5 +12,15 @@ struct GCVisitor {
     virtual ~GCVisitor() = default;
     virtual void visit_value(param_t value) noexcept = 0;
     virtual void visit_object(const MeowObject* object) noexcept = 0;
+
+    // Slot có thể bị ghi lại: GC copy (nursery) trả về địa chỉ mới của object đã được dời đi.
+    // visit_value/visit_object thì không sửa được tham chiếu -> object gặp qua đó bị ghim tại chỗ.
+    virtual void visit_slot(Value& slot) noexcept = 0;
+    virtual MeowObject* visit_movable(MeowObject* object) noexcept = 0;
+
+    template <typename T>
+    void visit_slot(T*& slot) noexcept {
+        if (slot) slot = static_cast<T*>(visit_movable(slot));
+    }
 };
-}
\ No newline at end of file
+}
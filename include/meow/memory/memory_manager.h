@@ -7,6 +7,7 @@
 #include <meow/core/objects.h>
 #include <meow/common.h>
 #include <meow/memory/garbage_collector.h>
+#include <meow/memory/nursery.h>
 #include <meow/core/shape.h>
 #include <meow/core/string.h>
 #include <meow/core/function.h>
@@ -50,11 +51,14 @@ public:
     
     void collect() noexcept { object_allocated_ = gc_->collect(); }
 
+    // Không bỏ qua khi GC tạm dừng: tham chiếu old -> young tạo lúc đó vẫn phải vào remembered set
     [[gnu::always_inline]]
     void write_barrier(MeowObject* owner, Value value) noexcept {
-        if (gc_pause_count_ == 0) {
-            gc_->write_barrier(owner, value);
-        }
+        gc_->write_barrier(owner, value);
+    }
+
+    void write_barrier_bulk(MeowObject* owner) noexcept {
+        gc_->write_barrier_bulk(owner);
     }
 
     static void set_current(MemoryManager* instance) noexcept { current_ = instance; }
@@ -88,6 +92,7 @@ private:
     meow::heap heap_; 
 
     std::unique_ptr<GarbageCollector> gc_;
+    Nursery* nursery_ = nullptr;
     meow::hash_map<string_t, string_t, StringPoolHash, StringPoolEq> string_pool_;
     
     Shape* empty_shape_ = nullptr;
@@ -96,11 +101,47 @@ private:
     size_t object_allocated_;
     size_t gc_pause_count_ = 0;
 
+    // Cấp phát qua free-list cứ mỗi GC_STEP_INTERVAL lần thì cho GC chạy một lát đánh dấu
+    static constexpr size_t GC_STEP_INTERVAL = 1024;
+    size_t step_countdown_ = GC_STEP_INTERVAL;
+
+    // Chỉ các object không bị JIT/inline cache giữ con trỏ thô mới được sinh trong nursery (GC sẽ dời chúng)
+    template <typename T>
+    static constexpr bool is_movable_v = std::is_same_v<T, ObjArray> || std::is_same_v<T, ObjInstance> ||
+                                         std::is_same_v<T, ObjClosure> || std::is_same_v<T, ObjBoundMethod> ||
+                                         std::is_same_v<T, ObjUpvalue> || std::is_same_v<T, ObjHashTable>;
+
+    // Giữ buffer bên trong (vector, bảng entry của hash table) -> chết trong nursery vẫn phải gọi destructor
+    template <typename T>
+    static constexpr bool needs_finalizer_v = std::is_same_v<T, ObjArray> || std::is_same_v<T, ObjInstance> ||
+                                              std::is_same_v<T, ObjClosure> || std::is_same_v<T, ObjHashTable>;
+
     template <typename T, typename... Args>
     T* new_object(Args&&... args) {
-        if (object_allocated_ >= gc_threshold_ && gc_pause_count_ == 0) {
-            collect();
-            gc_threshold_ = std::max(gc_threshold_ * 2, object_allocated_ * 2);
+        if constexpr (is_movable_v<T>) {
+            if (nursery_) [[likely]] {
+                void* mem = nursery_->allocate(sizeof(T));
+                if (mem == nullptr && gc_pause_count_ == 0) {
+                    collect();
+                    mem = nursery_->allocate(sizeof(T));
+                }
+                if (mem) [[likely]] {
+                    T* obj = ::new (mem) T(std::forward<Args>(args)...);
+                    if constexpr (needs_finalizer_v<T>) nursery_->add_finalizable(obj);
+                    return obj;
+                }
+                // GC đang tạm dừng và nursery đầy: rơi xuống free-list như cũ
+            }
+        }
+
+        if (gc_pause_count_ == 0) {
+            if (object_allocated_ >= gc_threshold_) {
+                collect();
+                gc_threshold_ = std::max(gc_threshold_ * 2, object_allocated_ * 2);
+            } else if (--step_countdown_ == 0) {
+                step_countdown_ = GC_STEP_INTERVAL;
+                if (gc_->step()) collect();
+            }
         }
         
         T* obj = heap_.create<T>(std::forward<Args>(args)...);
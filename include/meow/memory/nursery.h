@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "meow_heap.h"
+
+namespace meow {
+struct MeowObject;
+
+// Vùng cấp phát bump-pointer cho object trẻ (Minor GC kiểu Cheney).
+// Layout giống meow::heap: ObjectMeta đứng ngay trước data -> get_meta()/write barrier không cần phân biệt.
+// Minor GC copy object còn sống ra old gen rồi bỏ cả vùng, nên chi phí tỉ lệ với dữ liệu sống chứ không với rác.
+// Object bị ghim (tham chiếu từ native stack) ở lại tại chỗ, lần cấp phát sau đi vòng qua chúng.
+class Nursery {
+public:
+    static constexpr size_t DEFAULT_SIZE = 4 * 1024 * 1024;
+    static constexpr size_t GRANULE = 16;
+
+    explicit Nursery(size_t size = DEFAULT_SIZE);
+    ~Nursery() noexcept;
+
+    Nursery(const Nursery&) = delete;
+    Nursery& operator=(const Nursery&) = delete;
+
+    // Trả về con trỏ data (meta đã điền sẵn), nullptr khi hết chỗ -> caller chạy GC rồi thử lại
+    [[nodiscard]] [[gnu::always_inline]] void* allocate(size_t data_size) noexcept {
+        const size_t total = align_up(sizeof(ObjectMeta) + data_size);
+        if (static_cast<size_t>(limit_ - top_) < total) [[unlikely]] {
+            return allocate_slow(data_size);
+        }
+        return carve(data_size, total);
+    }
+
+    [[nodiscard]] bool contains(const void* ptr) const noexcept {
+        auto* p = static_cast<const std::byte*>(ptr);
+        return p >= begin_ && p < end_;
+    }
+
+    // Con trỏ bất kỳ (kể cả trỏ vào giữa object) -> object chứa nó, nullptr nếu không trúng object nào
+    [[nodiscard]] MeowObject* find_object(const void* addr) const noexcept;
+
+    // Object trẻ sở hữu bộ nhớ malloc (vector...) cần gọi destructor khi chết
+    void add_finalizable(MeowObject* object) { finalizable_.push_back(object); }
+    std::vector<MeowObject*>& finalizable() noexcept { return finalizable_; }
+
+    // Bỏ toàn bộ vùng trừ các object bị ghim (meta sắp theo địa chỉ tăng dần)
+    void reset(const std::vector<ObjectMeta*>& pinned) noexcept;
+
+    [[nodiscard]] size_t capacity() const noexcept { return static_cast<size_t>(end_ - begin_); }
+
+private:
+    struct Hole {
+        std::byte* begin;
+        std::byte* end;
+    };
+
+    std::byte* begin_ = nullptr;
+    std::byte* end_ = nullptr;
+    std::byte* top_ = nullptr;
+    std::byte* limit_ = nullptr;
+
+    std::vector<Hole> holes_;
+    size_t next_hole_ = 0;
+
+    // 1 bit / GRANULE: bit bật tại ô chứa ObjectMeta đầu object
+    std::vector<uint64_t> starts_;
+    std::vector<MeowObject*> finalizable_;
+
+    static constexpr size_t align_up(size_t n) noexcept {
+        return (n + GRANULE - 1) & ~(GRANULE - 1);
+    }
+
+    [[gnu::always_inline]] void* carve(size_t data_size, size_t total) noexcept {
+        auto* meta = reinterpret_cast<ObjectMeta*>(top_);
+        meta->next_gc = nullptr;
+        meta->size = static_cast<uint32_t>(data_size);
+        meta->flags = 0;
+
+        const size_t granule = static_cast<size_t>(top_ - begin_) / GRANULE;
+        starts_[granule >> 6] |= uint64_t{1} << (granule & 63);
+
+        top_ += total;
+        return heap::get_data(meta);
+    }
+
+    void* allocate_slow(size_t data_size) noexcept;
+};
+}
@@ -109,6 +109,8 @@ public:
     // --- Accessors ---
     [[nodiscard]] MEOW_ALWAYS_INLINE const KeyContainer& keys() const noexcept { return keys_; }
     [[nodiscard]] MEOW_ALWAYS_INLINE const ValueContainer& values() const noexcept { return values_; }
+    // Sửa value tại chỗ không đụng tới thứ tự key (GC cập nhật tham chiếu sau khi dời object)
+    [[nodiscard]] MEOW_ALWAYS_INLINE ValueContainer& values() noexcept { return values_; }
 
     [[nodiscard]] MEOW_ALWAYS_INLINE bool empty() const noexcept { return keys_.empty(); }
     [[nodiscard]] MEOW_ALWAYS_INLINE size_type size() const noexcept { return keys_.size(); }
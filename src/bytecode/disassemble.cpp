@@ -60,7 +60,7 @@ std::pair<std::string, size_t> disassemble_instruction(const Chunk& chunk, size_
 
     std::format_to(std::back_inserter(line), "{:<16}", op_name);
 
-    switch (op) {
+    switch (generic_op(op)) { // Tên in theo opcode thật, operand giải mã theo bản generic
         // --- CONSTANTS ---
         case OpCode::LOAD_CONST: {
             uint16_t dst = read_u16(code, ip);
@@ -157,6 +157,26 @@ std::pair<std::string, size_t> disassemble_instruction(const Chunk& chunk, size_
             break;
         }
 
+        // --- IMMEDIATE (int16 trong lệnh) ---
+        case OpCode::ADD_I: case OpCode::SUB_I: case OpCode::MUL_I:
+        case OpCode::EQ_I: case OpCode::NEQ_I: case OpCode::GT_I: case OpCode::GE_I:
+        case OpCode::LT_I: case OpCode::LE_I: {
+            uint16_t dst = read_u16(code, ip);
+            uint16_t r1 = read_u16(code, ip);
+            int16_t imm = read_as<int16_t>(code, ip);
+            std::format_to(std::back_inserter(line), "r{}, r{}, #{}", dst, r1, imm);
+            break;
+        }
+        case OpCode::ADD_I_B: case OpCode::SUB_I_B: case OpCode::MUL_I_B:
+        case OpCode::EQ_I_B: case OpCode::NEQ_I_B: case OpCode::GT_I_B: case OpCode::GE_I_B:
+        case OpCode::LT_I_B: case OpCode::LE_I_B: {
+            uint8_t dst = read_u8(code, ip);
+            uint8_t r1 = read_u8(code, ip);
+            int16_t imm = read_as<int16_t>(code, ip);
+            std::format_to(std::back_inserter(line), "r{}, r{}, #{}", dst, r1, imm);
+            break;
+        }
+
         // --- UNARY (STANDARD) ---
         case OpCode::NEG: case OpCode::NOT: case OpCode::BIT_NOT: {
             uint16_t dst = read_u16(code, ip);
@@ -271,6 +291,26 @@ std::pair<std::string, size_t> disassemble_instruction(const Chunk& chunk, size_
             break;
         }
 
+        // --- FUSED JUMPS (immediate) ---
+        case OpCode::JUMP_IF_EQ_I: case OpCode::JUMP_IF_NEQ_I:
+        case OpCode::JUMP_IF_GT_I: case OpCode::JUMP_IF_GE_I:
+        case OpCode::JUMP_IF_LT_I: case OpCode::JUMP_IF_LE_I: {
+            uint16_t r1 = read_u16(code, ip);
+            int16_t imm = read_as<int16_t>(code, ip);
+            uint16_t off = read_u16(code, ip);
+            std::format_to(std::back_inserter(line), "r{}, #{} ? -> {:04d}", r1, imm, off);
+            break;
+        }
+        case OpCode::JUMP_IF_EQ_I_B: case OpCode::JUMP_IF_NEQ_I_B:
+        case OpCode::JUMP_IF_GT_I_B: case OpCode::JUMP_IF_GE_I_B:
+        case OpCode::JUMP_IF_LT_I_B: case OpCode::JUMP_IF_LE_I_B: {
+            uint8_t r1 = read_u8(code, ip);
+            int16_t imm = read_as<int16_t>(code, ip);
+            uint16_t off = read_u16(code, ip);
+            std::format_to(std::back_inserter(line), "r{}, #{} ? -> {:04d}", r1, imm, off);
+            break;
+        }
+
         // --- CALLS  ---
         case OpCode::CALL: {
             uint16_t dst = read_u16(code, ip);
@@ -203,7 +203,7 @@ static Result<void, LoaderErrorCode> patch_chunk_globals_recursive(module_t mod,
     }
 
     while (ip < size) {
-        OpCode op = static_cast<OpCode>(code[ip]);
+        OpCode op = generic_op(static_cast<OpCode>(code[ip])); // Superinstruction -> lệnh đầu
         
         // GET_GLOBAL(reg16, idx) -> idx ở byte 3,4 (ip+3)
         // SET_GLOBAL(idx, reg16) -> idx ở byte 1,2 (ip+1)
@@ -31,6 +31,9 @@ public:
     Result<proto_t, LoaderErrorCode> load_module();
     static Result<void, LoaderErrorCode> link_module(module_t module);
 
+    // Mọi proto trong file theo thứ tự xuất hiện (AOT image đánh index theo thứ tự này)
+    const std::vector<proto_t>& protos() const noexcept { return loaded_protos_; }
+
 private:
     MemoryManager* heap_;
     const std::vector<uint8_t>& data_;
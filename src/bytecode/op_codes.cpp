@@ -14,6 +14,7 @@ namespace {
     constexpr auto u16    = U16;
     constexpr auto u32    = U32;
     constexpr auto i64    = I64;
+    constexpr auto i16    = I16;
     constexpr auto f64    = F64;
     
     constexpr auto off16  = OFFSET16;
@@ -38,7 +39,7 @@ namespace {
 
 } // namespace
 
-static constexpr auto OP_TABLE = make_table(
+static constexpr auto BASE_TABLE = make_table(
     // 1. CORE
     def(NOP),
     def(HALT),
@@ -174,9 +175,131 @@ static constexpr auto OP_TABLE = make_table(
     def(JUMP_IF_GT_B,   reg8, reg8, off16),
     def(JUMP_IF_GE_B,   reg8, reg8, off16),
     def(JUMP_IF_LT_B,   reg8, reg8, off16),
-    def(JUMP_IF_LE_B,   reg8, reg8, off16)
+    def(JUMP_IF_LE_B,   reg8, reg8, off16),
+
+    // Quickened (không bao giờ được sinh ra bởi compiler/masm)
+    def(ADD_II,         reg16, reg16, reg16),
+    def(SUB_II,         reg16, reg16, reg16),
+    def(MUL_II,         reg16, reg16, reg16),
+    def(ADD_FF,         reg16, reg16, reg16),
+    def(SUB_FF,         reg16, reg16, reg16),
+    def(MUL_FF,         reg16, reg16, reg16),
+    def(ADD_II_B,       reg8, reg8, reg8),
+    def(SUB_II_B,       reg8, reg8, reg8),
+    def(MUL_II_B,       reg8, reg8, reg8),
+    def(ADD_FF_B,       reg8, reg8, reg8),
+    def(SUB_FF_B,       reg8, reg8, reg8),
+    def(MUL_FF_B,       reg8, reg8, reg8),
+
+    def(EQ_II,          reg16, reg16, reg16),
+    def(NEQ_II,         reg16, reg16, reg16),
+    def(GT_II,          reg16, reg16, reg16),
+    def(GE_II,          reg16, reg16, reg16),
+    def(LT_II,          reg16, reg16, reg16),
+    def(LE_II,          reg16, reg16, reg16),
+    def(EQ_II_B,        reg8, reg8, reg8),
+    def(NEQ_II_B,       reg8, reg8, reg8),
+    def(GT_II_B,        reg8, reg8, reg8),
+    def(GE_II_B,        reg8, reg8, reg8),
+    def(LT_II_B,        reg8, reg8, reg8),
+    def(LE_II_B,        reg8, reg8, reg8),
+
+    def(JUMP_IF_EQ_II,  reg16, reg16, off16),
+    def(JUMP_IF_NEQ_II, reg16, reg16, off16),
+    def(JUMP_IF_GT_II,  reg16, reg16, off16),
+    def(JUMP_IF_GE_II,  reg16, reg16, off16),
+    def(JUMP_IF_LT_II,  reg16, reg16, off16),
+    def(JUMP_IF_LE_II,  reg16, reg16, off16),
+    def(JUMP_IF_EQ_II_B,  reg8, reg8, off16),
+    def(JUMP_IF_NEQ_II_B, reg8, reg8, off16),
+    def(JUMP_IF_GT_II_B,  reg8, reg8, off16),
+    def(JUMP_IF_GE_II_B,  reg8, reg8, off16),
+    def(JUMP_IF_LT_II_B,  reg8, reg8, off16),
+    def(JUMP_IF_LE_II_B,  reg8, reg8, off16),
+
+    def(GET_PROP_MONO,  reg16, reg16, idx),
+
+    def(CALL_WINDOW,      reg16, reg16, u16, u16),
+    def(CALL_VOID_WINDOW, reg16, u16, u16),
+
+    // Immediate: toán hạng phải là hằng int16
+    def(ADD_I,          reg16, reg16, i16),
+    def(SUB_I,          reg16, reg16, i16),
+    def(MUL_I,          reg16, reg16, i16),
+    def(ADD_I_B,        reg8, reg8, i16),
+    def(SUB_I_B,        reg8, reg8, i16),
+    def(MUL_I_B,        reg8, reg8, i16),
+
+    def(EQ_I,           reg16, reg16, i16),
+    def(NEQ_I,          reg16, reg16, i16),
+    def(GT_I,           reg16, reg16, i16),
+    def(GE_I,           reg16, reg16, i16),
+    def(LT_I,           reg16, reg16, i16),
+    def(LE_I,           reg16, reg16, i16),
+    def(EQ_I_B,         reg8, reg8, i16),
+    def(NEQ_I_B,        reg8, reg8, i16),
+    def(GT_I_B,         reg8, reg8, i16),
+    def(GE_I_B,         reg8, reg8, i16),
+    def(LT_I_B,         reg8, reg8, i16),
+    def(LE_I_B,         reg8, reg8, i16),
+
+    def(JUMP_IF_EQ_I,   reg16, i16, off16),
+    def(JUMP_IF_NEQ_I,  reg16, i16, off16),
+    def(JUMP_IF_GT_I,   reg16, i16, off16),
+    def(JUMP_IF_GE_I,   reg16, i16, off16),
+    def(JUMP_IF_LT_I,   reg16, i16, off16),
+    def(JUMP_IF_LE_I,   reg16, i16, off16),
+    def(JUMP_IF_EQ_I_B,   reg8, i16, off16),
+    def(JUMP_IF_NEQ_I_B,  reg8, i16, off16),
+    def(JUMP_IF_GT_I_B,   reg8, i16, off16),
+    def(JUMP_IF_GE_I_B,   reg8, i16, off16),
+    def(JUMP_IF_LT_I_B,   reg8, i16, off16),
+    def(JUMP_IF_LE_I_B,   reg8, i16, off16)
 );
 
+// Byte của Inline Cache nằm ngay sau operand
+static constexpr uint8_t ic_bytes(OpCode op) {
+    constexpr uint8_t IC_SIZE = 80;
+    switch (op) {
+        case CALL: case CALL_VOID: case TAIL_CALL:
+            return 16; // CallIC
+        case GET_PROP: case SET_PROP: case INVOKE:
+            return IC_SIZE;
+        default:
+            return 0;
+    }
+}
+
+// Superinstruction mang operand (và IC) của lệnh đầu, các lệnh sau tự giải mã như thường
+static constexpr auto OP_TABLE = [] {
+    auto table = BASE_TABLE;
+    auto super = [&](OpCode op, OpCode first) {
+        OpSchema schema = table[static_cast<size_t>(first)];
+        schema.name = meow::enum_name(op);
+        table[static_cast<size_t>(op)] = schema;
+    };
+    #define MEOW_SUPER_SCHEMA2(NAME, A, ...) super(NAME, A);
+    #define MEOW_SUPER_SCHEMA3(NAME, A, ...) super(NAME, A);
+    MEOW_SUPER_OPS(MEOW_SUPER_SCHEMA2, MEOW_SUPER_SCHEMA3)
+    #undef MEOW_SUPER_SCHEMA2
+    #undef MEOW_SUPER_SCHEMA3
+    return table;
+}();
+
+static_assert(static_cast<size_t>(TOTAL_OPCODES) <= 256, "OpCode phải vừa 1 byte");
+
+// Handler superinstruction so IP trả về với IP ngay sau lệnh: số byte trong super_ops.h phải khớp schema
+#define MEOW_OPERAND_BYTES(OP) (BASE_TABLE[static_cast<size_t>(OP)].get_operand_bytes() + ic_bytes(OP))
+#define MEOW_SUPER_CHECK2(NAME, A, A_BYTES, B) \
+    static_assert(MEOW_OPERAND_BYTES(A) == A_BYTES, #NAME ": operand bytes của " #A " lệch, chạy lại meow-supergen");
+#define MEOW_SUPER_CHECK3(NAME, A, A_BYTES, B, B_BYTES, C) \
+    MEOW_SUPER_CHECK2(NAME, A, A_BYTES, B) \
+    static_assert(MEOW_OPERAND_BYTES(B) == B_BYTES, #NAME ": operand bytes của " #B " lệch, chạy lại meow-supergen");
+MEOW_SUPER_OPS(MEOW_SUPER_CHECK2, MEOW_SUPER_CHECK3)
+#undef MEOW_SUPER_CHECK2
+#undef MEOW_SUPER_CHECK3
+#undef MEOW_OPERAND_BYTES
+
 const OpSchema& get_op_schema(OpCode op) {
     if (static_cast<size_t>(op) >= OP_TABLE.size()) {
         static const OpSchema EMPTY;
@@ -187,27 +310,44 @@ const OpSchema& get_op_schema(OpCode op) {
 
 OpInfo get_op_info(OpCode op) {
     const auto& s = get_op_schema(op);
-    uint8_t size = s.get_operand_bytes();
-
-    constexpr uint8_t IC_SIZE = 80;
+    uint8_t size = s.get_operand_bytes() + ic_bytes(generic_op(op));
+    return { s.count, size };
+}
 
+OpCode generic_op(OpCode op) {
     switch (op) {
-        case OpCode::CALL: 
-        case OpCode::CALL_VOID:
-        case OpCode::TAIL_CALL: 
-            size += 16; // CallIC
-            break;
-            
-        case OpCode::GET_PROP: 
-        case OpCode::SET_PROP:
-        case OpCode::INVOKE:
-            size += IC_SIZE; 
-            break;
-            
-        default: break;
+        case ADD_II: case ADD_FF: return ADD;
+        case SUB_II: case SUB_FF: return SUB;
+        case MUL_II: case MUL_FF: return MUL;
+        case ADD_II_B: case ADD_FF_B: return ADD_B;
+        case SUB_II_B: case SUB_FF_B: return SUB_B;
+        case MUL_II_B: case MUL_FF_B: return MUL_B;
+
+        case EQ_II: return EQ;   case EQ_II_B: return EQ_B;
+        case NEQ_II: return NEQ; case NEQ_II_B: return NEQ_B;
+        case GT_II: return GT;   case GT_II_B: return GT_B;
+        case GE_II: return GE;   case GE_II_B: return GE_B;
+        case LT_II: return LT;   case LT_II_B: return LT_B;
+        case LE_II: return LE;   case LE_II_B: return LE_B;
+
+        case JUMP_IF_EQ_II: return JUMP_IF_EQ;   case JUMP_IF_EQ_II_B: return JUMP_IF_EQ_B;
+        case JUMP_IF_NEQ_II: return JUMP_IF_NEQ; case JUMP_IF_NEQ_II_B: return JUMP_IF_NEQ_B;
+        case JUMP_IF_GT_II: return JUMP_IF_GT;   case JUMP_IF_GT_II_B: return JUMP_IF_GT_B;
+        case JUMP_IF_GE_II: return JUMP_IF_GE;   case JUMP_IF_GE_II_B: return JUMP_IF_GE_B;
+        case JUMP_IF_LT_II: return JUMP_IF_LT;   case JUMP_IF_LT_II_B: return JUMP_IF_LT_B;
+        case JUMP_IF_LE_II: return JUMP_IF_LE;   case JUMP_IF_LE_II_B: return JUMP_IF_LE_B;
+
+        case GET_PROP_MONO: return GET_PROP;
+
+        case CALL_WINDOW: return CALL;
+        case CALL_VOID_WINDOW: return CALL_VOID;
+
+        #define MEOW_SUPER_FIRST(NAME, A, ...) case NAME: return A;
+        MEOW_SUPER_OPS(MEOW_SUPER_FIRST, MEOW_SUPER_FIRST)
+        #undef MEOW_SUPER_FIRST
+
+        default: return op;
     }
-    
-    return { s.count, size };
 }
 
 } // namespace meow
\ No newline at end of file
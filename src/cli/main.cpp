@@ -3,10 +3,16 @@
 #include <print>
 #include <vector>
 #include <string>
+#include <charconv>
 
 #include <meow/machine.h>
 #include <meow/config.h>
 #include <meow/masm/utils.h> 
+#include <meow/diagnostics/ngram_profile.h>
+#include <meow/diagnostics/op_profile.h>
+#include <meow/diagnostics/sampling_profile.h>
+#include <meow/memory/garbage_collector.h>
+#include "aot/native_image.h"
 
 namespace fs = std::filesystem;
 using namespace meow;
@@ -16,6 +22,13 @@ void print_usage() {
     std::println(stderr, "Options:");
     std::println(stderr, "  -b, --bytecode    Run pre-compiled bytecode (.meowc) [Default]");
     std::println(stderr, "  -c, --compile     Compile and run source assembly (.meowb/.asm)");
+    std::println(stderr, "      --aot         Write native code images (.meowx) next to loaded modules");
+    std::println(stderr, "      --profile-ngrams <out>  Count opcode pairs/triples and write them to <out> (input for meow-supergen)");
+    std::println(stderr, "      --profile-ops <out>     Per-opcode counts and TSC ticks; <out> = '-' (stderr), *.json or text table");
+    std::println(stderr, "      --profile-sites         With --profile-ops: also count per function/offset");
+    std::println(stderr, "      --profile-samples <out> Sample script call stacks (SIGPROF, 1ms) into folded stacks <out>");
+    std::println(stderr, "      --gc-slice-us <n>       Incremental major GC: max microseconds per marking slice (0 = stop-the-world)");
+    std::println(stderr, "      --gc-threads <n>        Extra threads for parallel marking (default: cores - 1, max 7; 0 = single-threaded)");
     std::println(stderr, "  -v, --version     Show version info");
     std::println(stderr, "  -h, --help        Show this help message");
 }
@@ -47,6 +60,53 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    // Option không phụ thuộc mode, đứng trước mode/file
+    std::string ngram_out;
+    std::string ops_out;
+    std::string samples_out;
+    bool profile_sites = false;
+    while (!args.empty() && (args[0] == "--aot" || args[0] == "--profile-sites" || args[0] == "--profile-ngrams" ||
+                             args[0] == "--profile-ops" || args[0] == "--profile-samples" ||
+                             args[0] == "--gc-slice-us" || args[0] == "--gc-threads")) {
+        if (args[0] == "--aot" || args[0] == "--profile-sites") {
+            if (args[0] == "--aot") jit::aot::set_write_images(true);
+            else profile_sites = true;
+            args.erase(args.begin());
+            continue;
+        }
+        if (args.size() < 2) {
+            std::println(stderr, "Error: Missing argument for {}.", args[0]);
+            return 1;
+        }
+        if (args[0] == "--gc-slice-us" || args[0] == "--gc-threads") {
+            uint32_t value = 0;
+            auto [end, ec] = std::from_chars(args[1].data(), args[1].data() + args[1].size(), value);
+            if (ec != std::errc{} || end != args[1].data() + args[1].size()) {
+                std::println(stderr, "Error: Invalid value for {}: {}", args[0], args[1]);
+                return 1;
+            }
+            if (args[0] == "--gc-slice-us") set_gc_slice_budget(value);
+            else set_gc_worker_threads(value);
+        } else if (args[0] == "--profile-ngrams") {
+            ngram_out = args[1];
+            diagnostics::enable_ngram_profile();
+        } else if (args[0] == "--profile-ops") {
+            ops_out = args[1];
+        } else {
+            samples_out = args[1];
+        }
+        args.erase(args.begin(), args.begin() + 2);
+    }
+    if (!ops_out.empty()) diagnostics::set_op_profile(true, profile_sites);
+    if (!samples_out.empty() && !diagnostics::start_sampling()) {
+        std::println(stderr, "Error: Sampling profiler is not supported on this platform.");
+        return 1;
+    }
+    if (args.empty()) {
+        print_usage();
+        return 1;
+    }
+
     Mode mode = Mode::Bytecode;
     std::string input_file;
 
@@ -98,9 +158,13 @@ int main(int argc, char* argv[]) {
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
-        if (arg == "-b" || arg == "--bytecode" || arg == "-c" || arg == "--compile") {
+        if (arg == "-b" || arg == "--bytecode" || arg == "-c" || arg == "--compile" || arg == "--aot" || arg == "--profile-sites") {
             continue; 
         }
+        if (arg == "--profile-ngrams" || arg == "--profile-ops" || arg == "--profile-samples") {
+            ++i;
+            continue;
+        }
         clean_argv.push_back(argv[i]);
     }
 
@@ -110,6 +174,28 @@ int main(int argc, char* argv[]) {
     
     Machine vm(root_dir, entry_file, static_cast<int>(clean_argv.size()), clean_argv.data()); 
     vm.interpret();
+    diagnostics::stop_sampling();
+
+    if (!ngram_out.empty() && !diagnostics::write_ngram_profile(ngram_out)) {
+        std::println(stderr, "Error: Cannot write n-gram profile to '{}'.", ngram_out);
+        return 1;
+    }
+    if (!samples_out.empty()) {
+        if (!diagnostics::write_folded_stacks(samples_out)) {
+            std::println(stderr, "Error: Cannot write folded stacks to '{}'.", samples_out);
+            return 1;
+        }
+        std::print(stderr, "{}", diagnostics::sampling_report());
+    }
+    if (!ops_out.empty()) {
+        const auto format = ops_out.ends_with(".json") ? diagnostics::ProfileFormat::Json : diagnostics::ProfileFormat::Table;
+        if (ops_out == "-") {
+            std::print(stderr, "{}", diagnostics::op_profile_report(format));
+        } else if (!diagnostics::write_op_profile(ops_out, format)) {
+            std::println(stderr, "Error: Cannot write opcode profile to '{}'.", ops_out);
+            return 1;
+        }
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -31,7 +31,7 @@ Shape* Shape::add_transition(string_t name, MemoryManager* heap) {
     return new_shape;
 }
 
-void Shape::trace(GCVisitor& visitor) const noexcept {
+void Shape::trace(GCVisitor& visitor) noexcept {
     const auto& prop_keys = property_offsets_.keys();
     for (auto key : prop_keys) {
         visitor.visit_object(key);
@@ -0,0 +1,90 @@
+#include <meow/diagnostics/ngram_profile.h>
+#include <meow/bytecode/op_codes.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace meow::diagnostics {
+
+namespace {
+
+    // Interpreter chạy trên một thread (thread compile nền không chạy handler) -> không cần khóa
+    struct NgramProfile {
+        std::array<uint8_t, 256> generic{};  // Opcode -> bản generic (quickened, superinstruction)
+        std::array<uint16_t, 256> length{};  // Opcode -> tổng số byte của lệnh
+
+        std::vector<uint64_t> pairs = std::vector<uint64_t>(256 * 256, 0);
+        std::unordered_map<uint32_t, uint64_t> triples;
+
+        const uint8_t* fall_through = nullptr; // IP ngay sau lệnh vừa chạy
+        int prev = -1;                         // Lệnh vừa chạy
+        int prev2 = -1;                        // Lệnh trước đó (-1 nếu không liền mạch)
+
+        NgramProfile() {
+            for (size_t op = 0; op < 256; ++op) {
+                generic[op] = static_cast<uint8_t>(generic_op(static_cast<OpCode>(op)));
+                length[op] = static_cast<uint16_t>(1 + get_op_info(static_cast<OpCode>(op)).operand_bytes);
+            }
+        }
+    };
+
+    std::atomic<bool> g_enabled{false};
+    std::unique_ptr<NgramProfile> g_profile;
+
+} // namespace
+
+void enable_ngram_profile() noexcept {
+    if (!g_profile) g_profile = std::make_unique<NgramProfile>();
+    g_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool ngram_profile_enabled() noexcept { return g_enabled.load(std::memory_order_relaxed); }
+
+void record_ngram(const uint8_t* ip) noexcept {
+    NgramProfile& p = *g_profile;
+    const int op = p.generic[*ip];
+
+    if (ip == p.fall_through && p.prev >= 0) {
+        ++p.pairs[(p.prev << 8) | op];
+        if (p.prev2 >= 0) ++p.triples[(static_cast<uint32_t>(p.prev2) << 16) | (p.prev << 8) | op];
+        p.prev2 = p.prev;
+    } else {
+        p.prev2 = -1;
+    }
+    p.prev = op;
+    p.fall_through = ip + p.length[*ip];
+}
+
+bool write_ngram_profile(const std::filesystem::path& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    if (!g_profile) return true;
+
+    struct Row {
+        uint64_t count;
+        uint32_t key;
+        int arity;
+    };
+    std::vector<Row> rows;
+    for (uint32_t key = 0; key < g_profile->pairs.size(); ++key) {
+        if (g_profile->pairs[key]) rows.push_back({g_profile->pairs[key], key, 2});
+    }
+    for (const auto& [key, count] : g_profile->triples) rows.push_back({count, key, 3});
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.count > b.count; });
+
+    auto name = [](uint32_t op) { return meow::enum_name(static_cast<OpCode>(op & 0xFF)); };
+    out << "# meow-vm opcode n-grams: <count> <OP> <OP> [<OP>]\n";
+    for (const Row& r : rows) {
+        out << r.count;
+        for (int i = r.arity - 1; i >= 0; --i) out << ' ' << name(r.key >> (8 * i));
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace meow::diagnostics
@@ -0,0 +1,154 @@
+#include <meow/diagnostics/op_profile.h>
+#include <meow/bytecode/op_codes.h>
+#include <meow/core/function.h>
+#include <meow/core/string.h>
+#include "vm/interpreter.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace meow::diagnostics {
+
+namespace detail {
+    std::array<OpCounter, 256> op_counters{};
+    bool op_per_site = false;
+}
+
+namespace {
+
+    struct Site {
+        std::string proto; // Chép tên ngay lần đầu: proto có thể bị GC trước khi in report
+        uint32_t offset;
+        uint8_t op;
+        uint64_t count = 0;
+    };
+
+    struct SiteKey {
+        const void* proto;
+        uint32_t offset;
+        bool operator==(const SiteKey&) const = default;
+    };
+
+    struct SiteKeyHash {
+        size_t operator()(const SiteKey& k) const noexcept {
+            return std::hash<const void*>{}(k.proto) ^ (static_cast<size_t>(k.offset) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    bool g_enabled = false;
+    std::unordered_map<SiteKey, Site, SiteKeyHash> g_sites;
+
+    std::string json_escape(std::string_view s) {
+        std::string out;
+        out.reserve(s.size());
+        for (char c : s) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) out += std::format("\\u{:04x}", c);
+                    else out += c;
+            }
+        }
+        return out;
+    }
+
+    std::string_view op_name(uint8_t op) { return meow::enum_name(static_cast<OpCode>(op)); }
+
+} // namespace
+
+void set_op_profile(bool enabled, bool per_site) noexcept {
+    g_enabled = enabled;
+    detail::op_per_site = enabled && per_site;
+    Interpreter::select_dispatch(enabled);
+}
+
+bool op_profile_enabled() noexcept { return g_enabled; }
+
+void reset_op_profile() noexcept {
+    detail::op_counters.fill({});
+    g_sites.clear();
+}
+
+void record_op_site(ObjFunctionProto* proto, const uint8_t* op_ip) noexcept {
+    const uint32_t offset = static_cast<uint32_t>(op_ip - proto->get_chunk().get_code());
+    auto [it, inserted] = g_sites.try_emplace(SiteKey{proto, offset});
+    if (inserted) {
+        string_t name = proto->get_name();
+        it->second = Site{name ? std::string(name->c_str(), name->size()) : std::string("<anonymous>"), offset, *op_ip};
+    }
+    it->second.count++;
+}
+
+std::string op_profile_report(ProfileFormat format) {
+    uint64_t total_count = 0, total_ticks = 0;
+    std::vector<uint8_t> ops;
+    for (size_t op = 0; op < 256; ++op) {
+        const auto& c = detail::op_counters[op];
+        if (!c.count) continue;
+        ops.push_back(static_cast<uint8_t>(op));
+        total_count += c.count;
+        total_ticks += c.ticks;
+    }
+    std::sort(ops.begin(), ops.end(), [](uint8_t a, uint8_t b) {
+        return detail::op_counters[a].ticks > detail::op_counters[b].ticks;
+    });
+
+    std::vector<const Site*> sites;
+    sites.reserve(g_sites.size());
+    for (const auto& [key, site] : g_sites) sites.push_back(&site);
+    std::sort(sites.begin(), sites.end(), [](const Site* a, const Site* b) { return a->count > b->count; });
+
+    auto percent = [](uint64_t part, uint64_t whole) { return whole ? 100.0 * part / whole : 0.0; };
+    std::string out;
+
+    if (format == ProfileFormat::Json) {
+        out += std::format("{{\"unit\": \"tsc\", \"total_count\": {}, \"total_ticks\": {}, \"ops\": [", total_count, total_ticks);
+        for (size_t i = 0; i < ops.size(); ++i) {
+            const auto& c = detail::op_counters[ops[i]];
+            out += std::format("{}\n  {{\"op\": \"{}\", \"count\": {}, \"ticks\": {}, \"avg_ticks\": {:.1f}}}",
+                               i ? "," : "", op_name(ops[i]), c.count, c.ticks, static_cast<double>(c.ticks) / c.count);
+        }
+        out += "\n], \"sites\": [";
+        for (size_t i = 0; i < sites.size(); ++i) {
+            const Site& s = *sites[i];
+            out += std::format("{}\n  {{\"proto\": \"{}\", \"offset\": {}, \"op\": \"{}\", \"count\": {}}}",
+                               i ? "," : "", json_escape(s.proto), s.offset, op_name(s.op), s.count);
+        }
+        out += "\n]}\n";
+        return out;
+    }
+
+    out += std::format("{:<36} {:>14} {:>7} {:>16} {:>7} {:>10}\n", "opcode", "count", "%", "ticks (tsc)", "%", "avg");
+    for (uint8_t op : ops) {
+        const auto& c = detail::op_counters[op];
+        out += std::format("{:<36} {:>14} {:>6.2f}% {:>16} {:>6.2f}% {:>10.1f}\n", op_name(op),
+                           c.count, percent(c.count, total_count), c.ticks, percent(c.ticks, total_ticks),
+                           static_cast<double>(c.ticks) / c.count);
+    }
+    out += std::format("{:<36} {:>14} {:>7} {:>16}\n", "total", total_count, "", total_ticks);
+
+    if (!sites.empty()) {
+        constexpr size_t MAX_TABLE_SITES = 32; // JSON in đủ
+        out += std::format("\n{:<32} {:>8} {:<36} {:>14}\n", "proto", "offset", "opcode", "count");
+        for (size_t i = 0; i < std::min(sites.size(), MAX_TABLE_SITES); ++i) {
+            const Site& s = *sites[i];
+            out += std::format("{:<32} {:>8} {:<36} {:>14}\n", s.proto, s.offset, op_name(s.op), s.count);
+        }
+    }
+    return out;
+}
+
+bool write_op_profile(const std::filesystem::path& path, ProfileFormat format) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << op_profile_report(format);
+    return static_cast<bool>(out);
+}
+
+} // namespace meow::diagnostics
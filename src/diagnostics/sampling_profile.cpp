@@ -0,0 +1,159 @@
+#include <meow/diagnostics/sampling_profile.h>
+#include <meow/core/function.h>
+#include <meow/core/string.h>
+#include "runtime/execution_context.h"
+#include "vm/interpreter.h"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/time.h>
+#define MEOW_HAS_SIGPROF 1
+#else
+#define MEOW_HAS_SIGPROF 0
+#endif
+
+namespace meow::diagnostics {
+
+namespace {
+
+    struct Frame {
+        std::string function; // Tên proto
+        std::string label;    // `tên:dòng`
+    };
+
+    struct SampleProfile {
+        std::unordered_map<std::string, uint64_t> stacks;      // folded stack -> số mẫu
+        std::unordered_map<std::string, uint64_t> self;        // hàm ở đỉnh stack
+        std::unordered_map<std::string, uint64_t> total;       // hàm có mặt trong stack
+        uint64_t samples = 0;
+    };
+
+    // Bộ đệm dùng lại giữa các mẫu: string giữ capacity nên mẫu bình thường chỉ cấp phát khi gặp stack mới
+    struct Scratch {
+        std::vector<Frame> frames;   // Chỉ lớn lên, phần [0, depth) là stack của mẫu hiện tại
+        std::string folded;
+    };
+
+    SampleProfile g_profile;
+    Scratch g_scratch;
+    bool g_running = false;
+
+    // Không cache theo địa chỉ proto: proto có thể bị GC rồi proto khác nằm đúng chỗ đó.
+    // Tên chép lại mỗi mẫu, dòng tra thẳng trong bảng line của chunk (binary search)
+    void resolve(function_t function, const uint8_t* ip, Frame& out) {
+        proto_t proto = function->get_proto();
+        const Chunk& chunk = proto->get_chunk();
+        // Frame do Machine::execute dựng (native gọi lại script) không lưu return IP của caller
+        const bool in_chunk = ip >= chunk.get_code() && ip < chunk.get_code() + chunk.get_code_size();
+
+        string_t name = proto->get_name();
+        if (name) out.function.assign(name->c_str(), name->size());
+        else out.function.assign("<anonymous>");
+
+        out.label.assign(out.function);
+        const LineInfo* line = in_chunk ? chunk.get_line_info(static_cast<size_t>(ip - chunk.get_code())) : nullptr;
+        if (line) std::format_to(std::back_inserter(out.label), ":{}", line->line);
+    }
+
+#if MEOW_HAS_SIGPROF
+    void on_sigprof(int) { Interpreter::arm_sample(); }
+#endif
+
+} // namespace
+
+bool start_sampling(uint32_t interval_us) noexcept {
+#if MEOW_HAS_SIGPROF
+    struct sigaction sa {};
+    sa.sa_handler = on_sigprof;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGPROF, &sa, nullptr) != 0) return false;
+
+    itimerval timer{};
+    timer.it_interval.tv_sec = interval_us / 1'000'000;
+    timer.it_interval.tv_usec = interval_us % 1'000'000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) return false;
+    g_scratch.frames.reserve(64);
+    g_scratch.folded.reserve(1024);
+    g_running = true;
+    return true;
+#else
+    (void)interval_us;
+    return false;
+#endif
+}
+
+void stop_sampling() noexcept {
+#if MEOW_HAS_SIGPROF
+    if (!g_running) return;
+    itimerval timer{};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    std::signal(SIGPROF, SIG_IGN);
+    g_running = false;
+#endif
+}
+
+void record_sample(const ExecutionContext& ctx, const uint8_t* ip) {
+    // IP của frame i: frame trên cùng là lệnh sắp chạy, frame dưới là return IP lưu ở frame con (trừ 1 -> lệnh CALL)
+    auto& frames = g_scratch.frames;
+    size_t depth = 0;
+    for (const CallFrame* frame = ctx.call_stack_; frame <= ctx.frame_ptr_; ++frame) {
+        if (!frame->function_) continue;
+        const uint8_t* frame_ip = frame == ctx.frame_ptr_ ? ip : (frame + 1)->ip_ ? (frame + 1)->ip_ - 1 : nullptr;
+        if (depth == frames.size()) frames.emplace_back();
+        resolve(frame->function_, frame_ip, frames[depth++]);
+    }
+    if (depth == 0) return;
+
+    std::string& folded = g_scratch.folded;
+    folded.clear();
+    for (size_t i = 0; i < depth; ++i) {
+        if (i) folded += ';';
+        folded += frames[i].label;
+        // Đệ quy: mỗi hàm chỉ tính total một lần cho một mẫu (stack nông nên dò tuyến tính)
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; ++j) seen = frames[j].function == frames[i].function;
+        if (!seen) g_profile.total[frames[i].function]++;
+    }
+    g_profile.stacks[folded]++;
+    g_profile.self[frames[depth - 1].function]++;
+    g_profile.samples++;
+}
+
+bool write_folded_stacks(const std::filesystem::path& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    for (const auto& [stack, count] : g_profile.stacks) out << stack << ' ' << count << '\n';
+    return static_cast<bool>(out);
+}
+
+std::string sampling_report() {
+    std::vector<std::pair<std::string_view, uint64_t>> rows(g_profile.total.begin(), g_profile.total.end());
+    auto self_of = [](std::string_view fn) {
+        auto it = g_profile.self.find(std::string(fn));
+        return it == g_profile.self.end() ? uint64_t{0} : it->second;
+    };
+    std::sort(rows.begin(), rows.end(), [&](const auto& a, const auto& b) {
+        uint64_t sa = self_of(a.first), sb = self_of(b.first);
+        return sa != sb ? sa > sb : a.second > b.second;
+    });
+
+    auto percent = [](uint64_t part) { return g_profile.samples ? 100.0 * part / g_profile.samples : 0.0; };
+    std::string out = std::format("{:<40} {:>10} {:>7} {:>10} {:>7}\n", "function", "self", "%", "total", "%");
+    for (const auto& [fn, total] : rows) {
+        const uint64_t self = self_of(fn);
+        out += std::format("{:<40} {:>10} {:>6.2f}% {:>10} {:>6.2f}%\n", fn, self, percent(self), total, percent(total));
+    }
+    out += std::format("{} samples\n", g_profile.samples);
+    return out;
+}
+
+} // namespace meow::diagnostics
@@ -1,31 +1,363 @@
-#include <vector>
-#include <cstddef>
-#include <cstdint>
-#include "meow/bytecode/op_codes.h"
+#include "analysis/bytecode_analysis.h"
+#include <algorithm>
+#include <cstring>
 
 namespace meow::jit::analysis {
 
-    struct LoopInfo {
-        size_t start_ip;
-        size_t end_ip;
+// --- 1. Instruction ---
+
+OperandEffects operand_effects(OpCode op, std::span<const int64_t> operands) {
+    OperandEffects fx;
+
+    auto reg_at = [&](size_t i) -> uint16_t {
+        return i < operands.size() ? static_cast<uint16_t>(operands[i]) : NO_REG;
+    };
+    auto use = [&](size_t i) { if (uint16_t r = reg_at(i); r != NO_REG) fx.uses.push_back(r); };
+    auto def = [&](size_t i) { if (uint16_t r = reg_at(i); r != NO_REG) fx.def = r; };
+    auto use_range = [&](size_t start_i, size_t count_i, size_t stride) {
+        if (count_i >= operands.size()) return;
+        uint16_t start = reg_at(start_i);
+        size_t count = static_cast<size_t>(operands[count_i]) * stride;
+        for (size_t k = 0; k < count; ++k) fx.uses.push_back(static_cast<uint16_t>(start + k));
+    };
+
+    switch (op) {
+        // Đọc rồi ghi chính nó
+        case OpCode::INC: case OpCode::DEC: case OpCode::INC_B: case OpCode::DEC_B:
+            use(0); def(0);
+            return fx;
+
+        // Gọi hàm: callee + dải tham số liên tiếp
+        case OpCode::CALL:      use(1); use_range(2, 3, 1); def(0); return fx;
+        case OpCode::TAIL_CALL: use(1); use_range(2, 3, 1); return fx; // Kết quả về thẳng caller
+        case OpCode::CALL_VOID: use(0); use_range(1, 2, 1); return fx;
+        case OpCode::INVOKE:    use(1); use_range(3, 4, 1); def(0); return fx;
+
+        // Khởi tạo collection từ dải register
+        case OpCode::NEW_ARRAY: use_range(1, 2, 1); def(0); return fx;
+        case OpCode::NEW_HASH:  use_range(1, 2, 2); def(0); return fx; // cặp key/value
+
+        // Chỉ đọc (operand đầu không phải đích)
+        case OpCode::SET_INDEX: case OpCode::SET_PROP: case OpCode::SET_METHOD:
+        case OpCode::INHERIT:   case OpCode::SET_GLOBAL: case OpCode::SET_UPVALUE:
+        case OpCode::EXPORT:    case OpCode::RETURN: case OpCode::THROW: case OpCode::IMPORT_ALL:
+            break;
+
+        // Operand là mốc register chứ không phải giá trị (CLOSE_UPVALUES),
+        // hoặc register lỗi chỉ được ghi khi nhảy vào catch (SETUP_TRY)
+        case OpCode::CLOSE_UPVALUES: case OpCode::SETUP_TRY:
+            return fx;
+
+        default: {
+            // Quy tắc chung: operand register đầu tiên là đích, trừ lệnh nhảy (chỉ đọc)
+            const OpSchema& schema = get_op_schema(op);
+            bool is_branch = false;
+            for (uint8_t i = 0; i < schema.count; ++i) {
+                if (schema.args[i] == ArgType::OFFSET16 || schema.args[i] == ArgType::OFFSET32) is_branch = true;
+            }
+            bool first = !is_branch;
+            for (uint8_t i = 0; i < schema.count; ++i) {
+                if (schema.args[i] != ArgType::REG8 && schema.args[i] != ArgType::REG16) continue;
+                if (first) { def(i); first = false; }
+                else use(i);
+            }
+            return fx;
+        }
+    }
+
+    // Các lệnh chỉ đọc: mọi operand register đều là use
+    const OpSchema& schema = get_op_schema(op);
+    for (uint8_t i = 0; i < schema.count; ++i) {
+        if (schema.args[i] == ArgType::REG8 || schema.args[i] == ArgType::REG16) use(i);
+    }
+    return fx;
+}
+
+bool is_function_exit(OpCode op) {
+    return op == OpCode::RETURN || op == OpCode::HALT || op == OpCode::THROW || op == OpCode::TAIL_CALL;
+}
+
+std::vector<int64_t> read_operands(const uint8_t* bytecode, size_t ip) {
+    const OpSchema& schema = get_op_schema(static_cast<OpCode>(bytecode[ip]));
+    std::vector<int64_t> operands;
+    size_t p = ip + 1;
+    for (uint8_t i = 0; i < schema.count; ++i) {
+        switch (schema.args[i]) {
+            case ArgType::REG8:
+                operands.push_back(bytecode[p]); p += 1;
+                break;
+            case ArgType::REG16: case ArgType::U16: case ArgType::CONST_IDX: {
+                uint16_t v; std::memcpy(&v, bytecode + p, 2); p += 2;
+                operands.push_back(v);
+                break;
+            }
+            case ArgType::OFFSET16: case ArgType::I16: {
+                int16_t off; std::memcpy(&off, bytecode + p, 2); p += 2;
+                operands.push_back(off);
+                break;
+            }
+            case ArgType::U32: case ArgType::OFFSET32: {
+                uint32_t v; std::memcpy(&v, bytecode + p, 4); p += 4;
+                operands.push_back(v);
+                break;
+            }
+            case ArgType::I64: case ArgType::F64: {
+                int64_t v; std::memcpy(&v, bytecode + p, 8); p += 8;
+                operands.push_back(v);
+                break;
+            }
+            default: break;
+        }
+    }
+    return operands;
+}
+
+DecodedCode decode(const uint8_t* bytecode, size_t len) {
+    DecodedCode code;
+    std::vector<size_t> targets; // Bytecode offset đích (NO_INDEX nếu không nhảy)
+    std::vector<size_t> nexts;
+
+    std::vector<int64_t> operands;
+    for (size_t ip = 0; ip < len; ) {
+        Instruction insn;
+        insn.offset = ip;
+        insn.op = generic_op(static_cast<OpCode>(bytecode[ip])); // Bytecode có thể đã bị Interpreter quicken
+
+        const OpSchema& schema = get_op_schema(insn.op);
+        const size_t next_ip = ip + 1 + get_op_info(insn.op).operand_bytes;
+
+        operands = read_operands(bytecode, ip);
+        size_t target = NO_INDEX;
+        for (uint8_t i = 0; i < schema.count; ++i) {
+            if (schema.args[i] != ArgType::OFFSET16) continue;
+            // SETUP_TRY lưu địa chỉ catch tuyệt đối (theo Interpreter), còn lại tương đối với lệnh kế tiếp
+            if (insn.op == OpCode::SETUP_TRY) target = static_cast<uint16_t>(operands[i]);
+            else target = static_cast<size_t>(static_cast<int64_t>(next_ip) + operands[i]);
+        }
+
+        OperandEffects fx = operand_effects(insn.op, operands);
+        insn.uses = std::move(fx.uses);
+        insn.def = fx.def;
+        for (uint16_t r : insn.uses) code.num_regs = std::max<uint16_t>(code.num_regs, r + 1);
+        if (insn.def >= 0) code.num_regs = std::max<uint16_t>(code.num_regs, insn.def + 1);
+
+        code.index_of[ip] = code.insns.size();
+        code.insns.push_back(std::move(insn));
+        targets.push_back(target);
+        nexts.push_back(next_ip);
+        ip = next_ip;
+    }
+
+    const size_t n = code.insns.size();
+    code.index_of[len] = n; // Vùng đệm HALT cuối chunk
+
+    auto resolve = [&](size_t offset) -> size_t {
+        auto it = code.index_of.find(offset);
+        if (it == code.index_of.end()) { code.valid = false; return NO_INDEX; }
+        return it->second;
     };
 
-    // Hàm quét bytecode để tìm loops
-    std::vector<LoopInfo> find_loops(const uint8_t* bytecode, size_t len) {
-        std::vector<LoopInfo> loops;
-        size_t ip = 0;
-        
-        while (ip < len) {
-            OpCode op = static_cast<OpCode>(bytecode[ip]);
-            ip++; 
+    for (size_t i = 0; i < n; ++i) {
+        Instruction& insn = code.insns[i];
+        if (targets[i] != NO_INDEX) insn.target = resolve(targets[i]);
 
-            // Logic skip operands (tương tự disassembler)
-            // ... (Cần implement logic đọc độ dài từng opcode)
-            // Tạm thời bỏ qua vì cần bảng OpCodeLength.
-            
-            // Nếu gặp JUMP ngược -> Phát hiện loop
+        if (is_function_exit(insn.op)) continue;
+        if (insn.op != OpCode::JUMP) {
+            size_t next = nexts[i] >= len ? n : i + 1;
+            insn.succs.push_back(next);
+        }
+        if (insn.target != NO_INDEX && std::find(insn.succs.begin(), insn.succs.end(), insn.target) == insn.succs.end()) {
+            insn.succs.push_back(insn.target);
         }
-        return loops;
     }
+    return code;
+}
+
+// --- 2. Control Flow Graph ---
+
+ControlFlowGraph::ControlFlowGraph(const std::vector<Instruction>& insns) : insns_(insns) {
+    const size_t n = insns.size();
+    block_of_.assign(n, NO_INDEX);
+    if (n == 0) return;
+
+    // Leader: lệnh đầu, đích nhảy, lệnh ngay sau lệnh rẽ nhánh/thoát
+    std::vector<bool> leader(n, false);
+    leader[0] = true;
+    for (size_t i = 0; i < n; ++i) {
+        const Instruction& insn = insns[i];
+        if (insn.target != NO_INDEX && insn.target < n) leader[insn.target] = true;
+        bool ends_block = insn.target != NO_INDEX || is_function_exit(insn.op) || insn.op == OpCode::JUMP;
+        if (ends_block && i + 1 < n) leader[i + 1] = true;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (leader[i]) blocks_.push_back({i, i, {}, {}});
+        blocks_.back().last = i;
+        block_of_[i] = blocks_.size() - 1;
+    }
+
+    for (size_t b = 0; b < blocks_.size(); ++b) {
+        for (size_t s : insns[blocks_[b].last].succs) {
+            if (s >= n) continue; // Thoát hàm
+            size_t sb = block_of_[s];
+            if (std::find(blocks_[b].succs.begin(), blocks_[b].succs.end(), sb) != blocks_[b].succs.end()) continue;
+            blocks_[b].succs.push_back(sb);
+            blocks_[sb].preds.push_back(b);
+        }
+    }
+
+    // Post-order DFS (không đệ quy để tránh tràn stack với hàm lớn)
+    rpo_index_.assign(blocks_.size(), NO_INDEX);
+    std::vector<bool> visited(blocks_.size(), false);
+    std::vector<std::pair<size_t, size_t>> stack; // {block, successor kế tiếp cần thăm}
+    stack.push_back({0, 0});
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto& [b, next] = stack.back();
+        if (next < blocks_[b].succs.size()) {
+            size_t s = blocks_[b].succs[next++];
+            if (!visited[s]) { visited[s] = true; stack.push_back({s, 0}); }
+        } else {
+            rpo_.push_back(b);
+            stack.pop_back();
+        }
+    }
+    std::reverse(rpo_.begin(), rpo_.end());
+    for (size_t i = 0; i < rpo_.size(); ++i) rpo_index_[rpo_[i]] = i;
+}
+
+DominatorTree::DominatorTree(const ControlFlowGraph& cfg) {
+    const auto& blocks = cfg.blocks();
+    idom_.assign(blocks.size(), NO_INDEX);
+    if (blocks.empty()) return;
+    idom_[0] = 0;
+
+    auto intersect = [&](size_t a, size_t b) {
+        while (a != b) {
+            while (cfg.rpo_index(a) > cfg.rpo_index(b)) a = idom_[a];
+            while (cfg.rpo_index(b) > cfg.rpo_index(a)) b = idom_[b];
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b : cfg.reverse_post_order()) {
+            if (b == 0) continue;
+            size_t new_idom = NO_INDEX;
+            for (size_t p : blocks[b].preds) {
+                if (idom_[p] == NO_INDEX) continue; // Chưa xử lý / không đến được
+                new_idom = (new_idom == NO_INDEX) ? p : intersect(p, new_idom);
+            }
+            if (new_idom != idom_[b]) { idom_[b] = new_idom; changed = true; }
+        }
+    }
+}
+
+bool DominatorTree::dominates(size_t a, size_t b) const noexcept {
+    if (idom_[a] == NO_INDEX || idom_[b] == NO_INDEX) return false;
+    while (true) {
+        if (a == b) return true;
+        if (b == 0) return false;
+        b = idom_[b];
+    }
+}
+
+// --- 3. Loops ---
+
+std::vector<LoopInfo> find_loops(const ControlFlowGraph& cfg, const DominatorTree& dom) {
+    const auto& blocks = cfg.blocks();
+    std::vector<LoopInfo> loops;
+
+    for (size_t h : cfg.reverse_post_order()) {
+        LoopInfo loop{h, {}, {}, 0, 0, 1};
+        for (size_t t : blocks[h].preds) {
+            if (cfg.is_reachable(t) && dom.dominates(h, t)) loop.latches.push_back(t);
+        }
+        if (loop.latches.empty()) continue;
+
+        // Thân loop: đi ngược từ latch tới header
+        std::vector<bool> in_loop(blocks.size(), false);
+        in_loop[h] = true;
+        std::vector<size_t> work(loop.latches.begin(), loop.latches.end());
+        while (!work.empty()) {
+            size_t b = work.back(); work.pop_back();
+            if (in_loop[b]) continue;
+            in_loop[b] = true;
+            for (size_t p : blocks[b].preds) if (!in_loop[p] && cfg.is_reachable(p)) work.push_back(p);
+        }
+        for (size_t b = 0; b < blocks.size(); ++b) if (in_loop[b]) loop.blocks.push_back(b);
+
+        const auto& insns = cfg.insns();
+        loop.start_ip = insns[blocks[h].first].offset;
+        for (size_t b : loop.blocks) loop.end_ip = std::max(loop.end_ip, insns[blocks[b].last].offset);
+        loops.push_back(std::move(loop));
+    }
+
+    // Độ sâu: số loop khác chứa header của loop này
+    for (auto& inner : loops) {
+        for (const auto& outer : loops) {
+            if (&outer == &inner) continue;
+            if (std::binary_search(outer.blocks.begin(), outer.blocks.end(), inner.header)) inner.depth++;
+        }
+    }
+    return loops;
+}
+
+std::vector<LoopInfo> find_loops(const uint8_t* bytecode, size_t len) {
+    DecodedCode code = decode(bytecode, len);
+    ControlFlowGraph cfg(code.insns);
+    DominatorTree dom(cfg);
+    return find_loops(cfg, dom);
+}
+
+// --- 4. Liveness ---
+
+Liveness::Liveness(const std::vector<Instruction>& insns, uint16_t num_regs)
+    : num_regs_(num_regs), words_((num_regs + 63) / 64), count_(insns.size()) {
+    in_.assign(count_ * words_, 0);
+    out_.assign(count_ * words_, 0);
+    if (count_ == 0 || words_ == 0) return;
+
+    // Backward dataflow theo từng lệnh, duyệt ngược tới điểm bất động
+    std::vector<uint64_t> tmp(words_);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t k = count_; k-- > 0; ) {
+            const Instruction& insn = insns[k];
+            uint64_t* out = &out_[k * words_];
+            uint64_t* in = &in_[k * words_];
+
+            std::fill(tmp.begin(), tmp.end(), 0);
+            for (size_t s : insn.succs) {
+                if (s >= count_) continue;
+                const uint64_t* succ_in = &in_[s * words_];
+                for (size_t w = 0; w < words_; ++w) tmp[w] |= succ_in[w];
+            }
+            if (!std::equal(tmp.begin(), tmp.end(), out)) {
+                std::copy(tmp.begin(), tmp.end(), out);
+                changed = true;
+            }
+
+            if (insn.def >= 0) tmp[insn.def >> 6] &= ~(1ULL << (insn.def & 63));
+            for (uint16_t r : insn.uses) tmp[r >> 6] |= (1ULL << (r & 63));
+            if (!std::equal(tmp.begin(), tmp.end(), in)) {
+                std::copy(tmp.begin(), tmp.end(), in);
+                changed = true;
+            }
+        }
+    }
+}
+
+std::vector<uint16_t> Liveness::collect(const std::vector<uint64_t>& bits, size_t insn) const {
+    std::vector<uint16_t> regs;
+    if (insn >= count_) return regs;
+    for (uint16_t r = 0; r < num_regs_; ++r) {
+        if ((bits[insn * words_ + (r >> 6)] >> (r & 63)) & 1) regs.push_back(r);
+    }
+    return regs;
+}
 
-} // namespace meow::jit::analysis
\ No newline at end of file
+} // namespace meow::jit::analysis
@@ -0,0 +1,149 @@
+/**
+ * @file bytecode_analysis.h
+ * @brief Phân tích bytecode dùng chung cho JIT và masm:
+ *        giải mã lệnh, basic block, CFG, dominator, natural loop, liveness theo register
+ */
+
+#pragma once
+
+#include "meow/bytecode/op_codes.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace meow::jit::analysis {
+
+    static constexpr size_t NO_INDEX = static_cast<size_t>(-1);
+    static constexpr uint16_t NO_REG = 0xFFFF;
+
+    // --- 1. Instruction ---
+
+    // Ảnh hưởng của một lệnh lên VM register
+    struct OperandEffects {
+        std::vector<uint16_t> uses; // Register được đọc (kể cả dải tham số của CALL/NEW_ARRAY...)
+        int def = -1;               // Register được ghi (-1: không có)
+    };
+
+    /**
+     * @brief Tính use/def từ giá trị operand (theo đúng thứ tự trong OpSchema).
+     * Dùng được cho cả bytecode đã encode lẫn IR của masm.
+     * Lưu ý: register bị closure capture (upvalue mở) không được mô hình hóa,
+     * caller phải tự coi chúng là luôn sống nếu cần.
+     */
+    OperandEffects operand_effects(OpCode op, std::span<const int64_t> operands);
+
+    // Lệnh thoát khỏi hàm (không có successor trong hàm)
+    bool is_function_exit(OpCode op);
+
+    struct Instruction {
+        size_t offset = 0;          // Bytecode offset (hoặc vị trí trong IR)
+        OpCode op = OpCode::NOP;
+        std::vector<uint16_t> uses;
+        int def = -1;
+        std::vector<size_t> succs;  // Chỉ số lệnh kế tiếp; == số lệnh nghĩa là thoát qua vùng đệm HALT
+        size_t target = NO_INDEX;   // Chỉ số lệnh đích nhảy (nếu có)
+    };
+
+    // Bytecode đã giải mã
+    struct DecodedCode {
+        std::vector<Instruction> insns;
+        std::unordered_map<size_t, size_t> index_of; // Bytecode offset -> chỉ số lệnh (len -> insns.size())
+        uint16_t num_regs = 0;                       // Chỉ số register lớn nhất + 1
+        bool valid = true;                           // false nếu có đích nhảy không phải đầu lệnh
+    };
+
+    // Giá trị operand của lệnh tại ip theo OpSchema (register, index, offset... đều về int64)
+    std::vector<int64_t> read_operands(const uint8_t* bytecode, size_t ip);
+
+    // Giải mã dựa trên get_op_schema/get_op_info (bỏ qua inline cache của CALL/GET_PROP...)
+    DecodedCode decode(const uint8_t* bytecode, size_t len);
+
+    // --- 2. Control Flow Graph ---
+
+    struct BasicBlock {
+        size_t first;               // Chỉ số lệnh đầu tiên
+        size_t last;                // Chỉ số lệnh cuối cùng (inclusive)
+        std::vector<size_t> succs;
+        std::vector<size_t> preds;
+    };
+
+    class ControlFlowGraph {
+    public:
+        explicit ControlFlowGraph(const std::vector<Instruction>& insns);
+
+        const std::vector<BasicBlock>& blocks() const noexcept { return blocks_; }
+        const std::vector<Instruction>& insns() const noexcept { return insns_; }
+        size_t block_of(size_t insn) const noexcept { return block_of_[insn]; }
+
+        // Reverse post-order từ entry (chỉ gồm block đến được)
+        const std::vector<size_t>& reverse_post_order() const noexcept { return rpo_; }
+        bool is_reachable(size_t block) const noexcept { return rpo_index_[block] != NO_INDEX; }
+        size_t rpo_index(size_t block) const noexcept { return rpo_index_[block]; }
+
+    private:
+        const std::vector<Instruction>& insns_;
+        std::vector<BasicBlock> blocks_;
+        std::vector<size_t> block_of_;
+        std::vector<size_t> rpo_;
+        std::vector<size_t> rpo_index_;
+    };
+
+    // Cooper-Harvey-Kennedy: lặp trên RPO tới điểm bất động
+    class DominatorTree {
+    public:
+        explicit DominatorTree(const ControlFlowGraph& cfg);
+
+        // Immediate dominator (entry -> chính nó, block không đến được -> NO_INDEX)
+        size_t idom(size_t block) const noexcept { return idom_[block]; }
+        bool dominates(size_t a, size_t b) const noexcept;
+
+    private:
+        std::vector<size_t> idom_;
+    };
+
+    // --- 3. Loops ---
+
+    struct LoopInfo {
+        size_t header;               // Block header (đích của back-edge)
+        std::vector<size_t> latches; // Block có back-edge về header
+        std::vector<size_t> blocks;  // Thân loop (đã sắp xếp, gồm header)
+        size_t start_ip;             // Offset lệnh đầu của header
+        size_t end_ip;               // Offset lệnh cuối cùng trong thân loop
+        size_t depth;                // 1 = loop ngoài cùng
+    };
+
+    // Natural loop: mỗi back-edge t -> h với h dominate t. Các back-edge cùng header được gộp.
+    std::vector<LoopInfo> find_loops(const ControlFlowGraph& cfg, const DominatorTree& dom);
+    std::vector<LoopInfo> find_loops(const uint8_t* bytecode, size_t len);
+
+    // --- 4. Liveness ---
+
+    class Liveness {
+    public:
+        Liveness(const std::vector<Instruction>& insns, uint16_t num_regs);
+
+        bool is_live_in(size_t insn, uint16_t reg) const noexcept { return test(in_, insn, reg); }
+        bool is_live_out(size_t insn, uint16_t reg) const noexcept { return test(out_, insn, reg); }
+
+        std::vector<uint16_t> live_in(size_t insn) const { return collect(in_, insn); }
+        std::vector<uint16_t> live_out(size_t insn) const { return collect(out_, insn); }
+
+        uint16_t num_regs() const noexcept { return num_regs_; }
+
+    private:
+        uint16_t num_regs_;
+        size_t words_;
+        size_t count_;
+        std::vector<uint64_t> in_;  // count_ * words_ bit
+        std::vector<uint64_t> out_;
+
+        bool test(const std::vector<uint64_t>& bits, size_t insn, uint16_t reg) const noexcept {
+            if (insn >= count_ || reg >= num_regs_) return false;
+            return (bits[insn * words_ + (reg >> 6)] >> (reg & 63)) & 1;
+        }
+        std::vector<uint16_t> collect(const std::vector<uint64_t>& bits, size_t insn) const;
+    };
+
+} // namespace meow::jit::analysis
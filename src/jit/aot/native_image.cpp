@@ -0,0 +1,244 @@
+#include "aot/native_image.h"
+#include "jit_compiler.h"
+#include "x64/code_generator.h"
+#include "meow/core/function.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <system_error>
+
+namespace meow::jit::aot {
+
+// Layout (little-endian, giống host):
+//   u32 magic, u32 version, u64 abi, u64 bytecode_hash, u32 proto_count, u32 entry_count
+//   entry: u32 proto_index, u32 code_size, code[code_size],
+//          u32 n_osr, {u32 bc_offset, u32 native_offset}*,
+//          u32 n_reloc, {u32 pos, u8 kind, u32 arg}*,
+//          u32 n_line, {u32 native_offset, u32 bc_offset}*
+static constexpr uint32_t IMAGE_MAGIC = 0x584F454D; // "MEOX"
+
+static std::atomic<bool> g_write_images{false};
+
+void set_write_images(bool enable) noexcept { g_write_images.store(enable, std::memory_order_relaxed); }
+bool write_images() noexcept { return g_write_images.load(std::memory_order_relaxed); }
+
+std::filesystem::path image_path(const std::filesystem::path& bytecode_path) {
+    std::filesystem::path path = bytecode_path;
+    path.replace_extension(".meowx");
+    return path;
+}
+
+namespace {
+
+uint64_t hash_bytes(const std::vector<uint8_t>& data) noexcept {
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    for (uint8_t b : data) {
+        h ^= b;
+        h *= 0x100000001b3ULL;
+    }
+    return h ^ data.size();
+}
+
+struct ImageEntry {
+    uint32_t proto_index;
+    NativeCode native;
+};
+
+class Writer {
+public:
+    template <typename T>
+    void put(T v) {
+        const auto* p = reinterpret_cast<const uint8_t*>(&v);
+        out_.insert(out_.end(), p, p + sizeof(T));
+    }
+    void put_bytes(const std::vector<uint8_t>& bytes) { out_.insert(out_.end(), bytes.begin(), bytes.end()); }
+    const std::vector<uint8_t>& data() const noexcept { return out_; }
+private:
+    std::vector<uint8_t> out_;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::vector<uint8_t>& data) : data_(data) {}
+
+    template <typename T>
+    bool get(T& v) {
+        if (data_.size() - pos_ < sizeof(T)) return false;
+        std::memcpy(&v, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    bool get_bytes(std::vector<uint8_t>& bytes, size_t n) {
+        if (data_.size() - pos_ < n) return false;
+        bytes.assign(data_.begin() + pos_, data_.begin() + pos_ + n);
+        pos_ += n;
+        return true;
+    }
+    bool at_end() const noexcept { return pos_ == data_.size(); }
+private:
+    const std::vector<uint8_t>& data_;
+    size_t pos_ = 0;
+};
+
+std::vector<uint8_t> serialize(uint64_t bytecode_hash, uint32_t proto_count, const std::vector<ImageEntry>& entries) {
+    Writer w;
+    w.put<uint32_t>(IMAGE_MAGIC);
+    w.put<uint32_t>(IMAGE_VERSION);
+    w.put<uint64_t>(x64::CodeGenerator::abi_fingerprint());
+    w.put<uint64_t>(bytecode_hash);
+    w.put<uint32_t>(proto_count);
+    w.put<uint32_t>(static_cast<uint32_t>(entries.size()));
+
+    for (const ImageEntry& e : entries) {
+        const NativeCode& n = e.native;
+        w.put<uint32_t>(e.proto_index);
+        w.put<uint32_t>(static_cast<uint32_t>(n.code.size()));
+        w.put_bytes(n.code);
+        w.put<uint32_t>(static_cast<uint32_t>(n.osr_entries.size()));
+        for (const OsrEntry& o : n.osr_entries) {
+            w.put<uint32_t>(o.bc_offset);
+            w.put<uint32_t>(static_cast<uint32_t>(o.native_offset));
+        }
+        w.put<uint32_t>(static_cast<uint32_t>(n.relocs.size()));
+        for (const Relocation& r : n.relocs) {
+            w.put<uint32_t>(r.pos);
+            w.put<uint8_t>(static_cast<uint8_t>(r.kind));
+            w.put<uint32_t>(r.arg);
+        }
+        w.put<uint32_t>(static_cast<uint32_t>(n.lines.size()));
+        for (const LineEntry& l : n.lines) {
+            w.put<uint32_t>(l.native_offset);
+            w.put<uint32_t>(l.bc_offset);
+        }
+    }
+    return w.data();
+}
+
+// nullopt: image hỏng, cũ hoặc không thuộc về bytecode này
+std::optional<std::vector<ImageEntry>> deserialize(const std::vector<uint8_t>& data, uint64_t bytecode_hash,
+                                                   const std::vector<proto_t>& protos) {
+    Reader r(data);
+    uint32_t magic, version, proto_count, entry_count;
+    uint64_t abi, hash;
+    if (!r.get(magic) || magic != IMAGE_MAGIC) return std::nullopt;
+    if (!r.get(version) || version != IMAGE_VERSION) return std::nullopt;
+    if (!r.get(abi) || abi != x64::CodeGenerator::abi_fingerprint()) return std::nullopt;
+    if (!r.get(hash) || hash != bytecode_hash) return std::nullopt;
+    if (!r.get(proto_count) || proto_count != protos.size()) return std::nullopt;
+    if (!r.get(entry_count) || entry_count > proto_count) return std::nullopt;
+
+    std::vector<ImageEntry> entries(entry_count);
+    for (ImageEntry& e : entries) {
+        NativeCode& n = e.native;
+        uint32_t code_size, count;
+        if (!r.get(e.proto_index) || e.proto_index >= proto_count) return std::nullopt;
+        if (!r.get(code_size) || !r.get_bytes(n.code, code_size)) return std::nullopt;
+
+        if (!r.get(count)) return std::nullopt;
+        n.osr_entries.resize(count);
+        for (OsrEntry& o : n.osr_entries) {
+            uint32_t native_offset;
+            if (!r.get(o.bc_offset) || !r.get(native_offset) || native_offset >= code_size) return std::nullopt;
+            o.native_offset = native_offset;
+        }
+
+        if (!r.get(count)) return std::nullopt;
+        n.relocs.resize(count);
+        const size_t chunk_size = protos[e.proto_index]->get_chunk().get_code_size();
+        for (Relocation& rel : n.relocs) {
+            uint8_t kind;
+            if (!r.get(rel.pos) || !r.get(kind) || !r.get(rel.arg)) return std::nullopt;
+            if (static_cast<size_t>(rel.pos) + 8 > code_size) return std::nullopt;
+            if (kind > static_cast<uint8_t>(RelocKind::HANDLER)) return std::nullopt;
+            rel.kind = static_cast<RelocKind>(kind);
+            if (rel.kind == RelocKind::RUNTIME_STUB && rel.arg >= static_cast<uint32_t>(RuntimeStub::COUNT)) return std::nullopt;
+            if (rel.kind == RelocKind::BYTECODE && rel.arg >= chunk_size) return std::nullopt;
+            if (rel.kind == RelocKind::HANDLER && rel.arg >= static_cast<uint32_t>(OpCode::TOTAL_OPCODES)) return std::nullopt;
+        }
+
+        if (!r.get(count)) return std::nullopt;
+        n.lines.resize(count);
+        for (LineEntry& l : n.lines) {
+            if (!r.get(l.native_offset) || !r.get(l.bc_offset)) return std::nullopt;
+        }
+    }
+    if (!r.at_end()) return std::nullopt;
+    return entries;
+}
+
+std::optional<std::vector<uint8_t>> read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return std::nullopt;
+    std::streamsize size = file.tellg();
+    if (size < 0) return std::nullopt;
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) return std::nullopt;
+    return data;
+}
+
+// Ghi ra file tạm rồi rename: process khác đang đọc không bao giờ thấy image ghi dở
+bool write_file(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+    return !ec;
+}
+
+} // namespace
+
+size_t attach(const std::filesystem::path& bytecode_path, const std::vector<uint8_t>& bytecode,
+              const std::vector<proto_t>& protos) {
+    if (protos.empty()) return 0;
+
+    JitCompiler& compiler = JitCompiler::instance();
+    const std::filesystem::path path = image_path(bytecode_path);
+    const uint64_t hash = hash_bytes(bytecode);
+
+    // 1. Image hợp lệ -> cài thẳng, không cần đợi hàm nóng
+    if (auto data = read_file(path)) {
+        if (auto entries = deserialize(*data, hash, protos)) {
+            size_t installed = 0;
+            for (const ImageEntry& e : *entries) {
+                proto_t proto = protos[e.proto_index];
+                if (proto->get_jit_entry()) continue;
+                if (compiler.install_native(proto, e.native)) ++installed;
+            }
+            return installed;
+        }
+    }
+
+    if (!write_images()) return 0;
+
+    // 2. Compile mọi proto JIT hỗ trợ rồi ghi image mới (đồng thời cài luôn cho lần chạy này)
+    std::vector<ImageEntry> entries;
+    for (size_t i = 0; i < protos.size(); ++i) {
+        std::optional<NativeCode> native = compiler.compile_relocatable(protos[i]);
+        if (native) entries.push_back({static_cast<uint32_t>(i), std::move(*native)});
+    }
+
+    if (!write_file(path, serialize(hash, static_cast<uint32_t>(protos.size()), entries))) {
+        std::cerr << "[JIT] Cannot write AOT image " << path.string() << std::endl;
+    }
+
+    size_t installed = 0;
+    for (const ImageEntry& e : entries) {
+        proto_t proto = protos[e.proto_index];
+        if (!proto->get_jit_entry() && compiler.install_native(proto, e.native)) ++installed;
+    }
+    return installed;
+}
+
+} // namespace meow::jit::aot
@@ -0,0 +1,35 @@
+/**
+ * @file native_image.h
+ * @brief AOT image: mã máy của các proto trong một .meowc, lưu cạnh file bytecode (foo.meowc -> foo.meowx)
+ */
+
+#pragma once
+
+#include "meow/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace meow::jit::aot {
+
+    // Bump khi định dạng file đổi
+    static constexpr uint32_t IMAGE_VERSION = 2;
+
+    std::filesystem::path image_path(const std::filesystem::path& bytecode_path);
+
+    // Bật bằng `meow-vm --aot`: module chưa có image hợp lệ sẽ được compile hết và ghi image
+    void set_write_images(bool enable) noexcept;
+    bool write_images() noexcept;
+
+    /**
+     * @brief Gọi sau khi Loader nạp xong module.
+     * protos: theo đúng thứ tự Loader tạo (Loader::protos()), index trong image tham chiếu vào đây.
+     * Image chỉ được dùng khi hash bytecode, ABI fingerprint của CodeGenerator và version đều khớp;
+     * ngược lại bỏ qua (chạy Interpreter/JIT như thường) hoặc ghi đè nếu write_images().
+     * @return Số proto đã được cài mã máy
+     */
+    size_t attach(const std::filesystem::path& bytecode_path, const std::vector<uint8_t>& bytecode,
+                  const std::vector<proto_t>& protos);
+
+} // namespace meow::jit::aot
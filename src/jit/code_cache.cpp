@@ -0,0 +1,195 @@
+#include "code_cache.h"
+#include "jit_config.h"
+#include "meow/core/function.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Platform specific headers for memory management
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace meow::jit {
+
+static constexpr size_t CODE_ALIGN = 16;
+
+static size_t page_size() noexcept {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+#endif
+}
+
+static constexpr size_t align_up(size_t value, size_t boundary) noexcept {
+    return (value + boundary - 1) & ~(boundary - 1);
+}
+
+CodeCache::~CodeCache() {
+    clear();
+}
+
+bool CodeCache::map_region(size_t capacity) {
+#if defined(_WIN32)
+    void* ptr = VirtualAlloc(nullptr, capacity, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READ);
+    if (!ptr) {
+        std::cerr << "[JIT] Failed to allocate executable memory (Windows)!" << std::endl;
+        return false;
+    }
+#else
+    void* ptr = mmap(nullptr, capacity, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        std::cerr << "[JIT] Failed to allocate executable memory (mmap)!" << std::endl;
+        return false;
+    }
+#endif
+
+    Region region;
+    region.base = static_cast<uint8_t*>(ptr);
+    region.capacity = capacity;
+    regions_.push_back(std::move(region));
+    reserved_ += capacity;
+
+    if (JIT_DEBUG_LOG) {
+        std::cout << "[JIT] Mapped code region #" << (regions_.size() - 1) << " (" << (capacity / 1024)
+                  << "KB) at " << (void*)regions_.back().base << std::endl;
+    }
+    return true;
+}
+
+void CodeCache::unmap(Region& region) noexcept {
+    if (!region.base) return;
+#if defined(_WIN32)
+    VirtualFree(region.base, 0, MEM_RELEASE);
+#else
+    munmap(region.base, region.capacity);
+#endif
+    region.base = nullptr;
+    region.capacity = 0;
+    region.used = 0;
+}
+
+bool CodeCache::protect(const Region& region, bool writable) noexcept {
+#if defined(_WIN32)
+    DWORD old;
+    return VirtualProtect(region.base, region.capacity, writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &old) != 0;
+#else
+    int prot = writable ? (PROT_READ | PROT_WRITE) : (PROT_READ | PROT_EXEC);
+    return mprotect(region.base, region.capacity, prot) == 0;
+#endif
+}
+
+void CodeCache::evict_region(size_t idx) noexcept {
+    Region& region = regions_[idx];
+
+    if (JIT_DEBUG_LOG) {
+        std::cout << "[JIT] Evicting code region #" << idx << " (" << region.owners.size() << " functions)" << std::endl;
+    }
+
+    // Unlink: proto quay về Interpreter và phải nóng lại mới được compile tiếp
+    for (ObjFunctionProto* owner : region.owners) {
+        if (auto it = entries_.find(owner); it != entries_.end()) registry_.remove(it->second.entry);
+        owner->set_jit_entry(nullptr);
+        owner->reset_hotness();
+        entries_.erase(owner);
+    }
+    region.owners.clear();
+    region.used = 0;
+}
+
+CodeCache::Region* CodeCache::acquire_region(size_t needed) {
+    auto fits = [needed](const Region& r) { return r.capacity - r.used >= needed; };
+
+    if (!regions_.empty() && fits(regions_[active_])) return &regions_[active_];
+
+    // 1. Còn hạn mức -> mở region mới (đủ lớn cho hàm khổng lồ)
+    size_t capacity = std::max(JIT_CACHE_SIZE, align_up(needed, page_size()));
+    if (reserved_ + capacity <= JIT_CACHE_MAX_SIZE || regions_.empty()) {
+        if (!map_region(capacity)) return nullptr;
+        active_ = regions_.size() - 1;
+        return &regions_[active_];
+    }
+
+    // 2. Hết hạn mức -> tái sử dụng region cũ nhất (generation eviction)
+    bool can_fit = std::any_of(regions_.begin(), regions_.end(), [needed](const Region& r) { return r.capacity >= needed; });
+    if (!can_fit) return nullptr; // Không evict vô ích cho hàm quá lớn
+
+    for (size_t tried = 0; tried < regions_.size(); ++tried) {
+        active_ = (active_ + 1) % regions_.size();
+        evict_region(active_);
+        if (fits(regions_[active_])) return &regions_[active_];
+    }
+    return nullptr;
+}
+
+uint8_t* CodeCache::install(ObjFunctionProto* owner, const uint8_t* code, size_t size,
+                            std::vector<OsrEntry> osr_entries, const std::vector<LineEntry>& lines) {
+    release(owner);
+
+    size_t needed = align_up(size, CODE_ALIGN);
+    Region* region = acquire_region(needed);
+    if (!region) return nullptr;
+
+    uint8_t* entry = region->base + region->used;
+
+    // W^X: chỉ mở quyền ghi trong lúc copy
+    if (!protect(*region, true)) return nullptr;
+    std::memcpy(entry, code, size);
+    std::memset(entry + size, 0xCC, needed - size); // INT3 padding
+    protect(*region, false);
+
+    region->used += needed;
+    region->owners.push_back(owner);
+
+    size_t region_idx = static_cast<size_t>(region - regions_.data());
+    entries_[owner] = CodeEntry{owner, entry, size, region_idx, std::move(osr_entries)};
+    owner->set_jit_entry(entry);
+    registry_.add(owner, entry, size, lines);
+    return entry;
+}
+
+void CodeCache::release(ObjFunctionProto* owner) noexcept {
+    auto it = entries_.find(owner);
+    if (it == entries_.end()) return;
+
+    // Bộ nhớ được thu hồi cùng cả region khi evict (bump allocator)
+    std::erase(regions_[it->second.region].owners, owner);
+    registry_.remove(it->second.entry);
+    owner->set_jit_entry(nullptr);
+    entries_.erase(it);
+}
+
+void CodeCache::clear() noexcept {
+    for (auto& [proto, entry] : entries_) {
+        registry_.remove(entry.entry);
+        entry.owner->set_jit_entry(nullptr);
+        entry.owner->reset_hotness();
+    }
+    entries_.clear();
+
+    for (auto& region : regions_) unmap(region);
+    regions_.clear();
+    active_ = 0;
+    reserved_ = 0;
+}
+
+const CodeEntry* CodeCache::find(const ObjFunctionProto* owner) const noexcept {
+    auto it = entries_.find(owner);
+    return it != entries_.end() ? &it->second : nullptr;
+}
+
+size_t CodeCache::used_bytes() const noexcept {
+    size_t total = 0;
+    for (const auto& region : regions_) total += region.used;
+    return total;
+}
+
+} // namespace meow::jit
@@ -0,0 +1,88 @@
+/**
+ * @file code_cache.h
+ * @brief Executable Memory Manager cho JIT (W^X, nhiều region, eviction theo generation)
+ */
+
+#pragma once
+
+#include "code_registry.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+// Forward declarations
+namespace meow { class ObjFunctionProto; }
+
+namespace meow::jit {
+
+    // Điểm vào giữa hàm (OSR) tại loop header
+    struct OsrEntry {
+        uint32_t bc_offset;      // Bytecode offset của loop header
+        size_t native_offset;    // Tính từ đầu mã máy của hàm
+    };
+
+    // Metadata của một hàm đã JIT
+    struct CodeEntry {
+        ObjFunctionProto* owner; // Proto sở hữu (bị unlink khi evict)
+        uint8_t* entry;          // Địa chỉ bắt đầu mã máy
+        size_t size;             // Kích thước chính xác (bytes)
+        size_t region;           // Region chứa mã
+        std::vector<OsrEntry> osr_entries;
+    };
+
+    /**
+     * @brief Quản lý bộ nhớ mã máy.
+     * - Mỗi region là một vùng mmap riêng, bình thường ở trạng thái R+X,
+     *   chỉ bật R+W trong lúc copy mã vào (không bao giờ có trang RWX).
+     * - Region đầy -> mở region mới cho tới JIT_CACHE_MAX_SIZE.
+     * - Vượt giới hạn -> region cũ nhất (generation cũ nhất) bị xóa toàn bộ,
+     *   các proto trong đó bị unlink và quay về Interpreter (đếm hotness lại từ đầu).
+     */
+    class CodeCache {
+    public:
+        CodeCache() = default;
+        ~CodeCache();
+
+        CodeCache(const CodeCache&) = delete;
+        CodeCache& operator=(const CodeCache&) = delete;
+
+        // Copy mã đã sinh vào region (RX), đăng ký metadata và link vào proto. nullptr nếu hết bộ nhớ.
+        // lines: line table native -> bytecode offset cho GDB (CodeRegistry)
+        uint8_t* install(ObjFunctionProto* owner, const uint8_t* code, size_t size,
+                         std::vector<OsrEntry> osr_entries = {}, const std::vector<LineEntry>& lines = {});
+
+        // Gỡ mã của proto (proto bị GC thu hồi hoặc compile lại)
+        void release(ObjFunctionProto* owner) noexcept;
+
+        // Unlink mọi proto và trả toàn bộ region cho OS
+        void clear() noexcept;
+
+        const CodeEntry* find(const ObjFunctionProto* owner) const noexcept;
+
+        size_t used_bytes() const noexcept;
+        size_t reserved_bytes() const noexcept { return reserved_; }
+        size_t function_count() const noexcept { return entries_.size(); }
+
+    private:
+        struct Region {
+            uint8_t* base = nullptr;
+            size_t capacity = 0;
+            size_t used = 0;
+            std::vector<ObjFunctionProto*> owners;
+        };
+
+        CodeRegistry registry_; // Khai báo trước regions_: hủy sau cùng
+        std::vector<Region> regions_;
+        std::unordered_map<const ObjFunctionProto*, CodeEntry> entries_;
+        size_t active_ = 0;   // Region đang ghi (ring: region kế tiếp là generation cũ nhất)
+        size_t reserved_ = 0; // Tổng dung lượng đã mmap
+
+        Region* acquire_region(size_t needed);
+        bool map_region(size_t capacity);
+        void evict_region(size_t idx) noexcept;
+        static bool protect(const Region& region, bool writable) noexcept;
+        static void unmap(Region& region) noexcept;
+    };
+
+} // namespace meow::jit
@@ -0,0 +1,315 @@
+#include "code_registry.h"
+#include "jit_config.h"
+#include "meow/core/function.h"
+#include "meow/core/string.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+    #include <elf.h>
+    #include <unistd.h>
+#endif
+
+// --- GDB JIT Interface ---
+// GDB đặt breakpoint trong __jit_debug_register_code và đọc __jit_debug_descriptor
+// (tên và layout cố định, xem "JIT Compilation Interface" trong tài liệu GDB)
+extern "C" {
+    enum jit_actions_t : uint32_t { JIT_NOACTION = 0, JIT_REGISTER_FN, JIT_UNREGISTER_FN };
+
+    struct jit_code_entry {
+        jit_code_entry* next_entry;
+        jit_code_entry* prev_entry;
+        const char* symfile_addr;
+        uint64_t symfile_size;
+    };
+
+    struct jit_descriptor {
+        uint32_t version;
+        uint32_t action_flag;
+        jit_code_entry* relevant_entry;
+        jit_code_entry* first_entry;
+    };
+
+    [[gnu::noinline, gnu::used]] void __jit_debug_register_code() { __asm__ __volatile__(""); }
+    [[gnu::used]] jit_descriptor __jit_debug_descriptor = { 1, JIT_NOACTION, nullptr, nullptr };
+}
+
+namespace meow::jit {
+
+namespace {
+
+    bool env_enabled(const char* name) {
+        const char* v = std::getenv(name);
+        return v && *v && std::strcmp(v, "0") != 0;
+    }
+
+    std::string symbol_name(const ObjFunctionProto* proto) {
+        string_t name = proto->get_name();
+        return std::string("meow:") + (name && name->size() ? name->c_str() : "<anon>");
+    }
+
+    // Ghi little-endian vào buffer (ELF/DWARF)
+    struct ByteWriter {
+        std::vector<uint8_t> buf;
+
+        size_t pos() const { return buf.size(); }
+        void u8(uint8_t v) { buf.push_back(v); }
+        void u16(uint16_t v) { raw(&v, 2); }
+        void u32(uint32_t v) { raw(&v, 4); }
+        void u64(uint64_t v) { raw(&v, 8); }
+        void raw(const void* p, size_t n) { auto b = static_cast<const uint8_t*>(p); buf.insert(buf.end(), b, b + n); }
+        void str(const std::string& s) { raw(s.c_str(), s.size() + 1); }
+        void uleb(uint64_t v) {
+            do { uint8_t b = v & 0x7F; v >>= 7; if (v) b |= 0x80; u8(b); } while (v);
+        }
+        void sleb(int64_t v) {
+            bool more = true;
+            while (more) {
+                uint8_t b = v & 0x7F; v >>= 7;
+                more = !((v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40)));
+                u8(more ? (b | 0x80) : b);
+            }
+        }
+        void align(size_t a) { while (buf.size() % a) u8(0); }
+        void patch_u32(size_t at, uint32_t v) { std::memcpy(&buf[at], &v, 4); }
+    };
+
+#if defined(__linux__)
+    // DWARF 2 tối giản: một compile unit (tên = proto) chứa một subprogram
+    enum : uint8_t {
+        DW_TAG_compile_unit = 0x11, DW_TAG_subprogram = 0x2E,
+        DW_AT_name = 0x03, DW_AT_producer = 0x25, DW_AT_low_pc = 0x11, DW_AT_high_pc = 0x12,
+        DW_AT_stmt_list = 0x10, DW_AT_external = 0x3F,
+        DW_FORM_addr = 0x01, DW_FORM_data4 = 0x06, DW_FORM_string = 0x08, DW_FORM_flag = 0x0C,
+        DW_LNS_copy = 0x01, DW_LNS_advance_pc = 0x02, DW_LNS_advance_line = 0x03,
+        DW_LNE_end_sequence = 0x01, DW_LNE_set_address = 0x02,
+    };
+
+    std::vector<uint8_t> debug_abbrev() {
+        ByteWriter w;
+        w.uleb(1); w.uleb(DW_TAG_compile_unit); w.u8(1); // has children
+        w.uleb(DW_AT_name);      w.uleb(DW_FORM_string);
+        w.uleb(DW_AT_producer);  w.uleb(DW_FORM_string);
+        w.uleb(DW_AT_low_pc);    w.uleb(DW_FORM_addr);
+        w.uleb(DW_AT_high_pc);   w.uleb(DW_FORM_addr);
+        w.uleb(DW_AT_stmt_list); w.uleb(DW_FORM_data4);
+        w.u8(0); w.u8(0);
+        w.uleb(2); w.uleb(DW_TAG_subprogram); w.u8(0);
+        w.uleb(DW_AT_name);      w.uleb(DW_FORM_string);
+        w.uleb(DW_AT_low_pc);    w.uleb(DW_FORM_addr);
+        w.uleb(DW_AT_high_pc);   w.uleb(DW_FORM_addr);
+        w.uleb(DW_AT_external);  w.uleb(DW_FORM_flag);
+        w.u8(0); w.u8(0);
+        w.u8(0);
+        return w.buf;
+    }
+
+    std::vector<uint8_t> debug_info(const std::string& name, uint64_t lo, uint64_t hi) {
+        ByteWriter w;
+        w.u32(0);                 // unit_length (patch)
+        w.u16(2);                 // version
+        w.u32(0);                 // debug_abbrev_offset
+        w.u8(8);                  // address_size
+        w.uleb(1); w.str(name); w.str("meow-vm jit"); w.u64(lo); w.u64(hi); w.u32(0);
+        w.uleb(2); w.str(name); w.u64(lo); w.u64(hi); w.u8(1);
+        w.u8(0);                  // hết children của CU
+        w.patch_u32(0, static_cast<uint32_t>(w.pos() - 4));
+        return w.buf;
+    }
+
+    // File ảo = tên proto, line = bytecode offset + 1 (line 0 nghĩa là "không có dòng")
+    std::vector<uint8_t> debug_line(const std::string& name, uint64_t lo, size_t size,
+                                    const std::vector<LineEntry>& lines) {
+        ByteWriter w;
+        w.u32(0);                 // unit_length (patch)
+        w.u16(2);                 // version
+        const size_t header_len_at = w.pos();
+        w.u32(0);                 // header_length (patch)
+        w.u8(1);                  // minimum_instruction_length
+        w.u8(1);                  // default_is_stmt
+        w.u8(static_cast<uint8_t>(-5)); // line_base
+        w.u8(14);                 // line_range
+        w.u8(13);                 // opcode_base
+        for (uint8_t n : {0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1}) w.u8(n);
+        w.u8(0);                  // include_directories
+        w.str(name); w.uleb(0); w.uleb(0); w.uleb(0);
+        w.u8(0);                  // hết file_names
+        w.patch_u32(header_len_at, static_cast<uint32_t>(w.pos() - header_len_at - 4));
+
+        w.u8(0); w.uleb(9); w.u8(DW_LNE_set_address); w.u64(lo);
+        uint64_t addr = 0;
+        int64_t line = 1;
+        for (const LineEntry& e : lines) {
+            if (e.native_offset > addr) { w.u8(DW_LNS_advance_pc); w.uleb(e.native_offset - addr); addr = e.native_offset; }
+            const int64_t target = static_cast<int64_t>(e.bc_offset) + 1;
+            if (target != line) { w.u8(DW_LNS_advance_line); w.sleb(target - line); line = target; }
+            w.u8(DW_LNS_copy);
+        }
+        if (size > addr) { w.u8(DW_LNS_advance_pc); w.uleb(size - addr); }
+        w.u8(0); w.uleb(1); w.u8(DW_LNE_end_sequence);
+        w.patch_u32(0, static_cast<uint32_t>(w.pos() - 4));
+        return w.buf;
+    }
+
+    // ELF64 relocatable: .text là NOBITS đặt tại địa chỉ mã thật (giống cách LuaJIT làm)
+    std::vector<uint8_t> build_symfile(const std::string& name, const uint8_t* entry, size_t size,
+                                       const std::vector<LineEntry>& lines) {
+        enum { S_NULL, S_TEXT, S_INFO, S_ABBREV, S_LINE, S_SYMTAB, S_STRTAB, S_SHSTRTAB, S_COUNT };
+        const uint64_t lo = reinterpret_cast<uint64_t>(entry);
+
+        ByteWriter shstr; shstr.u8(0);
+        uint32_t sh_name[S_COUNT] = {};
+        const char* names[S_COUNT] = { "", ".text", ".debug_info", ".debug_abbrev", ".debug_line",
+                                       ".symtab", ".strtab", ".shstrtab" };
+        for (int i = 1; i < S_COUNT; ++i) { sh_name[i] = static_cast<uint32_t>(shstr.pos()); shstr.str(names[i]); }
+
+        ByteWriter strtab; strtab.u8(0);
+        const uint32_t sym_name = static_cast<uint32_t>(strtab.pos());
+        strtab.str(name);
+
+        ByteWriter symtab;
+        Elf64_Sym null_sym{};
+        symtab.raw(&null_sym, sizeof(null_sym));
+        Elf64_Sym fn{};
+        fn.st_name = sym_name;
+        fn.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+        fn.st_shndx = S_TEXT;
+        fn.st_value = 0; // Tương đối với .text
+        fn.st_size = size;
+        symtab.raw(&fn, sizeof(fn));
+
+        std::vector<uint8_t> data[S_COUNT];
+        data[S_INFO] = debug_info(name, lo, lo + size);
+        data[S_ABBREV] = debug_abbrev();
+        data[S_LINE] = debug_line(name, lo, size, lines);
+        data[S_SYMTAB] = std::move(symtab.buf);
+        data[S_STRTAB] = std::move(strtab.buf);
+        data[S_SHSTRTAB] = std::move(shstr.buf);
+
+        ByteWriter out;
+        out.buf.resize(sizeof(Elf64_Ehdr));
+        Elf64_Shdr sh[S_COUNT] = {};
+        for (int i = S_INFO; i < S_COUNT; ++i) {
+            out.align(8);
+            sh[i].sh_offset = out.pos();
+            sh[i].sh_size = data[i].size();
+            sh[i].sh_addralign = 1;
+            sh[i].sh_type = SHT_PROGBITS;
+            out.raw(data[i].data(), data[i].size());
+        }
+        sh[S_TEXT].sh_type = SHT_NOBITS;
+        sh[S_TEXT].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+        sh[S_TEXT].sh_addr = lo;
+        sh[S_TEXT].sh_size = size;
+        sh[S_TEXT].sh_addralign = 16;
+        sh[S_SYMTAB].sh_type = SHT_SYMTAB;
+        sh[S_SYMTAB].sh_link = S_STRTAB;
+        sh[S_SYMTAB].sh_info = 1; // Symbol non-local đầu tiên
+        sh[S_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+        sh[S_SYMTAB].sh_addralign = 8;
+        sh[S_STRTAB].sh_type = SHT_STRTAB;
+        sh[S_SHSTRTAB].sh_type = SHT_STRTAB;
+        for (int i = 1; i < S_COUNT; ++i) sh[i].sh_name = sh_name[i];
+
+        out.align(8);
+        const size_t shoff = out.pos();
+        out.raw(sh, sizeof(sh));
+
+        Elf64_Ehdr eh{};
+        std::memcpy(eh.e_ident, ELFMAG, SELFMAG);
+        eh.e_ident[EI_CLASS] = ELFCLASS64;
+        eh.e_ident[EI_DATA] = ELFDATA2LSB;
+        eh.e_ident[EI_VERSION] = EV_CURRENT;
+        eh.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+        eh.e_type = ET_REL;
+        eh.e_machine = EM_X86_64;
+        eh.e_version = EV_CURRENT;
+        eh.e_shoff = shoff;
+        eh.e_ehsize = sizeof(Elf64_Ehdr);
+        eh.e_shentsize = sizeof(Elf64_Shdr);
+        eh.e_shnum = S_COUNT;
+        eh.e_shstrndx = S_SHSTRTAB;
+        std::memcpy(out.buf.data(), &eh, sizeof(eh));
+        return std::move(out.buf);
+    }
+#endif
+
+    // jit_code_entry kèm symfile (GDB đọc thẳng bộ nhớ của process)
+    struct GdbEntry {
+        jit_code_entry entry{};
+        std::vector<uint8_t> symfile;
+    };
+
+} // namespace
+
+CodeRegistry::CodeRegistry() {
+#if defined(__linux__)
+    if (env_enabled(JIT_PERF_MAP_ENV)) {
+        const std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+        perf_map_ = std::fopen(path.c_str(), "a");
+    }
+    gdb_ = env_enabled(JIT_GDB_ENV);
+#endif
+}
+
+CodeRegistry::~CodeRegistry() {
+    // CodeCache::clear() đã gỡ mọi entry khỏi GDB trước khi unmap
+    if (perf_map_) std::fclose(perf_map_);
+}
+
+void CodeRegistry::add(const ObjFunctionProto* proto, const uint8_t* entry, size_t size,
+                       const std::vector<LineEntry>& lines) {
+    if (!enabled()) return;
+    const std::string name = symbol_name(proto);
+    if (perf_map_) write_perf_map(name, entry, size);
+    if (gdb_) register_gdb(name, entry, size, lines);
+}
+
+void CodeRegistry::write_perf_map(const std::string& name, const uint8_t* entry, size_t size) {
+    std::fprintf(perf_map_, "%lx %zx %s\n", static_cast<unsigned long>(reinterpret_cast<uintptr_t>(entry)),
+                 size, name.c_str());
+    std::fflush(perf_map_); // perf đọc file sau khi process kết thúc (kể cả khi bị kill)
+}
+
+void CodeRegistry::register_gdb(const std::string& name, const uint8_t* entry, size_t size,
+                                const std::vector<LineEntry>& lines) {
+#if defined(__linux__)
+    remove(entry); // Địa chỉ được tái sử dụng sau khi evict
+
+    auto* e = new GdbEntry();
+    e->symfile = build_symfile(name, entry, size, lines);
+    e->entry.symfile_addr = reinterpret_cast<const char*>(e->symfile.data());
+    e->entry.symfile_size = e->symfile.size();
+
+    e->entry.next_entry = __jit_debug_descriptor.first_entry;
+    if (e->entry.next_entry) e->entry.next_entry->prev_entry = &e->entry;
+    __jit_debug_descriptor.first_entry = &e->entry;
+    __jit_debug_descriptor.relevant_entry = &e->entry;
+    __jit_debug_descriptor.action_flag = JIT_REGISTER_FN;
+    __jit_debug_register_code();
+
+    gdb_entries_[entry] = e;
+#else
+    (void)name; (void)entry; (void)size; (void)lines;
+#endif
+}
+
+void CodeRegistry::remove(const uint8_t* entry) noexcept {
+    auto it = gdb_entries_.find(entry);
+    if (it == gdb_entries_.end()) return;
+    auto* e = static_cast<GdbEntry*>(it->second);
+    gdb_entries_.erase(it);
+
+    jit_code_entry* node = &e->entry;
+    if (node->prev_entry) node->prev_entry->next_entry = node->next_entry;
+    else __jit_debug_descriptor.first_entry = node->next_entry;
+    if (node->next_entry) node->next_entry->prev_entry = node->prev_entry;
+
+    __jit_debug_descriptor.relevant_entry = node;
+    __jit_debug_descriptor.action_flag = JIT_UNREGISTER_FN;
+    __jit_debug_register_code();
+    delete e;
+}
+
+} // namespace meow::jit
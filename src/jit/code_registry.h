@@ -0,0 +1,57 @@
+/**
+ * @file code_registry.h
+ * @brief Công bố mã JIT cho công cụ ngoài: perf map (/tmp/perf-<pid>.map) và GDB JIT interface
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace meow { class ObjFunctionProto; }
+
+namespace meow::jit {
+
+    // Một dòng trong line table: mã máy từ native_offset trở đi thuộc lệnh tại bc_offset
+    struct LineEntry {
+        uint32_t native_offset; // Tính từ đầu mã máy của hàm
+        uint32_t bc_offset;     // Offset trong chunk của proto (lệnh inline -> offset lệnh CALL)
+    };
+
+    /**
+     * @brief Thuộc CodeCache (đăng ký lúc install, gỡ khi release/evict).
+     * Tắt mặc định, bật lúc chạy bằng biến môi trường (JIT_PERF_MAP_ENV, JIT_GDB_ENV).
+     * - perf map: mỗi lần cài mã thêm một dòng "addr size meow:<tên proto>" (perf lấy dòng mới nhất).
+     * - GDB: mỗi hàm là một ELF object trong bộ nhớ (.text NOBITS tại địa chỉ thật, symbol,
+     *   DWARF .debug_line với số dòng = bytecode offset + 1), gỡ đăng ký khi mã bị evict/giải phóng.
+     */
+    class CodeRegistry {
+    public:
+        CodeRegistry();
+        ~CodeRegistry();
+
+        CodeRegistry(const CodeRegistry&) = delete;
+        CodeRegistry& operator=(const CodeRegistry&) = delete;
+
+        // Có công cụ nào cần line table không (tránh dựng khi tắt)
+        bool enabled() const noexcept { return perf_map_ != nullptr || gdb_; }
+
+        void add(const ObjFunctionProto* proto, const uint8_t* entry, size_t size,
+                 const std::vector<LineEntry>& lines);
+        void remove(const uint8_t* entry) noexcept;
+
+    private:
+        std::FILE* perf_map_ = nullptr;
+        bool gdb_ = false;
+        std::unordered_map<const uint8_t*, void*> gdb_entries_; // Địa chỉ mã -> jit_code_entry
+
+        void write_perf_map(const std::string& name, const uint8_t* entry, size_t size);
+        void register_gdb(const std::string& name, const uint8_t* entry, size_t size,
+                          const std::vector<LineEntry>& lines);
+    };
+
+} // namespace meow::jit
@@ -0,0 +1,67 @@
+#include "compile_queue.h"
+#include "jit_config.h"
+
+namespace meow::jit {
+
+bool CompileQueue::push(std::unique_ptr<CompileJob> job) {
+    std::lock_guard lock(mutex_);
+    if (stopping_ || pending_.size() >= JIT_COMPILE_QUEUE_MAX) return false;
+
+    // Tier-up theo lời gọi và OSR có thể cùng yêu cầu một proto
+    if (in_flight_ && in_flight_->proto == job->proto) return false;
+    for (const auto& j : pending_) if (j->proto == job->proto) return false;
+    for (const auto& j : ready_) if (j->proto == job->proto) return false;
+
+    pending_.push_back(std::move(job));
+    if (!worker_.joinable()) worker_ = std::thread(&CompileQueue::run, this);
+    cv_.notify_one();
+    return true;
+}
+
+std::vector<std::unique_ptr<CompileJob>> CompileQueue::take_ready() {
+    std::lock_guard lock(mutex_);
+    has_ready_.store(false, std::memory_order_relaxed);
+    return std::move(ready_);
+}
+
+void CompileQueue::cancel(const ObjFunctionProto* proto) noexcept {
+    std::lock_guard lock(mutex_);
+    if (in_flight_ && in_flight_->proto == proto) in_flight_->cancelled = true;
+    std::erase_if(pending_, [&](const auto& j) { return j->proto == proto; });
+    std::erase_if(ready_, [&](const auto& j) { return j->proto == proto; });
+}
+
+void CompileQueue::stop() noexcept {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        pending_.clear();
+        ready_.clear();
+        has_ready_.store(false, std::memory_order_relaxed);
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) worker_.join();
+}
+
+void CompileQueue::run() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+        if (stopping_) return;
+
+        std::unique_ptr<CompileJob> job = std::move(pending_.front());
+        pending_.pop_front();
+        in_flight_ = job.get();
+
+        lock.unlock();
+        compile_(*job);
+        lock.lock();
+
+        in_flight_ = nullptr;
+        if (job->cancelled || stopping_) continue;
+        ready_.push_back(std::move(job));
+        has_ready_.store(true, std::memory_order_relaxed);
+    }
+}
+
+} // namespace meow::jit
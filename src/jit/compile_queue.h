@@ -0,0 +1,93 @@
+/**
+ * @file compile_queue.h
+ * @brief Hàng đợi compile nền: Interpreter chụp bytecode + feedback, thread riêng sinh mã, cài lại ở safepoint
+ */
+
+#pragma once
+
+#include "inliner.h"
+#include "relocation.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Forward declarations
+namespace meow { class ObjFunctionProto; }
+
+namespace meow::jit {
+
+    /**
+     * @brief Bản chụp mọi thứ CodeGenerator cần đọc, dựng trên thread Interpreter.
+     * Thread compile không chạm vào heap: IC (nằm trong bytecode), constant pool của callee
+     * inline, deopt site đều là bản copy. Con trỏ IC trong mã sinh ra trỏ vào bản chụp và
+     * được relocate về chunk thật lúc cài.
+     */
+    struct CompileJob {
+        ObjFunctionProto* proto;
+        bool speculate;
+        std::vector<uint8_t> chunk;                        // Bản chụp chunk của proto (gồm IC)
+        std::vector<uint32_t> failed_sites;
+        std::optional<InlinedCode> inlined;                // caller_code/sites[].code/constants trỏ vào bản chụp
+        std::vector<std::vector<uint8_t>> site_chunks;
+        std::vector<std::vector<Value>> site_constants;
+        std::vector<const uint8_t*> site_targets;          // Chunk thật của từng callee (đích relocation)
+
+        std::optional<NativeCode> result;                  // Thread compile ghi, nullopt: bị từ chối
+        bool cancelled = false;                            // Proto bị GC thu hồi trong lúc compile
+
+        const uint8_t* bytecode() const noexcept { return inlined ? inlined->code.data() : chunk.data(); }
+        size_t length() const noexcept { return inlined ? inlined->code.size() : chunk.size(); }
+    };
+
+    /**
+     * @brief Một worker thread (mở lười ở job đầu tiên), FIFO giới hạn JIT_COMPILE_QUEUE_MAX.
+     * Kết quả chỉ được lấy ra bởi thread Interpreter (take_ready) nên CodeCache vẫn đơn luồng.
+     */
+    class CompileQueue {
+    public:
+        using CompileFn = std::function<void(CompileJob&)>;
+
+        explicit CompileQueue(CompileFn compile) : compile_(std::move(compile)) {}
+        ~CompileQueue() { stop(); }
+
+        CompileQueue(const CompileQueue&) = delete;
+        CompileQueue& operator=(const CompileQueue&) = delete;
+
+        // false nếu hàng đợi đầy, đã dừng, hoặc proto đã có job
+        bool push(std::unique_ptr<CompileJob> job);
+
+        // Có kết quả chờ cài không (load relaxed, rẻ để gọi ở mỗi safepoint)
+        bool has_ready() const noexcept { return has_ready_.load(std::memory_order_relaxed); }
+
+        // Lấy các job đã compile xong (bỏ job bị cancel)
+        std::vector<std::unique_ptr<CompileJob>> take_ready();
+
+        // Proto sắp bị hủy: bỏ mọi job của nó
+        void cancel(const ObjFunctionProto* proto) noexcept;
+
+        // Dừng worker, bỏ các job chưa compile
+        void stop() noexcept;
+
+    private:
+        CompileFn compile_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::unique_ptr<CompileJob>> pending_;
+        std::vector<std::unique_ptr<CompileJob>> ready_;
+        CompileJob* in_flight_ = nullptr;
+        std::atomic<bool> has_ready_{false};
+        bool stopping_ = false;
+        std::thread worker_;
+
+        void run();
+    };
+
+} // namespace meow::jit
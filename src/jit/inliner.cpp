@@ -0,0 +1,321 @@
+#include "inliner.h"
+#include "jit_config.h"
+#include "analysis/bytecode_analysis.h"
+#include "meow/core/function.h"
+#include "vm/handlers/inline_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace meow::jit {
+
+namespace {
+
+    constexpr size_t NO_LABEL = static_cast<size_t>(-1);
+
+    // Register của callee sau khi đổi tên có thể vượt 255 -> _B dùng bản 16-bit cùng ngữ nghĩa
+    OpCode widen(OpCode op) {
+        switch (op) {
+            case OpCode::ADD_B: return OpCode::ADD;
+            case OpCode::SUB_B: return OpCode::SUB;
+            case OpCode::MUL_B: return OpCode::MUL;
+            case OpCode::DIV_B: return OpCode::DIV;
+            case OpCode::MOD_B: return OpCode::MOD;
+            case OpCode::INC_B: return OpCode::INC;
+            case OpCode::DEC_B: return OpCode::DEC;
+            case OpCode::NEG_B: return OpCode::NEG;
+            case OpCode::NOT_B: return OpCode::NOT;
+            case OpCode::BIT_AND_B: return OpCode::BIT_AND;
+            case OpCode::BIT_OR_B:  return OpCode::BIT_OR;
+            case OpCode::BIT_XOR_B: return OpCode::BIT_XOR;
+            case OpCode::BIT_NOT_B: return OpCode::BIT_NOT;
+            case OpCode::LSHIFT_B:  return OpCode::LSHIFT;
+            case OpCode::RSHIFT_B:  return OpCode::RSHIFT;
+            case OpCode::EQ_B:  return OpCode::EQ;
+            case OpCode::NEQ_B: return OpCode::NEQ;
+            case OpCode::GT_B:  return OpCode::GT;
+            case OpCode::GE_B:  return OpCode::GE;
+            case OpCode::LT_B:  return OpCode::LT;
+            case OpCode::LE_B:  return OpCode::LE;
+            case OpCode::MOVE_B:       return OpCode::MOVE;
+            case OpCode::LOAD_CONST_B: return OpCode::LOAD_CONST;
+            case OpCode::LOAD_INT_B:   return OpCode::LOAD_INT;
+            case OpCode::LOAD_FLOAT_B: return OpCode::LOAD_FLOAT;
+            case OpCode::LOAD_NULL_B:  return OpCode::LOAD_NULL;
+            case OpCode::LOAD_TRUE_B:  return OpCode::LOAD_TRUE;
+            case OpCode::LOAD_FALSE_B: return OpCode::LOAD_FALSE;
+            case OpCode::JUMP_IF_TRUE_B:  return OpCode::JUMP_IF_TRUE;
+            case OpCode::JUMP_IF_FALSE_B: return OpCode::JUMP_IF_FALSE;
+            case OpCode::JUMP_IF_EQ_B:  return OpCode::JUMP_IF_EQ;
+            case OpCode::JUMP_IF_NEQ_B: return OpCode::JUMP_IF_NEQ;
+            case OpCode::JUMP_IF_GT_B:  return OpCode::JUMP_IF_GT;
+            case OpCode::JUMP_IF_GE_B:  return OpCode::JUMP_IF_GE;
+            case OpCode::JUMP_IF_LT_B:  return OpCode::JUMP_IF_LT;
+            case OpCode::JUMP_IF_LE_B:  return OpCode::JUMP_IF_LE;
+            case OpCode::ADD_I_B: return OpCode::ADD_I;
+            case OpCode::SUB_I_B: return OpCode::SUB_I;
+            case OpCode::MUL_I_B: return OpCode::MUL_I;
+            case OpCode::EQ_I_B:  return OpCode::EQ_I;
+            case OpCode::NEQ_I_B: return OpCode::NEQ_I;
+            case OpCode::GT_I_B:  return OpCode::GT_I;
+            case OpCode::GE_I_B:  return OpCode::GE_I;
+            case OpCode::LT_I_B:  return OpCode::LT_I;
+            case OpCode::LE_I_B:  return OpCode::LE_I;
+            case OpCode::JUMP_IF_EQ_I_B:  return OpCode::JUMP_IF_EQ_I;
+            case OpCode::JUMP_IF_NEQ_I_B: return OpCode::JUMP_IF_NEQ_I;
+            case OpCode::JUMP_IF_GT_I_B:  return OpCode::JUMP_IF_GT_I;
+            case OpCode::JUMP_IF_GE_I_B:  return OpCode::JUMP_IF_GE_I;
+            case OpCode::JUMP_IF_LT_I_B:  return OpCode::JUMP_IF_LT_I;
+            case OpCode::JUMP_IF_LE_I_B:  return OpCode::JUMP_IF_LE_I;
+            default: return op;
+        }
+    }
+
+    // Một lệnh của bytecode mới (offset chỉ biết sau khi xếp chỗ xong)
+    struct Piece {
+        OpCode op;
+        std::vector<int64_t> operands; // Theo OpSchema của op; OFFSET16 được điền lại từ label
+        const uint8_t* ic = nullptr;   // Inline Cache đi kèm (copy nguyên)
+        size_t ic_len = 0;
+        InlineOrigin origin;
+        size_t target = NO_LABEL;
+    };
+
+    // Site được chọn inline: lệnh thứ insn của caller gọi callee
+    struct Plan {
+        size_t insn;
+        ObjFunctionProto* callee;
+        analysis::DecodedCode body;
+        uint16_t num_regs;
+    };
+
+    size_t ic_bytes(OpCode op) {
+        return get_op_info(op).operand_bytes - get_op_schema(op).get_operand_bytes();
+    }
+
+    void append(std::vector<uint8_t>& out, const void* src, size_t n) {
+        const auto* p = static_cast<const uint8_t*>(src);
+        out.insert(out.end(), p, p + n);
+    }
+
+    void encode(std::vector<uint8_t>& out, const Piece& piece) {
+        out.push_back(static_cast<uint8_t>(piece.op));
+        const OpSchema& schema = get_op_schema(piece.op);
+        for (uint8_t i = 0; i < schema.count; ++i) {
+            int64_t v = piece.operands[i];
+            switch (schema.args[i]) {
+                case ArgType::REG8: out.push_back(static_cast<uint8_t>(v)); break;
+                case ArgType::REG16: case ArgType::U16: case ArgType::CONST_IDX: case ArgType::OFFSET16: case ArgType::I16: {
+                    uint16_t x = static_cast<uint16_t>(v); append(out, &x, 2); break;
+                }
+                case ArgType::U32: case ArgType::OFFSET32: {
+                    uint32_t x = static_cast<uint32_t>(v); append(out, &x, 4); break;
+                }
+                case ArgType::I64: case ArgType::F64: append(out, &v, 8); break;
+                default: break;
+            }
+        }
+        if (piece.ic_len) append(out, piece.ic, piece.ic_len);
+    }
+
+    // Callee có inline được không: nhỏ, không gọi tiếp, chỉ thoát bằng RETURN
+    bool can_inline(const ObjFunctionProto* caller, ObjFunctionProto* callee, OpFilter supported, Plan& plan) {
+        if (callee == caller || callee->get_num_upvalues() != 0) return false;
+
+        const Chunk& chunk = callee->get_chunk();
+        plan.body = analysis::decode(chunk.get_code(), chunk.get_code_size());
+        const auto& insns = plan.body.insns;
+        if (!plan.body.valid || insns.empty() || insns.size() > JIT_INLINE_MAX_INSNS) return false;
+
+        for (const auto& insn : insns) {
+            switch (insn.op) {
+                case OpCode::CALL: case OpCode::CALL_VOID: case OpCode::TAIL_CALL: case OpCode::HALT:
+                    return false;
+                default: break;
+            }
+            if (!supported(insn.op)) return false;
+            // Chạy quá cuối chunk (vùng đệm HALT) -> không có giá trị trả về để nối vào caller
+            for (size_t s : insn.succs) if (s == insns.size()) return false;
+        }
+
+        plan.callee = callee;
+        plan.num_regs = static_cast<uint16_t>(std::max<size_t>(plan.body.num_regs, callee->get_num_registers()));
+        return true;
+    }
+
+} // namespace
+
+std::optional<InlinedCode> inline_calls(ObjFunctionProto* caller, OpFilter supported) {
+    if (!ENABLE_INLINING) return std::nullopt;
+
+    const Chunk& chunk = caller->get_chunk();
+    const uint8_t* code = chunk.get_code();
+    const size_t len = chunk.get_code_size();
+    const auto& failed = caller->get_deopt_sites();
+
+    analysis::DecodedCode dc = analysis::decode(code, len);
+    if (!dc.valid) return std::nullopt;
+    const size_t n = dc.insns.size();
+
+    // 1. Chọn site. Còn lệnh backend không hỗ trợ (kể cả CALL không inline được) thì
+    //    caller vẫn ở lại Interpreter -> không cần inline gì cả.
+    std::vector<Plan> plans;
+    size_t frame_regs = dc.num_regs;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& insn = dc.insns[i];
+        if (insn.op != OpCode::CALL && insn.op != OpCode::CALL_VOID) {
+            if (!supported(insn.op)) return std::nullopt;
+            continue;
+        }
+        if (std::find(failed.begin(), failed.end(), insn.offset) != failed.end()) return std::nullopt;
+
+        handlers::CallIC ic;
+        std::memcpy(&ic, code + insn.offset + 1 + get_op_schema(insn.op).get_operand_bytes(), sizeof(ic));
+        if (!ic.destination || ic.destination != ic.check_tag) return std::nullopt;
+
+        Plan plan{};
+        plan.insn = i;
+        if (!can_inline(caller, static_cast<ObjFunctionProto*>(ic.destination), supported, plan)) return std::nullopt;
+
+        frame_regs += 1 + plan.num_regs;
+        if (frame_regs >= analysis::NO_REG) return std::nullopt;
+        plans.push_back(std::move(plan));
+    }
+    if (plans.empty()) return std::nullopt;
+
+    // 2. Dựng danh sách lệnh. Label 0..n-1 là lệnh của caller, n là cuối chunk.
+    InlinedCode out;
+    out.caller_code = code;
+
+    std::vector<Piece> pieces;
+    std::vector<size_t> label_piece(n + 1, NO_LABEL);
+    std::vector<std::pair<size_t, size_t>> call_pieces; // {piece, site}
+
+    auto copy_insn = [&](const uint8_t* base, const analysis::Instruction& insn, InlineOrigin origin) {
+        Piece p;
+        p.op = insn.op;
+        p.operands = analysis::read_operands(base, insn.offset);
+        p.ic = base + insn.offset + 1 + get_op_schema(insn.op).get_operand_bytes();
+        p.ic_len = ic_bytes(insn.op);
+        p.origin = origin;
+        return p;
+    };
+    auto emit = [&](OpCode op, std::vector<int64_t> operands, InlineOrigin origin, size_t target = NO_LABEL) {
+        Piece p;
+        p.op = op;
+        p.operands = std::move(operands);
+        p.origin = origin;
+        p.target = target;
+        pieces.push_back(std::move(p));
+    };
+
+    size_t next_slot = dc.num_regs;
+    size_t plan_idx = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& insn = dc.insns[i];
+        const InlineOrigin here{static_cast<uint32_t>(insn.offset), -1};
+        label_piece[i] = pieces.size();
+
+        if (plan_idx == plans.size() || plans[plan_idx].insn != i) {
+            Piece p = copy_insn(code, insn, here);
+            p.target = insn.target;
+            pieces.push_back(std::move(p));
+            continue;
+        }
+
+        const Plan& plan = plans[plan_idx];
+        const int32_t site_idx = static_cast<int32_t>(plan_idx++);
+        const uint16_t slot = static_cast<uint16_t>(next_slot);
+        const int64_t base = slot + 1;
+        next_slot += 1 + plan.num_regs;
+
+        const Chunk& callee_chunk = plan.callee->get_chunk();
+        const uint8_t* callee_code = callee_chunk.get_code();
+        out.sites.push_back({static_cast<uint32_t>(insn.offset), plan.callee, callee_code,
+                             callee_chunk.get_constants_raw(), slot, plan.num_regs});
+
+        // a. CALL giữ nguyên làm guard (CodeGenerator kiểm tra proto và cất closure vào slot)
+        call_pieces.push_back({pieces.size(), static_cast<size_t>(site_idx)});
+        pieces.push_back(copy_insn(code, insn, here));
+
+        // b. Tham số -> register của callee; register đọc trước khi ghi mà không có tham số -> null
+        std::vector<int64_t> ops = pieces.back().operands;
+        const bool has_dst = insn.op == OpCode::CALL;
+        const int64_t dst = has_dst ? ops[0] : analysis::NO_REG;
+        const int64_t arg_start = has_dst ? ops[2] : ops[1];
+        const int64_t argc = has_dst ? ops[3] : ops[2];
+
+        const int64_t copied = std::min<int64_t>(argc, plan.num_regs);
+        for (int64_t r = 0; r < copied; ++r) emit(OpCode::MOVE, {base + r, arg_start + r}, here);
+
+        analysis::Liveness entry_live(plan.body.insns, plan.body.num_regs);
+        for (int64_t r = copied; r < plan.body.num_regs; ++r) {
+            if (entry_live.is_live_in(0, static_cast<uint16_t>(r))) emit(OpCode::LOAD_NULL, {base + r}, here);
+        }
+
+        // c. Thân callee: đổi tên register, nhảy nội bộ qua label riêng, RETURN -> MOVE + JUMP
+        const size_t cont = i + 1;
+        const size_t body_first = label_piece.size();
+        label_piece.resize(body_first + plan.body.insns.size(), NO_LABEL);
+
+        for (size_t j = 0; j < plan.body.insns.size(); ++j) {
+            const auto& b = plan.body.insns[j];
+            const InlineOrigin origin{static_cast<uint32_t>(b.offset), site_idx};
+            label_piece[body_first + j] = pieces.size();
+
+            if (b.op == OpCode::RETURN) {
+                int64_t reg = analysis::read_operands(callee_code, b.offset)[0];
+                if (dst != analysis::NO_REG) {
+                    if (reg == analysis::NO_REG) emit(OpCode::LOAD_NULL, {dst}, origin);
+                    else emit(OpCode::MOVE, {dst, base + reg}, origin);
+                }
+                if (j + 1 < plan.body.insns.size()) emit(OpCode::JUMP, {0}, origin, cont);
+                continue;
+            }
+
+            Piece p = copy_insn(callee_code, b, origin);
+            const OpSchema& schema = get_op_schema(b.op);
+            for (uint8_t k = 0; k < schema.count; ++k) {
+                if (schema.args[k] == ArgType::REG8 || schema.args[k] == ArgType::REG16) p.operands[k] += base;
+            }
+            p.op = widen(b.op);
+            if (b.target != analysis::NO_INDEX) p.target = body_first + b.target;
+            pieces.push_back(std::move(p));
+        }
+    }
+    label_piece[n] = pieces.size();
+
+    // 3. Xếp chỗ rồi encode (offset nhảy vẫn là i16 tương đối với lệnh kế tiếp)
+    std::vector<size_t> offsets(pieces.size() + 1, 0);
+    for (size_t k = 0; k < pieces.size(); ++k) {
+        offsets[k + 1] = offsets[k] + 1 + get_op_info(pieces[k].op).operand_bytes;
+    }
+
+    for (size_t k = 0; k < pieces.size(); ++k) {
+        Piece& p = pieces[k];
+        if (p.target != NO_LABEL) {
+            int64_t rel = static_cast<int64_t>(offsets[label_piece[p.target]]) - static_cast<int64_t>(offsets[k + 1]);
+            if (rel < INT16_MIN || rel > INT16_MAX) return std::nullopt;
+            const OpSchema& schema = get_op_schema(p.op);
+            for (uint8_t a = 0; a < schema.count; ++a) {
+                if (schema.args[a] == ArgType::OFFSET16) p.operands[a] = rel;
+            }
+        }
+        out.origins[offsets[k]] = p.origin;
+        encode(out.code, p);
+    }
+    out.origins[offsets.back()] = InlineOrigin{static_cast<uint32_t>(len), -1};
+
+    for (auto [piece, site] : call_pieces) out.call_sites[offsets[piece]] = site;
+
+    // Site đã deopt của caller (chỉ còn GET_PROP/SET_PROP/số học) -> offset mới
+    for (uint32_t f : failed) {
+        auto it = dc.index_of.find(f);
+        if (it != dc.index_of.end()) out.failed_sites.push_back(static_cast<uint32_t>(offsets[label_piece[it->second]]));
+    }
+
+    out.num_regs = next_slot;
+    return out;
+}
+
+} // namespace meow::jit
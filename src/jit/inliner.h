@@ -0,0 +1,70 @@
+/**
+ * @file inliner.h
+ * @brief Inline hàm nhỏ monomorphic vào caller ở mức bytecode trước khi sinh mã máy
+ */
+
+#pragma once
+
+#include "meow/bytecode/op_codes.h"
+#include "meow/value.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace meow { class ObjFunctionProto; }
+
+namespace meow::jit {
+
+    // Một lời gọi đã được thay bằng thân hàm
+    struct InlineSite {
+        uint32_t call_offset;             // Offset lệnh CALL/CALL_VOID trong caller
+        const ObjFunctionProto* callee;   // Proto mà CallIC ghi nhận (guard so sánh closure->proto_)
+        const uint8_t* code;              // Bytecode gốc của callee (IC được cập nhật tại đây)
+        const Value* constants;           // Constant pool của callee (mã máy nhúng giá trị trực tiếp)
+        uint16_t closure_slot;            // Register giữ closure; register r của callee -> closure_slot + 1 + r
+        uint16_t num_regs;                // Số register frame callee cần khi bị materialize lúc deopt
+    };
+
+    // Nguồn gốc của một lệnh trong bytecode đã inline
+    struct InlineOrigin {
+        uint32_t offset;   // Offset trong chunk gốc (của caller hoặc callee)
+        int32_t site = -1; // -1: lệnh của caller, còn lại: chỉ số trong InlinedCode::sites
+    };
+
+    /**
+     * @brief Bytecode của caller sau khi inline, CodeGenerator compile như một hàm bình thường.
+     * Mỗi site giữ nguyên lệnh CALL làm guard (callee khác -> deopt, Interpreter gọi lại như cũ),
+     * theo sau là MOVE tham số vào vùng register riêng của callee, thân callee đã đổi tên
+     * register (_B -> bản 16-bit) và RETURN -> MOVE dst + JUMP về lệnh sau CALL.
+     */
+    struct InlinedCode {
+        std::vector<uint8_t> code;
+        std::unordered_map<size_t, InlineOrigin> origins; // Offset đầu lệnh trong code -> nguồn gốc
+        std::unordered_map<size_t, size_t> call_sites;    // Offset lệnh CALL (trong code) -> chỉ số site
+        std::vector<InlineSite> sites;
+        std::vector<uint32_t> failed_sites;               // deopt_sites của caller, đổi sang offset trong code
+        const uint8_t* caller_code = nullptr;
+        size_t num_regs = 0;                              // Kích thước frame caller cần (gồm vùng của callee)
+
+        InlineOrigin origin(size_t offset) const { return origins.at(offset); }
+
+        // Con trỏ tới lệnh gốc (IC của GET_PROP/SET_PROP phải được đọc/ghi ở chunk thật)
+        const uint8_t* source(size_t offset) const {
+            InlineOrigin o = origin(offset);
+            return (o.site < 0 ? caller_code : sites[o.site].code) + o.offset;
+        }
+    };
+
+    using OpFilter = bool (*)(OpCode);
+
+    /**
+     * @brief Inline các CALL/CALL_VOID có CallIC chỉ từng thấy một proto, callee không quá
+     * JIT_INLINE_MAX_INSNS lệnh, chỉ dùng opcode backend hỗ trợ (supported) và không gọi tiếp.
+     * Site nằm trong deopt_sites của caller (guard/thân hàm từng deopt) không được inline nữa.
+     * @return nullopt nếu không có site nào được inline
+     */
+    std::optional<InlinedCode> inline_calls(ObjFunctionProto* caller, OpFilter supported);
+
+} // namespace meow::jit
@@ -1,17 +1,14 @@
 #include "jit_compiler.h"
 #include "jit_config.h"
 #include "x64/code_generator.h"
+#include "x64/baseline_generator.h"
+#include "inliner.h"
+#include "meow/core/function.h"
 
 #include <iostream>
-#include <cstring>
-
-// Platform specific headers for memory management
-#if defined(_WIN32)
-    #include <windows.h>
-#else
-    #include <sys/mman.h>
-    #include <unistd.h>
-#endif
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace meow::jit {
 
@@ -20,105 +17,209 @@ JitCompiler& JitCompiler::instance() {
     return instance;
 }
 
-// Bộ nhớ JIT: Cần quyền Read + Write (lúc ghi code) và Execute (lúc chạy)
-// Vì lý do bảo mật (W^X), thường ta không nên để cả Write và Execute cùng lúc.
-// Nhưng để đơn giản cho project này, ta sẽ set RWX (Read-Write-Execute).
-// (Production grade thì nên: W -> mprotect -> X)
+// Bộ nhớ JIT do CodeCache quản lý theo W^X:
+// CodeGenerator sinh mã vào buffer tạm (RW thường), biết chính xác kích thước,
+// sau đó mới copy vào region RX. Mã sinh ra không phụ thuộc địa chỉ nạp
+// (nhảy nội bộ dùng rel32, gọi runtime qua địa chỉ tuyệt đối). Địa chỉ tuyệt đối
+// được ghi lại thành Relocation để AOT image (aot/native_image.h) vá ở process khác.
 
-struct JitMemory {
-    uint8_t* ptr = nullptr;
-    size_t size = 0;
-};
+void JitCompiler::initialize() {
+    // Region đầu tiên được mở lười ở lần install đầu tiên (CodeCache::acquire_region)
+}
 
-static JitMemory g_jit_mem;
+void JitCompiler::shutdown() {
+    queue_.stop();
+    cache_.clear();
+}
 
-void JitCompiler::initialize() {
-    if (g_jit_mem.ptr) return; // Đã init
+namespace {
+
+// Sinh mã vào buffer tạm (ước lượng ban đầu, nhân đôi khi Assembler báo tràn) rồi copy ra NativeCode
+template <typename Generator, typename CompileFn>
+std::optional<NativeCode> emit_native(size_t length, CompileFn&& compile) {
+    size_t scratch_size = length * 32 + 1024;
+    std::vector<uint8_t> scratch;
+
+    for (int attempt = 0; attempt < 4; ++attempt, scratch_size *= 2) {
+        scratch.resize(scratch_size);
+
+        Generator gen(scratch.data(), scratch.size());
+        bool ok = compile(gen);
 
-    size_t capacity = JIT_CACHE_SIZE;
+        if (gen.overflowed()) continue;
+        if (!ok) return std::nullopt;
 
-#if defined(_WIN32)
-    void* ptr = VirtualAlloc(nullptr, capacity, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
-    if (!ptr) {
-        std::cerr << "[JIT] Failed to allocate executable memory (Windows)!" << std::endl;
-        return;
+        NativeCode native;
+        native.code.assign(scratch.begin(), scratch.begin() + gen.code_size());
+        native.osr_entries = gen.osr_entries();
+        native.relocs = gen.relocs();
+        native.lines = gen.line_table();
+        return native;
     }
-    g_jit_mem.ptr = static_cast<uint8_t*>(ptr);
-#else
-    void* ptr = mmap(nullptr, capacity, 
-                     PROT_READ | PROT_WRITE | PROT_EXEC, 
-                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (ptr == MAP_FAILED) {
-        std::cerr << "[JIT] Failed to allocate executable memory (mmap)!" << std::endl;
-        return;
+
+    std::cerr << "[JIT] Generated code too large, giving up" << std::endl;
+    return std::nullopt;
+}
+
+} // namespace
+
+std::optional<NativeCode> JitCompiler::generate(const uint8_t* bytecode, size_t length, bool speculate,
+                                                const std::vector<uint32_t>& failed_sites,
+                                                const InlinedCode* inlined, bool relocatable) {
+    return emit_native<x64::CodeGenerator>(length, [&](x64::CodeGenerator& codegen) {
+        codegen.set_relocatable(relocatable);
+        return codegen.compile(bytecode, length, speculate, failed_sites, inlined) != nullptr;
+    });
+}
+
+std::optional<NativeCode> JitCompiler::generate_baseline(const uint8_t* bytecode, size_t length) {
+    if (!ENABLE_BASELINE_JIT) return std::nullopt;
+    return emit_native<x64::BaselineGenerator>(length, [&](x64::BaselineGenerator& gen) {
+        return gen.compile(bytecode, length);
+    });
+}
+
+JitFunc JitCompiler::compile(ObjFunctionProto* proto) {
+    const Chunk& chunk = proto->get_chunk();
+    const uint8_t* bytecode = chunk.get_code();
+    size_t length = chunk.get_code_size();
+
+    // Tier speculative cho tới khi proto deopt quá nhiều lần, sau đó chỉ còn bản generic
+    const bool speculate = ENABLE_SPECULATION && proto->get_deopt_count() < JIT_MAX_DEOPTS;
+
+    // Thay CALL tới hàm nhỏ monomorphic bằng thân hàm (caller thường thành leaf, compile được)
+    std::optional<InlinedCode> inlined = inline_calls(proto, &x64::CodeGenerator::is_supported);
+    if (inlined) {
+        bytecode = inlined->code.data();
+        length = inlined->code.size();
+    }
+    const std::vector<uint32_t>& failed_sites = inlined ? inlined->failed_sites : proto->get_deopt_sites();
+
+    std::optional<NativeCode> native = generate(bytecode, length, speculate, failed_sites,
+                                                inlined ? &*inlined : nullptr, false);
+    bool baseline = false;
+    if (!native) {
+        // Template JIT từ chối (opcode chưa hỗ trợ) -> baseline phủ mọi opcode
+        native = generate_baseline(chunk.get_code(), chunk.get_code_size());
+        if (!native) return nullptr;
+        inlined.reset();
+        baseline = true;
     }
-    g_jit_mem.ptr = static_cast<uint8_t*>(ptr);
-#endif
 
-    g_jit_mem.size = capacity;
+    uint8_t* entry = cache_.install(proto, native->code.data(), native->code.size(),
+                                    std::move(native->osr_entries), native->lines);
+    if (!entry) {
+        std::cerr << "[JIT] Code cache exhausted, function stays interpreted" << std::endl;
+        return nullptr;
+    }
+
+    // Register của callee nằm sau vùng của caller: frame mới push sẽ đủ chỗ,
+    // frame đang chạy được nới ra trước khi vào mã máy (handlers::reserve_jit_frame)
+    if (inlined) proto->reserve_registers(inlined->num_regs);
+
     if (JIT_DEBUG_LOG) {
-        std::cout << "[JIT] Initialized " << (capacity / 1024) << "KB executable memory at " 
-                  << (void*)g_jit_mem.ptr << std::endl;
+        std::cout << "[JIT] Compiled bytecode len=" << length << " -> " << native->code.size()
+                  << " bytes at " << (void*)entry << (baseline ? " (baseline)" : speculate ? " (speculative)" : "")
+                  << (inlined ? " (" + std::to_string(inlined->sites.size()) + " inlined calls)" : "") << std::endl;
     }
+    return reinterpret_cast<JitFunc>(entry);
 }
 
-void JitCompiler::shutdown() {
-    if (!g_jit_mem.ptr) return;
-
-#if defined(_WIN32)
-    VirtualFree(g_jit_mem.ptr, 0, MEM_RELEASE);
-#else
-    munmap(g_jit_mem.ptr, g_jit_mem.size);
-#endif
-    g_jit_mem.ptr = nullptr;
-    g_jit_mem.size = 0;
+JitFunc JitCompiler::request_compile(ObjFunctionProto* proto) {
+    if (!ENABLE_BACKGROUND_COMPILE) return compile(proto);
+
+    if (queue_.push(snapshot(proto))) proto->set_jit_queued(true);
+    return nullptr;
 }
 
-JitFunc JitCompiler::compile(const uint8_t* bytecode, size_t length) {
-    if (!g_jit_mem.ptr) {
-        initialize();
-        if (!g_jit_mem.ptr) return nullptr;
+std::unique_ptr<CompileJob> JitCompiler::snapshot(ObjFunctionProto* proto) {
+    auto job = std::make_unique<CompileJob>();
+    const Chunk& chunk = proto->get_chunk();
+
+    job->proto = proto;
+    job->speculate = ENABLE_SPECULATION && proto->get_deopt_count() < JIT_MAX_DEOPTS;
+    job->chunk.assign(chunk.get_code(), chunk.get_code() + chunk.get_code_size());
+    job->failed_sites = proto->get_deopt_sites();
+
+    // Quyết định inline đọc CallIC nên phải chạy ở đây; mọi con trỏ của InlinedCode được đổi sang bản chụp
+    job->inlined = inline_calls(proto, &x64::CodeGenerator::is_supported);
+    if (job->inlined) {
+        InlinedCode& inl = *job->inlined;
+        inl.caller_code = job->chunk.data();
+        job->failed_sites = inl.failed_sites;
+
+        job->site_chunks.reserve(inl.sites.size());
+        job->site_constants.reserve(inl.sites.size());
+        for (InlineSite& site : inl.sites) {
+            const Chunk& callee = site.callee->get_chunk();
+            job->site_targets.push_back(callee.get_code());
+            job->site_chunks.emplace_back(callee.get_code(), callee.get_code() + callee.get_code_size());
+            site.code = job->site_chunks.back().data();
+
+            std::vector<Value>& pool = job->site_constants.emplace_back();
+            for (size_t i = 0; i < callee.get_pool_size(); ++i) pool.push_back(callee.get_constant(i));
+            site.constants = pool.data();
+        }
     }
+    return job;
+}
 
-    // TODO: Quản lý bộ nhớ tốt hơn (Bump pointer allocator)
-    // Hiện tại: Reset bộ đệm mỗi lần compile (Chỉ chạy được 1 hàm JIT tại 1 thời điểm)
-    // Để chạy nhiều hàm, bạn cần một con trỏ `current_offset` toàn cục.
-    static size_t current_offset = 0;
-
-    // Align 16 bytes
-    while (current_offset % 16 != 0) current_offset++;
+void JitCompiler::compile_job(CompileJob& job) {
+    job.result = generate(job.bytecode(), job.length(), job.speculate, job.failed_sites,
+                          job.inlined ? &*job.inlined : nullptr, false);
+    if (!job.result) {
+        job.result = generate_baseline(job.chunk.data(), job.chunk.size());
+        job.inlined.reset();
+    }
+}
 
-    if (current_offset + length * 10 > g_jit_mem.size) { // Ước lượng size * 10
-        std::cerr << "[JIT] Cache full! Resetting..." << std::endl;
-        current_offset = 0; // Reset "ngây thơ"
+void JitCompiler::install_ready() {
+    for (std::unique_ptr<CompileJob>& job : queue_.take_ready()) {
+        ObjFunctionProto* proto = job->proto;
+        proto->set_jit_queued(false);
+        if (!job->result || proto->get_jit_entry()) continue;
+
+        // IC trong mã sinh ra đang trỏ vào bản chụp -> đổi về chunk thật
+        NativeCode& native = *job->result;
+        apply_relocations(native.code.data(), native.relocs, proto->get_chunk().get_code(), job->site_targets);
+
+        uint8_t* entry = cache_.install(proto, native.code.data(), native.code.size(),
+                                        std::move(native.osr_entries), native.lines);
+        if (!entry) {
+            std::cerr << "[JIT] Code cache exhausted, function stays interpreted" << std::endl;
+            continue;
+        }
+        if (job->inlined) proto->reserve_registers(job->inlined->num_regs);
+
+        if (JIT_DEBUG_LOG) {
+            std::cout << "[JIT] Installed background compile len=" << job->length() << " -> "
+                      << native.code.size() << " bytes at " << (void*)entry << std::endl;
+        }
     }
+}
+
+std::optional<NativeCode> JitCompiler::compile_relocatable(ObjFunctionProto* proto) {
+    // Không inline (guard nhúng địa chỉ proto callee) và chưa có deopt site nào: chỉ phụ thuộc bytecode
+    const Chunk& chunk = proto->get_chunk();
+    std::optional<NativeCode> native = generate(chunk.get_code(), chunk.get_code_size(), ENABLE_SPECULATION, {}, nullptr, true);
+    if (!native) native = generate_baseline(chunk.get_code(), chunk.get_code_size());
+    return native;
+}
 
-    uint8_t* buffer_start = g_jit_mem.ptr + current_offset;
-    size_t remaining_size = g_jit_mem.size - current_offset;
-
-    // Gọi Backend để sinh mã
-    x64::CodeGenerator codegen(buffer_start, remaining_size);
-    JitFunc fn = codegen.compile(bytecode, length);
-
-    // Cập nhật offset (CodeGenerator đã ghi bao nhiêu bytes?)
-    // Ta cần API lấy size từ CodeGenerator, nhưng hiện tại lấy qua con trỏ hàm trả về thì hơi khó.
-    // Tốt nhất là CodeGenerator trả về struct { func_ptr, code_size }.
-    // Tạm thời fix cứng: lấy current cursor từ codegen (cần sửa CodeGenerator public method).
-    // Vì CodeGenerator::compile trả về void*, ta giả định nó ghi tiếp nối.
-    // Hack tạm: truy cập vào asm bên trong (cần friend class hoặc getter).
-    
-    // Giả sử ta sửa CodeGenerator để trả về size hoặc tự tính:
-    // CodeGenerator instance sẽ bị hủy, ta không query được size.
-    // ==> Giải pháp: CodeGenerator::compile nên update 1 biến size tham chiếu.
-    
-    // (Để code chạy được ngay, ta cứ tăng offset một lượng an toàn hoặc để reset mỗi lần test)
-    current_offset += (length * 10); // Hacky estimation
+JitFunc JitCompiler::install_native(ObjFunctionProto* proto, const NativeCode& native) {
+    std::vector<uint8_t> code = native.code;
+    apply_relocations(code.data(), native.relocs, proto->get_chunk().get_code());
+    uint8_t* entry = cache_.install(proto, code.data(), code.size(), native.osr_entries, native.lines);
+    return reinterpret_cast<JitFunc>(entry);
+}
 
-    if (JIT_DEBUG_LOG) {
-        std::cout << "[JIT] Compiled bytecode len=" << length << " to addr=" << (void*)fn << std::endl;
+JitFunc JitCompiler::osr_entry(const ObjFunctionProto* proto, size_t bc_offset) const noexcept {
+    const CodeEntry* code = cache_.find(proto);
+    if (!code) return nullptr;
+    for (const OsrEntry& osr : code->osr_entries) {
+        if (osr.bc_offset == bc_offset) return reinterpret_cast<JitFunc>(code->entry + osr.native_offset);
     }
-
-    return fn;
+    return nullptr;
 }
 
-} // namespace meow::jit
\ No newline at end of file
+} // namespace meow::jit
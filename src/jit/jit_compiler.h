@@ -6,40 +6,102 @@
 #pragma once
 
 #include "meow/value.h"
+#include "code_cache.h"
+#include "compile_queue.h"
+#include "relocation.h"
 #include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <vector>
 
 // Forward declarations
-namespace meow { struct VMState; }
+namespace meow { struct VMState; class ObjFunctionProto; }
 
 namespace meow::jit {
 
+    // deopt_offset khi hàm chạy xong bình thường
+    static constexpr uint64_t JIT_NO_DEOPT = ~0ULL;
+
+    // Deopt bên trong hàm được inline: deopt_offset = JIT_INLINE_DEOPT | (closure_slot << 32) | offset trong callee,
+    // value = offset lệnh CALL của caller. Interpreter dựng frame callee rồi chạy tiếp trong callee.
+    static constexpr uint64_t JIT_INLINE_DEOPT = 1ULL << 63;
+
+    // Mã baseline (x64/baseline_generator.h) trả quyền cho Interpreter: value = IP chạy tiếp
+    // (0: HALT), frame đã được handler cập nhật. Không phải deopt, mã vẫn được giữ.
+    static constexpr uint64_t JIT_BASELINE_EXIT = JIT_NO_DEOPT - 1;
+
+    // Kết quả trả về trong RAX:RDX (System V: struct 2 x INTEGER)
+    struct JitResult {
+        uint64_t value;        // Raw bits của giá trị RETURN
+        uint64_t deopt_offset; // Guard fail: bytecode offset để Interpreter chạy tiếp (xem JIT_INLINE_DEOPT, JIT_BASELINE_EXIT), còn lại JIT_NO_DEOPT
+    };
+
     // Signature của hàm sau khi đã được JIT
-    using JitFunc = void (*)(meow::VMState*);
+    // Chạy trên frame hiện tại (state->registers/constants)
+    using JitFunc = JitResult (*)(meow::VMState*);
 
     class JitCompiler {
     public:
         // Singleton: Chỉ cần 1 trình biên dịch trong suốt vòng đời VM
         static JitCompiler& instance();
 
-        // Chuẩn bị bộ nhớ (mmap, quyền execute...)
+        // Chuẩn bị bộ nhớ (mmap region đầu tiên)
         void initialize();
 
-        // Dọn dẹp bộ nhớ khi tắt VM
+        // Dọn dẹp bộ nhớ khi tắt VM (mọi proto bị unlink về Interpreter)
         void shutdown();
 
         /**
-         * @brief Compile bytecode thành mã máy
-         * * @param bytecode Pointer đến mảng bytecode gốc
-         * @param length Độ dài
+         * @brief Compile chunk của proto thành mã máy và cài vào Code Cache
+         * @param proto Proto sở hữu mã (được unlink khi mã bị evict)
          * @return JitFunc Con trỏ hàm mã máy (hoặc nullptr nếu lỗi/từ chối compile)
          */
-        JitFunc compile(const uint8_t* bytecode, size_t length);
+        JitFunc compile(ObjFunctionProto* proto);
+
+        /**
+         * @brief Tier-up khi proto chạm ngưỡng. ENABLE_BACKGROUND_COMPILE: chụp bytecode/feedback,
+         * đẩy vào CompileQueue và trả về nullptr ngay (Interpreter chạy tiếp, mã được cài ở
+         * install_ready()). Ngược lại compile đồng bộ như compile().
+         */
+        JitFunc request_compile(ObjFunctionProto* proto);
+
+        // Safepoint (đầu lời gọi / nhảy ngược): cài mã của các job đã compile xong
+        bool has_ready() const noexcept { return queue_.has_ready(); }
+        void install_ready();
+
+        // Mã relocatable cho AOT image (không inline, không seed IC, chưa cài). nullopt nếu bị từ chối.
+        std::optional<NativeCode> compile_relocatable(ObjFunctionProto* proto);
+
+        // Vá relocation theo process hiện tại rồi cài vào Code Cache như mã vừa JIT
+        JitFunc install_native(ObjFunctionProto* proto, const NativeCode& native);
+
+        // Điểm vào OSR tại loop header bc_offset của mã đã cài (nullptr nếu không có)
+        JitFunc osr_entry(const ObjFunctionProto* proto, size_t bc_offset) const noexcept;
+
+        // Gỡ mã máy và job compile nền của proto (gọi khi proto bị GC thu hồi)
+        void release(ObjFunctionProto* proto) noexcept {
+            queue_.cancel(proto);
+            cache_.release(proto);
+        }
+
+        const CodeCache& code_cache() const noexcept { return cache_; }
 
     private:
-        JitCompiler() = default;
+        JitCompiler() : queue_([this](CompileJob& job) { compile_job(job); }) {}
         ~JitCompiler() = default;
 
+        CodeCache cache_;
+        CompileQueue queue_; // Hủy trước cache_: worker dừng trước khi Code Cache biến mất
+
+        std::optional<NativeCode> generate(const uint8_t* bytecode, size_t length, bool speculate,
+                                           const std::vector<uint32_t>& failed_sites,
+                                           const InlinedCode* inlined, bool relocatable);
+        std::optional<NativeCode> generate_baseline(const uint8_t* bytecode, size_t length);
+
+        // Chạy trên thread compile: chỉ đọc bản chụp trong job
+        void compile_job(CompileJob& job);
+        std::unique_ptr<CompileJob> snapshot(ObjFunctionProto* proto);
+
         JitCompiler(const JitCompiler&) = delete;
         JitCompiler& operator=(const JitCompiler&) = delete;
     };
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 namespace meow::jit {
 
@@ -15,10 +16,24 @@ namespace meow::jit {
     // Để 0 hoặc 1 nếu muốn JIT luôn chạy (Eager JIT) để test.
     static constexpr size_t JIT_THRESHOLD = 100;
 
-    // Kích thước bộ đệm chứa mã máy (Executable Memory)
+    // Số lần nhảy ngược (loop back-edge) trong một proto trước khi OSR vào mã máy.
+    // Dành cho hàm chỉ được gọi 1 lần nhưng chạy vòng lặp rất dài (main, batch job).
+    static constexpr uint32_t JIT_OSR_THRESHOLD = 1000;
+
+    // Kích thước mỗi region chứa mã máy (Executable Memory)
     // 1MB là đủ cho rất nhiều code meow nhỏ.
     static constexpr size_t JIT_CACHE_SIZE = 1024 * 1024; 
 
+    // Tổng dung lượng tối đa của Code Cache. Vượt ngưỡng -> evict region cũ nhất.
+    static constexpr size_t JIT_CACHE_MAX_SIZE = 64 * 1024 * 1024;
+
+    // Compile trên thread nền: Interpreter chạy tiếp trong lúc sinh mã, mã được cài ở safepoint
+    // (lời gọi hàm / nhảy ngược kế tiếp). Tắt -> compile đồng bộ ngay khi chạm ngưỡng.
+    static constexpr bool ENABLE_BACKGROUND_COMPILE = true;
+
+    // Số job tối đa chờ compile, đầy thì proto ở lại Interpreter
+    static constexpr size_t JIT_COMPILE_QUEUE_MAX = 64;
+
     // --- Optimization Flags ---
 
     // Bật tính năng Inline Caching (Tăng tốc truy cập thuộc tính)
@@ -27,12 +42,38 @@ namespace meow::jit {
     // Bật tính năng Guarded Arithmetic (Cộng trừ nhanh trên số nguyên)
     static constexpr bool ENABLE_INT_FAST_PATH = true;
 
+    // Tier speculative: số học/so sánh giả định int, guard fail -> deopt về Interpreter.
+    // Quá JIT_MAX_DEOPTS lần thì proto chỉ được compile bản generic (slow path gọi runtime).
+    static constexpr bool ENABLE_SPECULATION = true;
+    static constexpr uint32_t JIT_MAX_DEOPTS = 4;
+
+    // Vòng lặp đếm trên array (tier speculative): check kiểu/biên của GET_INDEX/SET_INDEX
+    // gom về một guard ở loop header, xem x64/bounds_check_elimination.h
+    static constexpr bool ENABLE_BOUNDS_CHECK_ELIMINATION = true;
+
+    // Inline hàm nhỏ tại CALL mà CallIC chỉ từng thấy một proto (frame chỉ được dựng khi deopt).
+    // Ngân sách tính theo số lệnh: IC của GET_PROP/SET_PROP làm kích thước byte phình to.
+    static constexpr bool ENABLE_INLINING = true;
+    static constexpr size_t JIT_INLINE_MAX_INSNS = 32;
+
+    // Baseline tier cho proto mà template JIT từ chối: ghép lời gọi tới handler của Interpreter
+    // (phủ mọi opcode, bỏ dispatch), xem x64/baseline_generator.h
+    static constexpr bool ENABLE_BASELINE_JIT = true;
+
     // --- Debugging ---
 
     // In ra mã Assembly (Hex) sau khi compile
-    static constexpr bool JIT_DEBUG_LOG = true;
+    // Tắt mặc định vì JIT chạy trực tiếp trong đường gọi hàm của Interpreter
+    static constexpr bool JIT_DEBUG_LOG = false;
 
     // In ra thông tin khi Deoptimization xảy ra (fallback về Interpreter)
-    static constexpr bool LOG_DEOPT = true;
+    // Tắt mặc định để không lẫn vào output của chương trình
+    static constexpr bool LOG_DEOPT = false;
+
+    // Symbol cho mã JIT (CodeRegistry), bật lúc chạy bằng biến môi trường khác rỗng và khác "0":
+    // MEOW_JIT_PERF_MAP -> ghi /tmp/perf-<pid>.map cho `perf report`
+    // MEOW_JIT_GDB      -> đăng ký qua GDB JIT interface (symbol + line table theo bytecode offset)
+    static constexpr const char* JIT_PERF_MAP_ENV = "MEOW_JIT_PERF_MAP";
+    static constexpr const char* JIT_GDB_ENV = "MEOW_JIT_GDB";
 
 } // namespace meow::jit
\ No newline at end of file
@@ -0,0 +1,65 @@
+/**
+ * @file relocation.h
+ * @brief Ô imm64 trong mã máy chứa địa chỉ chỉ đúng trong process hiện tại (AOT image vá lại lúc nạp)
+ */
+
+#pragma once
+
+#include "code_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace meow::jit {
+
+    // Hàm runtime mà mã JIT gọi qua địa chỉ tuyệt đối
+    enum class RuntimeStub : uint32_t {
+        BINARY_OP, COMPARE, TRUTHY, GET_PROP_MISS, SET_PROP_MISS, WRITE_BARRIER,
+        GET_INDEX_MISS, SET_INDEX_MISS,
+        COUNT
+    };
+
+    // Định nghĩa ở runtime/runtime_stubs.cpp
+    uint64_t runtime_stub_address(RuntimeStub stub) noexcept;
+
+    // Handler của opcode (bản không OSR) mà mã baseline gọi. Định nghĩa ở runtime/stencils.cpp
+    uint64_t handler_address(uint32_t op) noexcept;
+
+    enum class RelocKind : uint8_t {
+        RUNTIME_STUB, // arg = RuntimeStub
+        BYTECODE,     // arg = offset trong chunk của proto (InlineCache nằm trong bytecode)
+        HANDLER,      // arg = OpCode
+    };
+
+    struct Relocation {
+        uint32_t pos;    // Vị trí imm64 tính từ đầu mã máy
+        RelocKind kind;
+        uint32_t arg;
+        int32_t site = -1; // BYTECODE: -1 = chunk của proto, còn lại: chunk callee của InlinedCode::sites[site]
+    };
+
+    // Mã máy độc lập địa chỉ nạp của một proto (chưa cài vào CodeCache)
+    struct NativeCode {
+        std::vector<uint8_t> code;
+        std::vector<OsrEntry> osr_entries;
+        std::vector<Relocation> relocs;
+        std::vector<LineEntry> lines;
+    };
+
+    // Ghi địa chỉ thật vào các ô imm64 (bytecode: chunk của proto đích, site_code: chunk của từng callee inline)
+    inline void apply_relocations(uint8_t* code, const std::vector<Relocation>& relocs, const uint8_t* bytecode,
+                                  const std::vector<const uint8_t*>& site_code = {}) {
+        for (const Relocation& r : relocs) {
+            const uint8_t* base = r.site < 0 ? bytecode : site_code[r.site];
+            uint64_t value;
+            switch (r.kind) {
+                case RelocKind::RUNTIME_STUB: value = runtime_stub_address(static_cast<RuntimeStub>(r.arg)); break;
+                case RelocKind::HANDLER:      value = handler_address(r.arg); break;
+                default:                      value = reinterpret_cast<uint64_t>(base + r.arg); break;
+            }
+            std::memcpy(code + r.pos, &value, 8);
+        }
+    }
+
+} // namespace meow::jit
@@ -0,0 +1,22 @@
+#include "runtime/deopt.h"
+#include "jit_compiler.h"
+#include "jit_config.h"
+#include "meow/core/function.h"
+
+#include <iostream>
+
+namespace meow::jit {
+
+void deoptimize(ObjFunctionProto* proto, size_t bc_offset) {
+    proto->record_deopt(static_cast<uint32_t>(bc_offset));
+
+    if (LOG_DEOPT) {
+        std::cerr << "[JIT] Deopt at bytecode offset " << bc_offset << " (deopt #" << proto->get_deopt_count() << ")" << std::endl;
+    }
+
+    // Frame JIT đã thoát hoàn toàn (mã máy là leaf) -> gỡ mã an toàn
+    JitCompiler::instance().release(proto);
+    proto->reset_hotness();
+}
+
+} // namespace meow::jit
@@ -0,0 +1,23 @@
+/**
+ * @file deopt.h
+ * @brief Deoptimization: mã speculative trả quyền về Interpreter
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace meow { class ObjFunctionProto; }
+
+namespace meow::jit {
+
+    /**
+     * @brief Gọi sau khi mã JIT của proto thoát vì guard fail.
+     * Mã máy đã ghi mọi register đang sống về VM stack trước khi thoát,
+     * CallFrame vẫn là frame của proto nên Interpreter chỉ cần chạy tiếp từ bc_offset.
+     * Ở đây ghi nhận site bị fail, gỡ mã cũ và cho proto đếm hotness lại để
+     * lần compile sau không speculate ở site đó nữa.
+     */
+    void deoptimize(ObjFunctionProto* proto, size_t bc_offset);
+
+} // namespace meow::jit
@@ -1,98 +1,205 @@
 #include "meow/value.h"
+#include "meow/cast.h"
 #include "meow/bytecode/op_codes.h"
-#include <iostream>
-#include <cmath>
+#include "meow/memory/memory_manager.h"
+#include "meow/core/objects.h"
+#include "runtime/operator_dispatcher.h"
+#include "vm/handlers/inline_cache.h"
+#include "relocation.h"
 
 using namespace meow;
 
 namespace meow::jit::runtime {
 
+// Slow path của mã JIT: đi chung đường với Interpreter (OperatorDispatcher)
+// để kết quả giống hệt nhau (float, string concat, so sánh object...).
+// `op` luôn là opcode gốc (ADD, LT...), CodeGenerator đã bỏ hậu tố _B.
+
 extern "C" void binary_op_generic(int op, uint64_t v1_bits, uint64_t v2_bits, uint64_t* dst) {
     Value v1 = Value::from_raw(v1_bits);
     Value v2 = Value::from_raw(v2_bits);
-    Value result;
+    OpCode opcode = static_cast<OpCode>(op);
+
+    Value result = OperatorDispatcher::find(opcode, v1, v2)(MemoryManager::get_current(), v1, v2);
+
+    // Ghi kết quả (Raw bits) vào địa chỉ đích
+    *dst = result.raw();
+}
 
+extern "C" void compare_generic(int op, uint64_t v1_bits, uint64_t v2_bits, uint64_t* dst) {
+    Value v1 = Value::from_raw(v1_bits);
+    Value v2 = Value::from_raw(v2_bits);
     OpCode opcode = static_cast<OpCode>(op);
 
-    if (opcode == OpCode::ADD || opcode == OpCode::ADD_B) {
-        if (v1.is_int() && v2.is_int()) {
-            result = Value(v1.as_int() + v2.as_int());
-        } else if (v1.is_float() || v2.is_float()) {
-            double d1 = v1.is_int() ? (double)v1.as_int() : v1.as_float();
-            double d2 = v2.is_int() ? (double)v2.as_int() : v2.as_float();
-            result = Value(d1 + d2);
-        } else {
-            result = Value(); 
+    Value res = OperatorDispatcher::find(opcode, v1, v2)(MemoryManager::get_current(), v1, v2);
+
+    // Kết quả trả về là Value(bool)
+    *dst = Value(meow::to_bool(res)).raw();
+}
+
+extern "C" uint64_t truthy_generic(uint64_t v_bits) {
+    return meow::to_bool(Value::from_raw(v_bits)) ? 1 : 0;
+}
+
+// --- Inline Cache miss handlers ---
+// Mã máy chỉ tự xử lý instance có shape đã seed. Các trường hợp khác đi qua đây,
+// cập nhật lại IC trong bytecode giống Interpreter (lần compile sau seed được shape mới).
+// Trả về 0 nếu cần Interpreter (lỗi, method của primitive cần ModuleManager...):
+// mã máy thoát về Interpreter tại chính lệnh đó.
+
+extern "C" uint64_t get_prop_miss(uint64_t obj_bits, uint64_t name_bits, void* ic_ptr, uint64_t* dst) {
+    using namespace meow::handlers;
+    Value obj = Value::from_raw(obj_bits);
+    string_t name = Value::from_raw(name_bits).as_string();
+    auto* ic = static_cast<InlineCache*>(ic_ptr);
+    MemoryManager* heap = MemoryManager::get_current();
+
+    static string_t str_length = nullptr;
+    if (!str_length) [[unlikely]] str_length = heap->new_string("length");
+
+    if (obj.is_instance()) {
+        instance_t inst = obj.as_instance();
+        Shape* shape = inst->get_shape();
+        int offset = shape->get_offset(name);
+        if (offset != -1) {
+            update_inline_cache(ic, shape, nullptr, static_cast<uint32_t>(offset));
+            *dst = inst->get_field_at(offset).raw();
+            return 1;
         }
-    } 
-    else if (opcode == OpCode::SUB || opcode == OpCode::SUB_B) {
-        if (v1.is_int() && v2.is_int()) {
-            result = Value(v1.as_int() - v2.as_int());
-        } else {
-            double d1 = v1.is_int() ? (double)v1.as_int() : v1.as_float();
-            double d2 = v2.is_int() ? (double)v2.as_int() : v2.as_float();
-            result = Value(d1 - d2);
+        for (class_t k = inst->get_class(); k; k = k->get_super()) {
+            if (k->has_method(name)) {
+                *dst = Value(heap->new_bound_method(inst, k->get_method(name).as_function())).raw();
+                return 1;
+            }
         }
+        return 0;
+    }
+    if (name == str_length) {
+        if (obj.is_array())  { *dst = Value(static_cast<int64_t>(obj.as_array()->size())).raw(); return 1; }
+        if (obj.is_string()) { *dst = Value(static_cast<int64_t>(obj.as_string()->size())).raw(); return 1; }
+    }
+    if (obj.is_hash_table()) {
+        Value out;
+        if (!obj.as_hash_table()->get(name, &out)) return 0; // Có thể là method của module "object"
+        *dst = out.raw();
+        return 1;
+    }
+    if (obj.is_module() && obj.as_module()->has_export(name)) {
+        *dst = obj.as_module()->get_export(name).raw();
+        return 1;
+    }
+    if (obj.is_class() && obj.as_class()->has_method(name)) {
+        *dst = obj.as_class()->get_method(name).raw();
+        return 1;
     }
-    else if (opcode == OpCode::MUL || opcode == OpCode::MUL_B) {
-        if (v1.is_int() && v2.is_int()) {
-            result = Value(v1.as_int() * v2.as_int());
+    return 0;
+}
+
+extern "C" uint64_t set_prop_miss(uint64_t obj_bits, uint64_t name_bits, uint64_t val_bits, void* ic_ptr) {
+    using namespace meow::handlers;
+    Value obj = Value::from_raw(obj_bits);
+    Value val = Value::from_raw(val_bits);
+    string_t name = Value::from_raw(name_bits).as_string();
+    auto* ic = static_cast<InlineCache*>(ic_ptr);
+    MemoryManager* heap = MemoryManager::get_current();
+
+    if (obj.is_instance()) {
+        instance_t inst = obj.as_instance();
+        Shape* shape = inst->get_shape();
+        int offset = shape->get_offset(name);
+
+        if (offset != -1) {
+            update_inline_cache(ic, shape, nullptr, static_cast<uint32_t>(offset));
+            inst->set_field_at(offset, val);
         } else {
-            double d1 = v1.is_int() ? (double)v1.as_int() : v1.as_float();
-            double d2 = v2.is_int() ? (double)v2.as_int() : v2.as_float();
-            result = Value(d1 * d2);
+            Shape* next_shape = shape->get_transition(name);
+            if (!next_shape) next_shape = shape->add_transition(name, heap);
+
+            update_inline_cache(ic, shape, next_shape, static_cast<uint32_t>(inst->get_field_count()));
+            inst->set_shape(next_shape);
+            inst->add_field(val);
+            heap->write_barrier(inst, Value(reinterpret_cast<object_t>(next_shape)));
         }
+        heap->write_barrier(inst, val);
+        return 1;
+    }
+    if (obj.is_hash_table()) {
+        obj.as_hash_table()->set(name, val);
+        heap->write_barrier(obj.as_object(), val);
+        return 1;
     }
+    return 0;
+}
 
-    // 3. Ghi kết quả (Raw bits) vào địa chỉ đích
-    *dst = result.raw();
+// --- GET_INDEX / SET_INDEX ---
+// Mã máy chỉ tự xử lý array với index int trong [0, size). Còn lại (ngoài biên, hash table)
+// đi qua đây giống Interpreter. Trả về 0 nếu cần Interpreter (lỗi kiểu, string, instance...).
+
+extern "C" uint64_t get_index_miss(uint64_t obj_bits, uint64_t key_bits, uint64_t* dst) {
+    Value obj = Value::from_raw(obj_bits);
+    Value key = Value::from_raw(key_bits);
+
+    if (obj.is_array()) {
+        if (!key.is_int()) return 0;
+        array_t arr = obj.as_array();
+        int64_t idx = key.as_int();
+        *dst = (idx < 0 || static_cast<size_t>(idx) >= arr->size()) ? Value(null_t{}).raw() : arr->get(idx).raw();
+        return 1;
+    }
+    if (obj.is_hash_table()) {
+        string_t k = key.is_string() ? key.as_string() : MemoryManager::get_current()->new_string(meow::to_string(key));
+        Value out;
+        *dst = obj.as_hash_table()->get(k, &out) ? out.raw() : Value(null_t{}).raw();
+        return 1;
+    }
+    return 0;
 }
 
-extern "C" void compare_generic(int op, uint64_t v1_bits, uint64_t v2_bits, uint64_t* dst) {
-    Value v1 = Value::from_raw(v1_bits);
-    Value v2 = Value::from_raw(v2_bits);
-    bool res = false;
-    OpCode opcode = static_cast<OpCode>(op);
+extern "C" uint64_t set_index_miss(uint64_t obj_bits, uint64_t key_bits, uint64_t val_bits) {
+    Value obj = Value::from_raw(obj_bits);
+    Value key = Value::from_raw(key_bits);
+    Value val = Value::from_raw(val_bits);
+    MemoryManager* heap = MemoryManager::get_current();
 
-    // Logic so sánh tổng quát
-    // Lưu ý: Cần implement operator<, operator== chuẩn cho class Value
-    // Ở đây demo logic cơ bản cho số:
-
-    double d1 = v1.is_int() ? (double)v1.as_int() : (v1.is_float() ? v1.as_float() : 0.0);
-    double d2 = v2.is_int() ? (double)v2.as_int() : (v2.is_float() ? v2.as_float() : 0.0);
-    
-    // Nếu không phải số, so sánh raw bits (đối với pointer/bool/null)
-    bool is_numeric = (v1.is_int() || v1.is_float()) && (v2.is_int() || v2.is_float());
-
-    switch (opcode) {
-        case OpCode::EQ: case OpCode::EQ_B:
-            res = (v1 == v2); // Value::operator==
-            break;
-        case OpCode::NEQ: case OpCode::NEQ_B:
-            res = (v1 != v2);
-            break;
-        case OpCode::LT: case OpCode::LT_B:
-            if (is_numeric) res = d1 < d2;
-            else res = false; // TODO: String comparison
-            break;
-        case OpCode::LE: case OpCode::LE_B:
-            if (is_numeric) res = d1 <= d2;
-            else res = false;
-            break;
-        case OpCode::GT: case OpCode::GT_B:
-            if (is_numeric) res = d1 > d2;
-            else res = false;
-            break;
-        case OpCode::GE: case OpCode::GE_B:
-            if (is_numeric) res = d1 >= d2;
-            else res = false;
-            break;
-        default: break;
+    if (obj.is_array()) {
+        if (!key.is_int() || key.as_int() < 0) return 0;
+        array_t arr = obj.as_array();
+        size_t idx = static_cast<size_t>(key.as_int());
+        if (idx >= arr->size()) arr->resize(idx + 1);
+        arr->set(idx, val);
+        heap->write_barrier(obj.as_object(), val);
+        return 1;
+    }
+    if (obj.is_hash_table()) {
+        string_t k = key.is_string() ? key.as_string() : heap->new_string(meow::to_string(key));
+        obj.as_hash_table()->set(k, val);
+        heap->write_barrier(obj.as_object(), val);
+        return 1;
     }
+    return 0;
+}
 
-    // Kết quả trả về là Value(bool)
-    Value result_val(res);
-    *dst = result_val.raw();
+// Gọi từ fast path của SET_PROP khi giá trị ghi vào là object
+extern "C" void write_barrier_stub(MeowObject* owner, uint64_t val_bits) {
+    MemoryManager::get_current()->write_barrier(owner, Value::from_raw(val_bits));
+}
+
+} // namespace meow::jit::runtime
+
+namespace meow::jit {
+
+uint64_t runtime_stub_address(RuntimeStub stub) noexcept {
+    switch (stub) {
+        case RuntimeStub::BINARY_OP:      return reinterpret_cast<uint64_t>(&runtime::binary_op_generic);
+        case RuntimeStub::COMPARE:        return reinterpret_cast<uint64_t>(&runtime::compare_generic);
+        case RuntimeStub::TRUTHY:         return reinterpret_cast<uint64_t>(&runtime::truthy_generic);
+        case RuntimeStub::GET_PROP_MISS:  return reinterpret_cast<uint64_t>(&runtime::get_prop_miss);
+        case RuntimeStub::SET_PROP_MISS:  return reinterpret_cast<uint64_t>(&runtime::set_prop_miss);
+        case RuntimeStub::WRITE_BARRIER:  return reinterpret_cast<uint64_t>(&runtime::write_barrier_stub);
+        case RuntimeStub::GET_INDEX_MISS: return reinterpret_cast<uint64_t>(&runtime::get_index_miss);
+        case RuntimeStub::SET_INDEX_MISS: return reinterpret_cast<uint64_t>(&runtime::set_index_miss);
+        default:                          return 0;
+    }
 }
 
-} // namespace meow::jit::runtime
\ No newline at end of file
+} // namespace meow::jit
@@ -0,0 +1,49 @@
+// Handler của Interpreter dùng làm stencil cho baseline JIT (x64/baseline_generator.h).
+// Bản dịch riêng với MEOW_JIT_STENCILS: nhảy ngược không OSR (vòng lặp đã nằm trong mã máy,
+// OSR lồng sẽ chạy cùng một frame ở hai nơi). Handler là `inline static` nên không đụng bản của Interpreter.
+#define MEOW_JIT_STENCILS 1
+
+#include "vm/interpreter.h"
+#include "vm/handlers/data_ops.h"
+#include "vm/handlers/math_ops.h"
+#include "vm/handlers/flow_ops.h"
+#include "vm/handlers/memory_ops.h"
+#include "vm/handlers/oop_ops.h"
+#include "vm/handlers/module_ops.h"
+#include "vm/handlers/exception_ops.h"
+#include "vm/handlers/op_list.h"
+#include "relocation.h"
+
+namespace meow::jit {
+
+namespace {
+    using OpImpl = const uint8_t* (*)(const uint8_t*, Value*, const Value*, VMState*);
+
+    struct StencilTable {
+        OpImpl impls[256];
+
+        StencilTable() {
+            for (auto& impl : impls) impl = handlers::impl_UNIMPL;
+
+            #define reg(NAME) impls[static_cast<size_t>(OpCode::NAME)] = handlers::impl_##NAME;
+
+            // Cùng danh sách với TableInitializer (vm/handlers/op_list.h).
+            // Baseline quy opcode về generic_op() nên không gọi tới bản quickened, chúng chỉ cho đủ bảng.
+            // Superinstruction không có stencil: generic_op() trả về lệnh đầu, các lệnh sau là stencil riêng
+            MEOW_HANDLER_OPS(reg)
+
+            #undef reg
+        }
+    };
+
+    const StencilTable& stencils() {
+        static const StencilTable table;
+        return table;
+    }
+} // namespace
+
+uint64_t handler_address(uint32_t op) noexcept {
+    return reinterpret_cast<uint64_t>(stencils().impls[op & 0xFF]);
+}
+
+} // namespace meow::jit
@@ -0,0 +1,333 @@
+/**
+ * @file test_analysis.cpp
+ * @brief Test CFG/dominator/loop/liveness trên file .meowc thật (masm biên dịch từ tests/*.meowb)
+ *        và vài regression chạy hẳn trên VM
+ */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <print>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "analysis/bytecode_analysis.h"
+#include "meow/masm/assembler.h"
+#include "meow/masm/lexer.h"
+#include "meow/masm/utils.h"
+#include <meow/machine.h>
+
+using namespace meow;
+using namespace meow::jit::analysis;
+
+static int g_failures = 0;
+
+#define EXPECT(cond) \
+    do { if (!(cond)) { std::println("  FAIL {}:{}: {}", __FILE__, __LINE__, #cond); ++g_failures; } } while (0)
+
+// --- Đọc .meowc (chỉ lấy phần cần cho analysis) ---
+
+struct ProtoCode {
+    std::string name;
+    uint32_t num_regs = 0;
+    std::vector<uint8_t> bytecode;
+};
+
+class MeowcReader {
+public:
+    explicit MeowcReader(std::vector<uint8_t> data) : data_(std::move(data)) {}
+
+    bool read(std::vector<ProtoCode>& protos) {
+        if (u32() != 0x4D454F57) return false;
+        uint32_t version = u32();
+        u32(); // main index
+        uint32_t count = u32();
+        for (uint32_t i = 0; i < count && ok_; ++i) {
+            ProtoCode p;
+            p.num_regs = u32();
+            u32(); // num_upvalues
+            uint8_t flags = (version >= 2) ? u8() : 0;
+            uint32_t const_count = u32();
+            u32(); // const_count + 1 (kể cả tên)
+            for (uint32_t c = 0; c < const_count; ++c) constant();
+            u8(); p.name = str();
+            uint32_t upvals = u32();
+            for (uint32_t u = 0; u < upvals; ++u) { u8(); u32(); }
+            uint32_t len = u32();
+            if (!need(len)) break;
+            p.bytecode.assign(data_.begin() + pos_, data_.begin() + pos_ + len);
+            pos_ += len;
+            if (flags & 1) { // HAS_DEBUG_INFO
+                uint32_t files = u32();
+                for (uint32_t f = 0; f < files; ++f) str();
+                uint32_t lines = u32();
+                if (need(lines * 16)) pos_ += lines * 16;
+            }
+            protos.push_back(std::move(p));
+        }
+        return ok_;
+    }
+
+private:
+    std::vector<uint8_t> data_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+
+    bool need(size_t n) { if (pos_ + n > data_.size()) ok_ = false; return ok_; }
+    uint8_t u8() { return need(1) ? data_[pos_++] : 0; }
+    uint32_t u32() { uint32_t v = 0; if (need(4)) { std::memcpy(&v, &data_[pos_], 4); pos_ += 4; } return v; }
+    std::string str() {
+        uint32_t len = u32();
+        if (!need(len)) return {};
+        std::string s(data_.begin() + pos_, data_.begin() + pos_ + len);
+        pos_ += len;
+        return s;
+    }
+    void constant() {
+        switch (u8()) {
+            case 1: case 2: if (need(8)) pos_ += 8; break;
+            case 3: str(); break;
+            case 4: u32(); break;
+            default: break;
+        }
+    }
+};
+
+static std::vector<ProtoCode> compile_meowc(const std::string& name) {
+    const std::string src_path = std::string(MEOW_TEST_DIR) + "/" + name + ".meowb";
+    const std::string out_path = name + ".meowc";
+
+    std::ifstream in(src_path, std::ios::binary);
+    std::stringstream ss; ss << in.rdbuf();
+    std::string source = ss.str();
+    if (source.empty()) { std::println("  cannot read {}", src_path); ++g_failures; return {}; }
+
+    masm::Lexer lexer(source);
+    masm::Assembler assembler(lexer);
+    if (masm::Status s = assembler.assemble(); s.is_err()) {
+        masm::report_error(s, "Assembler");
+        ++g_failures;
+        return {};
+    }
+    {
+        std::ofstream out(out_path, std::ios::binary);
+        assembler.write_binary(out);
+    }
+
+    std::ifstream bin(out_path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(bin)), std::istreambuf_iterator<char>());
+    std::vector<ProtoCode> protos;
+    MeowcReader reader(std::move(data));
+    EXPECT(reader.read(protos));
+    return protos;
+}
+
+static const ProtoCode* find_proto(const std::vector<ProtoCode>& protos, std::string_view name) {
+    for (const auto& p : protos) if (p.name == name) return &p;
+    return nullptr;
+}
+
+static size_t index_of_op(const DecodedCode& code, OpCode op, size_t nth = 0) {
+    for (size_t i = 0; i < code.insns.size(); ++i) {
+        if (code.insns[i].op == op && nth-- == 0) return i;
+    }
+    return NO_INDEX;
+}
+
+// --- Bất biến chung cho mọi prototype ---
+
+static void check_invariants(const ProtoCode& p) {
+    DecodedCode code = decode(p.bytecode.data(), p.bytecode.size());
+    EXPECT(code.valid);
+    EXPECT(code.num_regs <= p.num_regs);
+
+    ControlFlowGraph cfg(code.insns);
+    DominatorTree dom(cfg);
+    const auto& blocks = cfg.blocks();
+
+    EXPECT(!blocks.empty() && blocks[0].first == 0);
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        for (size_t i = blocks[b].first; i <= blocks[b].last; ++i) EXPECT(cfg.block_of(i) == b);
+        if (!cfg.is_reachable(b)) continue;
+        EXPECT(dom.dominates(0, b));
+        for (size_t s : blocks[b].succs) {
+            const auto& preds = blocks[s].preds;
+            EXPECT(std::find(preds.begin(), preds.end(), b) != preds.end());
+        }
+    }
+
+    for (const LoopInfo& loop : find_loops(cfg, dom)) {
+        for (size_t latch : loop.latches) EXPECT(dom.dominates(loop.header, latch));
+        EXPECT(loop.start_ip <= loop.end_ip);
+    }
+}
+
+// --- Test cụ thể ---
+
+static void test_call_bench() {
+    std::println("call_bench");
+    auto protos = compile_meowc("call_bench");
+    for (const auto& p : protos) check_invariants(p);
+
+    // main: một loop, header là GE tại loop_start
+    if (const ProtoCode* main = find_proto(protos, "main")) {
+        DecodedCode code = decode(main->bytecode.data(), main->bytecode.size());
+        ControlFlowGraph cfg(code.insns);
+        DominatorTree dom(cfg);
+        auto loops = find_loops(cfg, dom);
+
+        const size_t ge = index_of_op(code, OpCode::GE);
+        EXPECT(loops.size() == 1);
+        if (loops.size() == 1) {
+            EXPECT(cfg.blocks()[loops[0].header].first == ge);
+            EXPECT(loops[0].start_ip == code.insns[ge].offset);
+            EXPECT(loops[0].depth == 1);
+            EXPECT(loops[0].latches.size() == 1);
+            // Block sau loop (GET_GLOBAL; CALL_VOID; HALT) không thuộc thân loop
+            const size_t exit_block = cfg.block_of(index_of_op(code, OpCode::CALL_VOID));
+            EXPECT(!std::binary_search(loops[0].blocks.begin(), loops[0].blocks.end(), exit_block));
+            EXPECT(dom.dominates(loops[0].header, exit_block));
+        }
+
+        // Tại header: r4 (i), r5 (limit) sống; r3 sống vì CALL_VOID sau loop đọc dải [r3, r3+1)
+        Liveness live(code.insns, code.num_regs);
+        EXPECT(live.is_live_in(ge, 4));
+        EXPECT(live.is_live_in(ge, 5));
+        EXPECT(live.is_live_in(ge, 3));
+        EXPECT(!live.is_live_in(ge, 0));
+        EXPECT(!live.is_live_in(ge, 1));
+        EXPECT(!live.is_live_in(ge, 2));
+
+        // CALL 3, 0, 1, 2: đọc callee r0 và tham số r1, r2; ghi r3
+        const size_t call = index_of_op(code, OpCode::CALL);
+        EXPECT(code.insns[call].def == 3);
+        EXPECT(live.is_live_in(call, 0) && live.is_live_in(call, 1) && live.is_live_in(call, 2));
+        // r4, r5 (biến loop) sống sau lệnh gọi -> giữ CALL chép tham số
+        EXPECT(static_cast<OpCode>(main->bytecode[code.insns[call].offset]) == OpCode::CALL);
+
+        // LOAD_INT 0, 1; ADD 4, 4, 0 -> ADD_I_B 4, 4, #1 (r0 chết sau ADD)
+        EXPECT(index_of_op(code, OpCode::ADD_I_B) != NO_INDEX);
+        EXPECT(index_of_op(code, OpCode::ADD) == NO_INDEX);
+    } else {
+        EXPECT(!"main not found");
+    }
+
+    // add_recursive: không có loop, nhánh "stop" chỉ bị entry dominate
+    if (const ProtoCode* fn = find_proto(protos, "add_recursive")) {
+        DecodedCode code = decode(fn->bytecode.data(), fn->bytecode.size());
+        ControlFlowGraph cfg(code.insns);
+        DominatorTree dom(cfg);
+        EXPECT(find_loops(cfg, dom).empty());
+        EXPECT(cfg.blocks().size() == 3);
+
+        const size_t stop = cfg.block_of(index_of_op(code, OpCode::RETURN, 1));
+        const size_t fall = cfg.block_of(index_of_op(code, OpCode::RETURN, 0));
+        EXPECT(dom.idom(stop) == 0);
+        EXPECT(!dom.dominates(fall, stop));
+
+        Liveness live(code.insns, code.num_regs);
+        EXPECT(live.is_live_in(0, 0) && live.is_live_in(0, 1));
+        EXPECT(!live.is_live_in(0, 2) && !live.is_live_in(0, 3));
+
+        // CALL 0, 0, 2, 2: r2, r3 là register cao nhất và chết sau lệnh gọi -> masm chọn register window
+        const size_t call = index_of_op(code, OpCode::CALL);
+        EXPECT(static_cast<OpCode>(fn->bytecode[code.insns[call].offset]) == OpCode::CALL_WINDOW);
+
+        // LOAD_INT; LT; JUMP_IF_TRUE -> JUMP_IF_LT_I_B 0, #1, stop và LOAD_INT; SUB -> SUB_I_B 2, 0, #1
+        EXPECT(code.insns[0].op == OpCode::JUMP_IF_LT_I_B);
+        EXPECT(index_of_op(code, OpCode::SUB_I_B) != NO_INDEX);
+    } else {
+        EXPECT(!"add_recursive not found");
+    }
+}
+
+static void test_tco() {
+    std::println("tco_test");
+    auto protos = compile_meowc("tco_test");
+    for (const auto& p : protos) check_invariants(p);
+
+    // TAIL_CALL thoát hàm -> RETURN 0 phía sau không đến được
+    if (const ProtoCode* fn = find_proto(protos, "add_recursive_tco")) {
+        DecodedCode code = decode(fn->bytecode.data(), fn->bytecode.size());
+        ControlFlowGraph cfg(code.insns);
+        const size_t dead = cfg.block_of(index_of_op(code, OpCode::RETURN, 0));
+        EXPECT(!cfg.is_reachable(dead));
+
+        // DEC 2 vừa đọc vừa ghi r2
+        Liveness live(code.insns, code.num_regs);
+        EXPECT(live.is_live_in(index_of_op(code, OpCode::DEC), 2));
+    } else {
+        EXPECT(!"add_recursive_tco not found");
+    }
+
+    // main: INC 4 giữ r4 sống qua back-edge
+    if (const ProtoCode* main = find_proto(protos, "main")) {
+        EXPECT(find_loops(main->bytecode.data(), main->bytecode.size()).size() == 1);
+        DecodedCode code = decode(main->bytecode.data(), main->bytecode.size());
+        Liveness live(code.insns, code.num_regs);
+        const size_t jump = index_of_op(code, OpCode::JUMP);
+        EXPECT(live.is_live_in(jump, 4) && live.is_live_in(jump, 5));
+    }
+}
+
+static void test_imm_fold() {
+    std::println("imm_fold");
+    auto protos = compile_meowc("imm_fold");
+    for (const auto& p : protos) check_invariants(p);
+
+    if (const ProtoCode* main = find_proto(protos, "main")) {
+        DecodedCode code = decode(main->bytecode.data(), main->bytecode.size());
+
+        // LOAD_INT 0, 1; ADD 2, 0, 1: hằng bên trái, r1 có thể là string -> không gập ("1abc" != "abc1")
+        const size_t add = index_of_op(code, OpCode::ADD);
+        EXPECT(add != NO_INDEX && add > 0);
+        if (add != NO_INDEX && add > 0) EXPECT(code.insns[add - 1].op == OpCode::LOAD_INT);
+
+        // LOAD_INT 0, 3; MUL 3, 0, 1: tương tự, 3 * s không được thành s * 3
+        EXPECT(index_of_op(code, OpCode::MUL) != NO_INDEX);
+        EXPECT(index_of_op(code, OpCode::MUL_I_B) == NO_INDEX && index_of_op(code, OpCode::MUL_I) == NO_INDEX);
+
+        // LOAD_INT 0, 1; ADD 2, 2, 0: hằng bên phải thì vẫn gập
+        EXPECT(index_of_op(code, OpCode::ADD_I_B) != NO_INDEX);
+    } else {
+        EXPECT(!"main not found");
+    }
+
+    // r0 là float: vẫn gập thành JUMP_IF_EQ_I_B, handler đưa float qua OperatorDispatcher (epsilon) như JUMP_IF_EQ
+    if (const ProtoCode* fn = find_proto(protos, "float_eq")) {
+        DecodedCode code = decode(fn->bytecode.data(), fn->bytecode.size());
+        EXPECT(index_of_op(code, OpCode::JUMP_IF_EQ_I_B) != NO_INDEX);
+        EXPECT(index_of_op(code, OpCode::JUMP_IF_EQ) == NO_INDEX);
+        EXPECT(index_of_op(code, OpCode::LOAD_FLOAT) != NO_INDEX);
+    } else {
+        EXPECT(!"float_eq not found");
+    }
+}
+
+// Comparator cấp phát trong array.sort: Minor GC ghim mảng đang sort (con trỏ thô trên native stack)
+// trong khi holder đã bị dời sang old. Minor GC sau phải vẫn thấy cạnh holder -> mảng
+static void test_gc_pinned_sort() {
+    std::println("gc_pinned_sort");
+    auto protos = compile_meowc("gc_pinned_sort");
+    if (protos.empty()) return;
+
+    Machine vm(".", "gc_pinned_sort.meowc", 0, nullptr);
+    vm.interpret();
+    EXPECT(!vm.has_error());
+}
+
+int main() {
+    masm::init_op_map();
+
+    test_call_bench();
+    test_tco();
+    test_imm_fold();
+    test_gc_pinned_sort();
+
+    if (g_failures) {
+        std::println("{} check(s) failed", g_failures);
+        return 1;
+    }
+    std::println("All analysis tests passed");
+    return 0;
+}
@@ -8,26 +8,24 @@ Assembler::Assembler(uint8_t* buffer, size_t capacity)
     : buffer_(buffer), capacity_(capacity), size_(0) {}
 
 void Assembler::emit(uint8_t b) {
-    // if (size_ >= capacity_) [[unlikely]] throw std::runtime_error("JIT Buffer Overflow");
-    if (size_ >= capacity_) [[unlikely]] std::abort();
+    if (size_ >= capacity_) [[unlikely]] { overflow_ = true; return; }
     buffer_[size_++] = b;
 }
 
 void Assembler::emit_u32(uint32_t v) {
-    // if (size_ + 4 > capacity_) [[unlikely]] throw std::runtime_error("JIT Buffer Overflow");
-    if (size_ + 4 > capacity_) [[unlikely]] std::abort();
+    if (size_ + 4 > capacity_) [[unlikely]] { overflow_ = true; return; }
     std::memcpy(buffer_ + size_, &v, 4);
     size_ += 4;
 }
 
 void Assembler::emit_u64(uint64_t v) {
-    // if (size_ + 8 > capacity_) [[unlikely]] throw std::runtime_error("JIT Buffer Overflow");
-    if (size_ + 8 > capacity_) [[unlikely]] std::abort();
+    if (size_ + 8 > capacity_) [[unlikely]] { overflow_ = true; return; }
     std::memcpy(buffer_ + size_, &v, 8);
     size_ += 8;
 }
 
 void Assembler::patch_u32(size_t offset, uint32_t value) {
+    if (offset + 4 > size_) [[unlikely]] return; // Chỉ xảy ra khi đã overflow
     std::memcpy(buffer_ + offset, &value, 4);
 }
 
@@ -79,6 +77,15 @@ void Assembler::mov(Reg dst, int64_t imm) {
     }
 }
 
+// MOV dst, imm64 không rút gọn: ô imm64 có thể được vá lại sau (AOT relocation)
+size_t Assembler::mov_imm64(Reg dst, uint64_t imm) {
+    emit_rex(true, false, false, dst >= 8);
+    emit(0xB8 | (dst & 7));
+    size_t pos = size_;
+    emit_u64(imm);
+    return pos;
+}
+
 // MOV dst, [base + disp]
 void Assembler::mov(Reg dst, Reg base, int32_t disp) {
     emit_rex(true, dst >= 8, false, base >= 8);
@@ -127,6 +134,23 @@ void Assembler::xor_(Reg dst, Reg src) { emit_alu(0x31, dst, src); }
 void Assembler::cmp(Reg dst, Reg src) { emit_alu(0x39, dst, src); }
 void Assembler::test(Reg dst, Reg src) { emit_rex(true, src >= 8, false, dst >= 8); emit(0x85); emit_modrm(3, src, dst); }
 
+// Mandatory prefix (66/F2) phải đứng trước REX
+void Assembler::emit_sse(uint8_t prefix, uint8_t opcode, int reg, int rm, bool w) {
+    emit(prefix);
+    emit_rex(w, reg >= 8, false, rm >= 8);
+    emit(0x0F); emit(opcode);
+    emit_modrm(3, reg, rm);
+}
+
+void Assembler::movq(Xmm dst, Reg src) { emit_sse(0x66, 0x6E, dst, src, true); }
+void Assembler::movq(Reg dst, Xmm src) { emit_sse(0x66, 0x7E, src, dst, true); }
+void Assembler::addsd(Xmm dst, Xmm src) { emit_sse(0xF2, 0x58, dst, src); }
+void Assembler::mulsd(Xmm dst, Xmm src) { emit_sse(0xF2, 0x59, dst, src); }
+void Assembler::subsd(Xmm dst, Xmm src) { emit_sse(0xF2, 0x5C, dst, src); }
+void Assembler::divsd(Xmm dst, Xmm src) { emit_sse(0xF2, 0x5E, dst, src); }
+void Assembler::ucomisd(Xmm a, Xmm b) { emit_sse(0x66, 0x2E, a, b); }
+void Assembler::cvtsi2sd(Xmm dst, Reg src) { emit_sse(0xF2, 0x2A, dst, src, true); }
+
 void Assembler::imul(Reg dst, Reg src) {
     emit_rex(true, dst >= 8, false, src >= 8);
     emit(0x0F); emit(0xAF);
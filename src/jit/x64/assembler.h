@@ -19,12 +19,14 @@ namespace meow::jit::x64 {
         // --- Buffer Management ---
         size_t cursor() const { return size_; }
         uint8_t* start_ptr() const { return buffer_; }
+        bool overflowed() const { return overflow_; } // Buffer không đủ chỗ -> bỏ kết quả, thử lại với buffer lớn hơn
         void patch_u32(size_t offset, uint32_t value);
         void align(size_t boundary);
 
         // --- Data Movement ---
         void mov(Reg dst, Reg src);
         void mov(Reg dst, int64_t imm64);        // MOV r64, imm64
+        size_t mov_imm64(Reg dst, uint64_t imm); // Luôn dạng 10 byte, trả về vị trí imm64 (relocation)
         void mov(Reg dst, Reg base, int32_t disp); // Load: MOV dst, [base + disp]
         void mov(Reg base, int32_t disp, Reg src); // Store: MOV [base + disp], src
         
@@ -38,6 +40,16 @@ namespace meow::jit::x64 {
         void shl(Reg dst, uint8_t imm);
         void sar(Reg dst, uint8_t imm);
 
+        // --- SSE2 (Scalar Double) ---
+        void movq(Xmm dst, Reg src);       // MOVQ xmm, r64
+        void movq(Reg dst, Xmm src);       // MOVQ r64, xmm
+        void addsd(Xmm dst, Xmm src);
+        void subsd(Xmm dst, Xmm src);
+        void mulsd(Xmm dst, Xmm src);
+        void divsd(Xmm dst, Xmm src);
+        void ucomisd(Xmm a, Xmm b);        // Flags như so sánh unsigned (CF/ZF), unordered -> PF
+        void cvtsi2sd(Xmm dst, Reg src);   // CVTSI2SD xmm, r64
+
         // --- Control Flow & Comparison ---
         void cmp(Reg r1, Reg r2);
         void test(Reg r1, Reg r2);
@@ -68,10 +80,12 @@ namespace meow::jit::x64 {
         void emit_rex(bool w, bool r, bool x, bool b);
         void emit_modrm(int mode, int reg, int rm);
         void emit_alu(uint8_t opcode, Reg dst, Reg src);
+        void emit_sse(uint8_t prefix, uint8_t opcode, int reg, int rm, bool w = false); // prefix 0F op /r
 
         uint8_t* buffer_;
         size_t capacity_;
         size_t size_;
+        bool overflow_ = false;
     };
 
 } // namespace meow::jit::x64
\ No newline at end of file
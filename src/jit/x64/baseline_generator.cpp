@@ -0,0 +1,138 @@
+#include "x64/baseline_generator.h"
+#include "analysis/bytecode_analysis.h"
+#include "vm/vm_state.h"
+#include "meow/bytecode/op_codes.h"
+#include <cstddef>
+
+namespace meow::jit::x64 {
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+static const int32_t STATE_REGISTERS_OFFSET = static_cast<int32_t>(offsetof(meow::VMState, registers));
+static const int32_t STATE_CONSTANTS_OFFSET = static_cast<int32_t>(offsetof(meow::VMState, constants));
+#pragma GCC diagnostic pop
+
+// Lệnh có thể push frame rồi trả về IP của callee (hàm chưa JIT): RETURN trong Interpreter
+// quay lại lệnh ngay sau -> cần điểm vào ở đó (handlers::try_resume_jit)
+static bool may_call(OpCode op) {
+    return op == OpCode::CALL || op == OpCode::CALL_VOID || op == OpCode::INVOKE || op == OpCode::IMPORT_MODULE;
+}
+
+void BaselineGenerator::emit_enter() {
+    // Sau push RBX, R12 và 8 byte đệm RSP chia hết cho 16 tại mỗi lời gọi handler
+    asm_.push(RBX);
+    asm_.push(R12);
+    asm_.push(R12);
+    asm_.mov(RBX, RDI);
+    size_t pos = asm_.mov_imm64(R12, reinterpret_cast<uint64_t>(bytecode_));
+    relocs_.push_back({static_cast<uint32_t>(pos), RelocKind::BYTECODE, 0});
+}
+
+void BaselineGenerator::emit_jump(size_t target, bool cond, Condition cc) {
+    jumps_.push_back({asm_.cursor(), target, cond});
+    if (cond) asm_.jcc(cc, 0);
+    else asm_.jmp(0);
+}
+
+bool BaselineGenerator::compile(const uint8_t* bytecode, size_t len) {
+    stencil_of_.clear();
+    bc_offsets_.clear();
+    jumps_.clear();
+    osr_entries_.clear();
+    relocs_.clear();
+    bytecode_ = bytecode;
+
+    analysis::DecodedCode dc = analysis::decode(bytecode, len);
+    if (!dc.valid || dc.insns.empty()) return false;
+    const auto& insns = dc.insns;
+    const size_t n = insns.size();
+
+    // Điểm vào giữa hàm: loop header (OSR) và chỗ quay về sau lệnh gọi
+    std::vector<bool> is_entry(n, false);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& insn = insns[i];
+        if (insn.op != OpCode::SETUP_TRY && insn.target != analysis::NO_INDEX && insn.target <= i) is_entry[insn.target] = true;
+        if (may_call(insn.op) && i + 1 < n) is_entry[i + 1] = true;
+    }
+
+    emit_enter(); // Điểm vào chính rơi thẳng xuống lệnh đầu tiên
+
+    stencil_of_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& insn = insns[i];
+        const size_t target = insn.op == OpCode::SETUP_TRY ? analysis::NO_INDEX : insn.target;
+        stencil_of_[i] = asm_.cursor();
+        bc_offsets_.push_back(insn.offset);
+
+        // JUMP không cần handler (nó chỉ cộng offset)
+        if (insn.op == OpCode::JUMP) {
+            if (target < n) {
+                emit_jump(target, false);
+            } else {
+                asm_.mov(RAX, static_cast<int64_t>(len)); // Vùng đệm HALT cuối chunk
+                asm_.add(RAX, R12);
+                emit_jump(NO_TARGET, false);
+            }
+            continue;
+        }
+
+        asm_.mov(RAX, static_cast<int64_t>(insn.offset + 1)); // Handler nhận IP sau opcode
+        asm_.mov(RDI, R12);
+        asm_.add(RDI, RAX);
+        asm_.mov(RSI, RBX, STATE_REGISTERS_OFFSET);
+        asm_.mov(RDX, RBX, STATE_CONSTANTS_OFFSET);
+        asm_.mov(RCX, RBX);
+        size_t pos = asm_.mov_imm64(RAX, handler_address(static_cast<uint32_t>(insn.op)));
+        relocs_.push_back({static_cast<uint32_t>(pos), RelocKind::HANDLER, static_cast<uint32_t>(insn.op)});
+        asm_.call(RAX);
+
+        // RAX = IP kế tiếp -> offset trong chunk
+        asm_.mov(RCX, RAX);
+        asm_.sub(RCX, R12);
+        if (target < n) {
+            asm_.mov(RDX, static_cast<int64_t>(insns[target].offset));
+            asm_.cmp(RCX, RDX);
+            emit_jump(target, true, E);
+        }
+        if (i + 1 < n) {
+            asm_.mov(RDX, static_cast<int64_t>(insns[i + 1].offset));
+            asm_.cmp(RCX, RDX);
+            emit_jump(NO_TARGET, true, NE);
+        } else {
+            emit_jump(NO_TARGET, false);
+        }
+    }
+
+    // Thoát: RAX = IP cho Interpreter, RDX = JIT_BASELINE_EXIT
+    const size_t exit = asm_.cursor();
+    asm_.mov(RDX, static_cast<int64_t>(JIT_BASELINE_EXIT));
+    asm_.pop(RCX);
+    asm_.pop(R12);
+    asm_.pop(RBX);
+    asm_.ret();
+
+    for (size_t i = 0; i < n; ++i) {
+        if (!is_entry[i]) continue;
+        osr_entries_.push_back({static_cast<uint32_t>(insns[i].offset), asm_.cursor()});
+        emit_enter();
+        emit_jump(i, false);
+    }
+
+    for (const Jump& j : jumps_) {
+        const size_t dest = j.target == NO_TARGET ? exit : stencil_of_[j.target];
+        const size_t jump_len = j.is_cond ? 6 : 5;
+        asm_.patch_u32(j.pos + (j.is_cond ? 2 : 1), static_cast<uint32_t>(static_cast<int32_t>(dest - (j.pos + jump_len))));
+    }
+    return true;
+}
+
+std::vector<LineEntry> BaselineGenerator::line_table() const {
+    std::vector<LineEntry> lines;
+    lines.reserve(stencil_of_.size());
+    for (size_t i = 0; i < stencil_of_.size(); ++i) {
+        lines.push_back({static_cast<uint32_t>(stencil_of_[i]), static_cast<uint32_t>(bc_offsets_[i])});
+    }
+    return lines;
+}
+
+} // namespace meow::jit::x64
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "jit_compiler.h"
+#include "relocation.h"
+#include "x64/assembler.h"
+#include "x64/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace meow::jit::x64 {
+
+/**
+ * @brief Baseline tier: phủ mọi opcode bằng cách ghép "stencil" gọi thẳng handler của Interpreter
+ * (handlers::impl_*, bản không OSR ở runtime/stencils.cpp) với lỗ được vá cho IP/operand và nhảy nội bộ.
+ * Không còn dispatch: lệnh kế tiếp / đích nhảy là jmp trong mã máy, handler trả IP khác
+ * (CALL sang hàm thông dịch, RETURN, exception, HALT) -> thoát về Interpreter (JIT_BASELINE_EXIT).
+ * Không speculate nên không bao giờ deopt. Dùng khi CodeGenerator từ chối proto.
+ *
+ * Stencil của lệnh tại offset o:
+ *   rdi = r12 + o + 1 ; rsi = state->registers ; rdx = state->constants ; rcx = rbx (state)
+ *   call impl_<op>    ; rax = IP kế tiếp
+ *   rax - r12 == đích nhảy -> jmp stencil đích ; == lệnh kế -> rơi xuống ; còn lại -> thoát
+ * RBX = VMState*, R12 = bytecode base (relocation BYTECODE). Không giữ giá trị VM nào trong register
+ * nên mọi stencil là điểm vào hợp lệ cho bất kỳ frame nào của proto.
+ */
+class BaselineGenerator {
+public:
+    BaselineGenerator(uint8_t* buffer, size_t capacity) : asm_(buffer, capacity) {}
+
+    // false nếu bytecode không giải mã được
+    bool compile(const uint8_t* bytecode, size_t len);
+
+    size_t code_size() const { return asm_.cursor(); }
+    bool overflowed() const { return asm_.overflowed(); }
+
+    // Điểm vào giữa hàm: loop header và lệnh ngay sau mỗi lệnh gọi (Interpreter quay lại từ callee)
+    const std::vector<OsrEntry>& osr_entries() const { return osr_entries_; }
+    const std::vector<Relocation>& relocs() const { return relocs_; }
+    std::vector<LineEntry> line_table() const;
+
+private:
+    struct Jump {
+        size_t pos;    // Vị trí lệnh nhảy (rel32 ở pos + 1 hoặc pos + 2)
+        size_t target; // Chỉ số lệnh đích, NO_TARGET: thoát
+        bool is_cond;
+    };
+    static constexpr size_t NO_TARGET = static_cast<size_t>(-1);
+
+    Assembler asm_;
+    const uint8_t* bytecode_ = nullptr;
+    std::vector<size_t> stencil_of_; // Chỉ số lệnh -> native offset
+    std::vector<size_t> bc_offsets_;
+    std::vector<Jump> jumps_;
+    std::vector<OsrEntry> osr_entries_;
+    std::vector<Relocation> relocs_;
+
+    void emit_enter();                            // Lưu RBX/R12, nạp state và bytecode base
+    void emit_jump(size_t target, bool cond, Condition cc = E);
+};
+
+} // namespace meow::jit::x64
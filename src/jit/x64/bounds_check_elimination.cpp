@@ -0,0 +1,169 @@
+#include "x64/bounds_check_elimination.h"
+#include "analysis/bytecode_analysis.h"
+#include "meow/bytecode/op_codes.h"
+#include <algorithm>
+
+namespace meow::jit::x64 {
+
+namespace {
+
+    using analysis::Instruction;
+    using analysis::NO_INDEX;
+    using analysis::NO_REG;
+
+    // Lệnh thoát ở cuối header, quy về: còn ở trong loop <=> index < bound
+    struct ExitTest {
+        uint16_t index = NO_REG;
+        uint16_t bound = NO_REG;
+    };
+
+    // Phép so sánh gốc (bỏ hậu tố _B / tiền tố JUMP_IF_), NOP nếu không phải so sánh thứ tự
+    OpCode compare_of(OpCode op) {
+        switch (op) {
+            case OpCode::LT: case OpCode::LT_B: case OpCode::JUMP_IF_LT: case OpCode::JUMP_IF_LT_B: return OpCode::LT;
+            case OpCode::LE: case OpCode::LE_B: case OpCode::JUMP_IF_LE: case OpCode::JUMP_IF_LE_B: return OpCode::LE;
+            case OpCode::GT: case OpCode::GT_B: case OpCode::JUMP_IF_GT: case OpCode::JUMP_IF_GT_B: return OpCode::GT;
+            case OpCode::GE: case OpCode::GE_B: case OpCode::JUMP_IF_GE: case OpCode::JUMP_IF_GE_B: return OpCode::GE;
+            default: return OpCode::NOP;
+        }
+    }
+
+    // Ở lại loop khi cmp(a, b) == stay_when -> suy ra được a < b (hoặc b < a)?
+    ExitTest normalize(OpCode cmp, uint16_t a, uint16_t b, bool stay_when) {
+        if ((cmp == OpCode::LT && stay_when) || (cmp == OpCode::GE && !stay_when)) return {a, b};
+        if ((cmp == OpCode::GT && stay_when) || (cmp == OpCode::LE && !stay_when)) return {b, a};
+        return {};
+    }
+
+    ExitTest find_exit_test(const std::vector<Instruction>& insns, const analysis::BasicBlock& header,
+                            const std::vector<bool>& in_loop) {
+        const Instruction& jump = insns[header.last];
+        if (jump.target == NO_INDEX || jump.succs.size() != 2) return {};
+
+        auto inside = [&](size_t k) { return k < in_loop.size() && in_loop[k]; };
+        const bool taken_inside = inside(jump.target);
+        const size_t other = jump.succs[0] == jump.target ? jump.succs[1] : jump.succs[0];
+        if (taken_inside == inside(other)) return {}; // Không phải lệnh thoát loop
+
+        // JUMP_IF_GE i, n (nhảy khi so sánh đúng)
+        if (OpCode cmp = compare_of(jump.op); cmp != OpCode::NOP) {
+            return normalize(cmp, jump.uses[0], jump.uses[1], taken_inside);
+        }
+
+        // GE c, i, n + JUMP_IF_TRUE c (chưa được masm gộp)
+        const bool if_true = jump.op == OpCode::JUMP_IF_TRUE || jump.op == OpCode::JUMP_IF_TRUE_B;
+        const bool if_false = jump.op == OpCode::JUMP_IF_FALSE || jump.op == OpCode::JUMP_IF_FALSE_B;
+        if ((!if_true && !if_false) || header.last == header.first) return {};
+
+        const Instruction& test = insns[header.last - 1];
+        const OpCode cmp = compare_of(test.op);
+        if (cmp == OpCode::NOP || test.target != NO_INDEX || test.def != jump.uses[0]) return {};
+        if (test.def == test.uses[0] || test.def == test.uses[1]) return {};
+        return normalize(cmp, test.uses[0], test.uses[1], taken_inside == if_true);
+    }
+
+    // ADD i, i, s với s = LOAD_INT c (0 <= c < 2^31) ngay trong block, hoặc ADD_I i, i, c (c >= 0):
+    // i không giảm, không tràn 48-bit
+    bool is_counter_step(const uint8_t* bytecode, const std::vector<Instruction>& insns,
+                         const analysis::ControlFlowGraph& cfg, size_t d, uint16_t index) {
+        const Instruction& insn = insns[d];
+        if (insn.op == OpCode::ADD_I || insn.op == OpCode::ADD_I_B) {
+            return insn.uses.size() == 1 && insn.uses[0] == index && analysis::read_operands(bytecode, insn.offset)[2] >= 0;
+        }
+        if ((insn.op != OpCode::ADD && insn.op != OpCode::ADD_B) || insn.uses.size() != 2) return false;
+
+        const uint16_t step = insn.uses[0] == index ? insn.uses[1] : insn.uses[1] == index ? insn.uses[0] : NO_REG;
+        if (step == NO_REG || step == index) return false;
+
+        const size_t first = cfg.blocks()[cfg.block_of(d)].first;
+        for (size_t k = d; k-- > first; ) {
+            if (insns[k].def != step) continue;
+            if (insns[k].op != OpCode::LOAD_INT && insns[k].op != OpCode::LOAD_INT_B) return false;
+            const int64_t c = analysis::read_operands(bytecode, insns[k].offset)[1];
+            return c >= 0 && c < (int64_t(1) << 31);
+        }
+        return false;
+    }
+
+} // namespace
+
+void BoundsCheckElimination::run(const uint8_t* bytecode, size_t len, const std::vector<uint32_t>& failed_sites) {
+    hoisted_.clear();
+    loops_.clear();
+
+    const analysis::DecodedCode code = analysis::decode(bytecode, len);
+    if (!code.valid || code.insns.empty()) return;
+    const auto& insns = code.insns;
+    const size_t n = insns.size();
+
+    const analysis::ControlFlowGraph cfg(insns);
+    const analysis::DominatorTree dom(cfg);
+    const auto& blocks = cfg.blocks();
+
+    // RPO: loop ngoài trước -> site được hoist ra xa nhất có thể
+    for (const analysis::LoopInfo& loop : analysis::find_loops(cfg, dom)) {
+        if (std::find(failed_sites.begin(), failed_sites.end(), loop.start_ip) != failed_sites.end()) continue;
+
+        const analysis::BasicBlock& header = blocks[loop.header];
+        std::vector<bool> in_loop(n, false);
+        std::vector<size_t> body; // Lệnh trong loop, trừ header
+        for (size_t b : loop.blocks) {
+            for (size_t k = blocks[b].first; k <= blocks[b].last; ++k) {
+                in_loop[k] = true;
+                if (b != loop.header) body.push_back(k);
+            }
+        }
+
+        const ExitTest test = find_exit_test(insns, header, in_loop);
+        if (test.index == NO_REG || test.index == test.bound) continue;
+
+        // Bound bất biến, index chỉ tăng
+        std::vector<bool> written(code.num_regs, false);
+        bool counted = true;
+        for (size_t k = 0; k < n && counted; ++k) {
+            if (!in_loop[k] || insns[k].def < 0) continue;
+            const uint16_t def = static_cast<uint16_t>(insns[k].def);
+            written[def] = true;
+            if (def == test.bound) counted = false;
+            if (def == test.index && !is_counter_step(bytecode, insns, cfg, k, test.index)) counted = false;
+        }
+        if (!counted) continue;
+
+        // bounded[k]: mọi đường từ lệnh thoát tới lệnh k không ghi index (greatest fixpoint, chỉ hạ xuống)
+        std::vector<bool> bounded(n, false);
+        for (size_t k : body) bounded[k] = true;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t k : body) {
+                const bool out = bounded[k] && insns[k].def != test.index;
+                if (out) continue;
+                for (size_t s : insns[k].succs) {
+                    if (s < n && bounded[s]) { bounded[s] = false; changed = true; }
+                }
+            }
+        }
+
+        GuardedLoop guarded;
+        for (size_t k : body) {
+            const Instruction& insn = insns[k];
+            if (insn.op != OpCode::GET_INDEX && insn.op != OpCode::SET_INDEX) continue;
+            if (!bounded[k] || hoisted_.count(insn.offset)) continue;
+
+            const uint16_t array = insn.uses[0], key = insn.uses[1];
+            if (key != test.index || written[array] || array == test.index || array == test.bound) continue;
+
+            const LoopGuard guard{array, test.index, test.bound};
+            if (std::find(guarded.guards.begin(), guarded.guards.end(), guard) == guarded.guards.end()) {
+                guarded.guards.push_back(guard);
+            }
+            hoisted_.insert(insn.offset);
+        }
+        if (guarded.guards.empty()) continue;
+
+        for (size_t k = 0; k < n; ++k) if (in_loop[k]) guarded.members.insert(insns[k].offset);
+        loops_.emplace(loop.start_ip, std::move(guarded));
+    }
+}
+
+} // namespace meow::jit::x64
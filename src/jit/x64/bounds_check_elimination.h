@@ -0,0 +1,66 @@
+/**
+ * @file bounds_check_elimination.h
+ * @brief Đưa tag check / bounds check của GET_INDEX, SET_INDEX trong vòng lặp đếm ra loop header
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace meow::jit::x64 {
+
+    // Điều kiện kiểm một lần mỗi khi vào loop (từ ngoài hoặc OSR):
+    // array_reg là array, index_reg là int >= 0, bound_reg là int <= size của array
+    struct LoopGuard {
+        uint16_t array_reg;
+        uint16_t index_reg;
+        uint16_t bound_reg;
+
+        bool operator==(const LoopGuard&) const = default;
+    };
+
+    /**
+     * @brief Nhận dạng vòng lặp đếm trên natural loop (analysis::find_loops):
+     *   - header kết thúc bằng lệnh thoát `i >= n` (JUMP_IF_GE i, n hoặc GE/LT + JUMP_IF_TRUE/FALSE)
+     *   - trong loop i chỉ được ghi bởi ADD i, i, s với s = LOAD_INT c (0 <= c < 2^31) cùng block
+     *   - array và n không bị ghi trong loop
+     * Site GET_INDEX/SET_INDEX arr[i] mà mọi đường từ lệnh thoát tới nó không ghi i
+     * thì có 0 <= i < n <= size: bỏ hết check, chỉ còn đọc/ghi thẳng buffer của ObjArray.
+     * Size của array không bao giờ giảm trong mã template JIT (SET_INDEX chỉ nới ra),
+     * nên guard ở header đúng cho mọi vòng lặp; buffer có thể đổi (resize) nên vẫn đọc lại con trỏ data.
+     * Guard fail -> deopt tại header; header nằm trong failed_sites thì không hoist nữa.
+     */
+    class BoundsCheckElimination {
+    public:
+        void run(const uint8_t* bytecode, size_t len, const std::vector<uint32_t>& failed_sites);
+
+        // Site GET_INDEX/SET_INDEX tại bc_offset đã được guard ở loop header bao ngoài
+        bool is_hoisted(size_t bc_offset) const { return hoisted_.count(bc_offset) != 0; }
+
+        // Guard cần sinh ở loop header (nullptr: header không có guard)
+        const std::vector<LoopGuard>* guards_at(size_t header) const {
+            auto it = loops_.find(header);
+            return it == loops_.end() ? nullptr : &it->second.guards;
+        }
+
+        // Lệnh tại bc_offset thuộc thân loop: nhảy từ đó về header đi thẳng qua guard
+        bool in_loop(size_t header, size_t bc_offset) const {
+            auto it = loops_.find(header);
+            return it != loops_.end() && it->second.members.count(bc_offset) != 0;
+        }
+
+    private:
+        struct GuardedLoop {
+            std::vector<LoopGuard> guards;
+            std::unordered_set<size_t> members; // Bytecode offset các lệnh trong thân loop
+        };
+
+        std::unordered_set<size_t> hoisted_;
+        std::unordered_map<size_t, GuardedLoop> loops_;
+    };
+
+} // namespace meow::jit::x64
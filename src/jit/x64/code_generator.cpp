@@ -2,16 +2,16 @@
 #include "jit_config.h"
 #include "x64/common.h"
 #include "meow/value.h"
+#include "meow/core/oop.h"
+#include "meow/core/function.h"
+#include "meow/core/array.h"
 #include "meow/bytecode/op_codes.h"
+#include "vm/handlers/inline_cache.h"
+#include "relocation.h"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 
-// --- Runtime Helper Definitions ---
-namespace meow::jit::runtime {
-    extern "C" void binary_op_generic(int op, uint64_t v1, uint64_t v2, uint64_t* dst);
-    extern "C" void compare_generic(int op, uint64_t v1, uint64_t v2, uint64_t* dst);
-}
-
 namespace meow::jit::x64 {
 
 using Layout = meow::Value::layout_traits;
@@ -32,23 +32,114 @@ static constexpr uint64_t NULL_INDEX = Variant::index_of<meow::null_t>();
 static constexpr uint64_t TAG_INT    = Layout::make_tag(INT_INDEX);
 static constexpr uint64_t TAG_BOOL   = Layout::make_tag(BOOL_INDEX);
 static constexpr uint64_t TAG_NULL   = Layout::make_tag(NULL_INDEX);
+static constexpr uint64_t TAG_OBJECT = Layout::make_tag(Variant::index_of<meow::object_t>());
 
 static constexpr uint64_t TAG_SHIFT     = Layout::TAG_SHIFT;
 static constexpr uint64_t TAG_CHECK_VAL = TAG_INT >> TAG_SHIFT; 
 static constexpr uint64_t VALUE_FALSE   = TAG_BOOL | 0;
+static constexpr uint64_t VALUE_TRUE    = TAG_BOOL | 1;
+
+// Layout object cho Inline Cache
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+static const int32_t OBJ_TYPE_OFFSET = static_cast<int32_t>(offsetof(meow::MeowObject, type));
+#pragma GCC diagnostic pop
+static const int32_t INSTANCE_SHAPE_OFFSET  = static_cast<int32_t>(meow::ObjInstance::shape_offset());
+static const int32_t INSTANCE_FIELDS_OFFSET = static_cast<int32_t>(meow::ObjInstance::fields_data_offset());
+static const int32_t CLOSURE_PROTO_OFFSET   = static_cast<int32_t>(meow::ObjClosure::proto_offset());
+static const int32_t ARRAY_DATA_OFFSET      = static_cast<int32_t>(meow::ObjArray::elements_data_offset());
+static const int32_t ARRAY_END_OFFSET       = static_cast<int32_t>(meow::ObjArray::elements_end_offset());
+
+// Opcode gốc mà runtime stub (OperatorDispatcher) hiểu: ADD_B -> ADD, JUMP_IF_LT -> LT...
+static OpCode base_op(OpCode op) {
+    switch (op) {
+        case OpCode::ADD_B: case OpCode::ADD_I: case OpCode::ADD_I_B: return OpCode::ADD;
+        case OpCode::SUB_B: case OpCode::SUB_I: case OpCode::SUB_I_B: return OpCode::SUB;
+        case OpCode::MUL_B: case OpCode::MUL_I: case OpCode::MUL_I_B: return OpCode::MUL;
+        case OpCode::DIV_B: return OpCode::DIV;
+        case OpCode::EQ_B:  case OpCode::JUMP_IF_EQ:  case OpCode::JUMP_IF_EQ_B:  return OpCode::EQ;
+        case OpCode::NEQ_B: case OpCode::JUMP_IF_NEQ: case OpCode::JUMP_IF_NEQ_B: return OpCode::NEQ;
+        case OpCode::LT_B:  case OpCode::JUMP_IF_LT:  case OpCode::JUMP_IF_LT_B:  return OpCode::LT;
+        case OpCode::LE_B:  case OpCode::JUMP_IF_LE:  case OpCode::JUMP_IF_LE_B:  return OpCode::LE;
+        case OpCode::GT_B:  case OpCode::JUMP_IF_GT:  case OpCode::JUMP_IF_GT_B:  return OpCode::GT;
+        case OpCode::GE_B:  case OpCode::JUMP_IF_GE:  case OpCode::JUMP_IF_GE_B:  return OpCode::GE;
+        case OpCode::EQ_I:  case OpCode::EQ_I_B:  case OpCode::JUMP_IF_EQ_I:  case OpCode::JUMP_IF_EQ_I_B:  return OpCode::EQ;
+        case OpCode::NEQ_I: case OpCode::NEQ_I_B: case OpCode::JUMP_IF_NEQ_I: case OpCode::JUMP_IF_NEQ_I_B: return OpCode::NEQ;
+        case OpCode::LT_I:  case OpCode::LT_I_B:  case OpCode::JUMP_IF_LT_I:  case OpCode::JUMP_IF_LT_I_B:  return OpCode::LT;
+        case OpCode::LE_I:  case OpCode::LE_I_B:  case OpCode::JUMP_IF_LE_I:  case OpCode::JUMP_IF_LE_I_B:  return OpCode::LE;
+        case OpCode::GT_I:  case OpCode::GT_I_B:  case OpCode::JUMP_IF_GT_I:  case OpCode::JUMP_IF_GT_I_B:  return OpCode::GT;
+        case OpCode::GE_I:  case OpCode::GE_I_B:  case OpCode::JUMP_IF_GE_I:  case OpCode::JUMP_IF_GE_I_B:  return OpCode::GE;
+        default: return op;
+    }
+}
 
 CodeGenerator::CodeGenerator(uint8_t* buffer, size_t capacity) 
     : asm_(buffer, capacity) {}
 
-Reg CodeGenerator::map_vm_reg(int vm_reg) const {
-    switch (vm_reg) {
-        case 0: return RBX;
-        case 1: return R12;
-        case 2: return R13;
-        default: return INVALID_REG;
+bool CodeGenerator::is_supported(OpCode op) {
+    switch (op) {
+        case OpCode::NOP: case OpCode::HALT: case OpCode::RETURN:
+        case OpCode::LOAD_CONST: case OpCode::LOAD_CONST_B:
+        case OpCode::LOAD_INT:   case OpCode::LOAD_INT_B:
+        case OpCode::LOAD_FLOAT: case OpCode::LOAD_FLOAT_B:
+        case OpCode::LOAD_NULL:  case OpCode::LOAD_NULL_B:
+        case OpCode::LOAD_TRUE:  case OpCode::LOAD_TRUE_B:
+        case OpCode::LOAD_FALSE: case OpCode::LOAD_FALSE_B:
+        case OpCode::MOVE: case OpCode::MOVE_B:
+        case OpCode::ADD: case OpCode::ADD_B:
+        case OpCode::SUB: case OpCode::SUB_B:
+        case OpCode::MUL: case OpCode::MUL_B:
+        case OpCode::DIV: case OpCode::DIV_B:
+        case OpCode::EQ:  case OpCode::EQ_B:  case OpCode::NEQ: case OpCode::NEQ_B:
+        case OpCode::LT:  case OpCode::LT_B:  case OpCode::LE:  case OpCode::LE_B:
+        case OpCode::GT:  case OpCode::GT_B:  case OpCode::GE:  case OpCode::GE_B:
+        case OpCode::JUMP:
+        case OpCode::JUMP_IF_TRUE:  case OpCode::JUMP_IF_TRUE_B:
+        case OpCode::JUMP_IF_FALSE: case OpCode::JUMP_IF_FALSE_B:
+        case OpCode::JUMP_IF_EQ: case OpCode::JUMP_IF_EQ_B: case OpCode::JUMP_IF_NEQ: case OpCode::JUMP_IF_NEQ_B:
+        case OpCode::JUMP_IF_LT: case OpCode::JUMP_IF_LT_B: case OpCode::JUMP_IF_LE:  case OpCode::JUMP_IF_LE_B:
+        case OpCode::JUMP_IF_GT: case OpCode::JUMP_IF_GT_B: case OpCode::JUMP_IF_GE:  case OpCode::JUMP_IF_GE_B:
+        case OpCode::ADD_I: case OpCode::ADD_I_B: case OpCode::SUB_I: case OpCode::SUB_I_B:
+        case OpCode::MUL_I: case OpCode::MUL_I_B:
+        case OpCode::EQ_I:  case OpCode::EQ_I_B:  case OpCode::NEQ_I: case OpCode::NEQ_I_B:
+        case OpCode::LT_I:  case OpCode::LT_I_B:  case OpCode::LE_I:  case OpCode::LE_I_B:
+        case OpCode::GT_I:  case OpCode::GT_I_B:  case OpCode::GE_I:  case OpCode::GE_I_B:
+        case OpCode::JUMP_IF_EQ_I: case OpCode::JUMP_IF_EQ_I_B: case OpCode::JUMP_IF_NEQ_I: case OpCode::JUMP_IF_NEQ_I_B:
+        case OpCode::JUMP_IF_LT_I: case OpCode::JUMP_IF_LT_I_B: case OpCode::JUMP_IF_LE_I:  case OpCode::JUMP_IF_LE_I_B:
+        case OpCode::JUMP_IF_GT_I: case OpCode::JUMP_IF_GT_I_B: case OpCode::JUMP_IF_GE_I:  case OpCode::JUMP_IF_GE_I_B:
+            return true;
+        case OpCode::GET_PROP: case OpCode::SET_PROP:
+            return ENABLE_INLINE_CACHE;
+        case OpCode::GET_INDEX: case OpCode::SET_INDEX:
+            return true;
+        default:
+            return false;
     }
 }
 
+uint64_t CodeGenerator::abi_fingerprint() {
+    // FNV-1a trên mọi hằng số layout mà mã sinh ra nhúng trực tiếp
+    const uint64_t parts[] = {
+        TAG_INT, TAG_BOOL, TAG_NULL, TAG_OBJECT, TAG_SHIFT, Layout::PAYLOAD_MASK, Layout::EXP_MASK,
+        static_cast<uint64_t>(OBJ_TYPE_OFFSET), static_cast<uint64_t>(INSTANCE_SHAPE_OFFSET),
+        static_cast<uint64_t>(INSTANCE_FIELDS_OFFSET), static_cast<uint64_t>(CLOSURE_PROTO_OFFSET),
+        static_cast<uint64_t>(ARRAY_DATA_OFFSET), static_cast<uint64_t>(ARRAY_END_OFFSET),
+        static_cast<uint64_t>(meow::ObjectType::INSTANCE), static_cast<uint64_t>(meow::ObjectType::FUNCTION),
+        static_cast<uint64_t>(meow::ObjectType::ARRAY),
+        sizeof(handlers::InlineCache), static_cast<uint64_t>(OpCode::TOTAL_OPCODES),
+        static_cast<uint64_t>(RuntimeStub::COUNT),
+    };
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (uint64_t v : parts) {
+        for (int i = 0; i < 8; ++i) { h ^= (v >> (i * 8)) & 0xFF; h *= 0x100000001B3ULL; }
+    }
+    return h;
+}
+
+Reg CodeGenerator::map_vm_reg(int vm_reg) const {
+    return ra_.location(static_cast<uint16_t>(vm_reg));
+}
+
 void CodeGenerator::load_vm_reg(Reg cpu_dst, int vm_src) {
     Reg mapped = map_vm_reg(vm_src);
     if (mapped != INVALID_REG) {
@@ -67,7 +158,7 @@ void CodeGenerator::store_vm_reg(int vm_dst, Reg cpu_src) {
     }
 }
 
-void CodeGenerator::emit_prologue() {
+void CodeGenerator::emit_prologue(size_t insn_idx) {
     asm_.push(RBP); 
     asm_.mov(RBP, RSP);
     asm_.push(RBX); asm_.push(R12); asm_.push(R13); asm_.push(R14); asm_.push(R15);
@@ -75,284 +166,986 @@ void CodeGenerator::emit_prologue() {
     asm_.mov(REG_VM_REGS_BASE, RDI, 32); 
     asm_.mov(REG_CONSTS_BASE,  RDI, 40); 
 
-    for (int i = 0; i <= 2; ++i) {
-        Reg r = map_vm_reg(i);
-        asm_.mov(r, MEM_REG(i));
-    }
+    // Chỉ nạp các register sống tại điểm vào (tham số, biến đọc trước khi ghi).
+    // RDI có thể được cấp phát nên phải nạp sau khi đã lấy xong R14/R15.
+    reload_regs(ra_.live_in(insn_idx), false);
 }
 
 void CodeGenerator::emit_epilogue() {
-    for (int i = 0; i <= 2; ++i) {
-        Reg r = map_vm_reg(i);
-        asm_.mov(MEM_REG(i), r);
-    }
+    // Không cần ghi ngược: frame bị hủy ngay sau RETURN, kết quả nằm trong RAX
     asm_.pop(R15); asm_.pop(R14); asm_.pop(R13); asm_.pop(R12); asm_.pop(RBX);
     asm_.pop(RBP);
     asm_.ret();
 }
 
-void CodeGenerator::flush_cached_regs() {
-    for (int i = 0; i <= 2; ++i) {
+void CodeGenerator::spill_regs(const std::vector<uint16_t>& vm_regs, bool only_caller_saved) {
+    for (uint16_t i : vm_regs) {
         Reg r = map_vm_reg(i);
+        if (r == INVALID_REG) continue;
+        if (only_caller_saved && !RegisterAllocator::is_caller_saved(r)) continue;
         asm_.mov(MEM_REG(i), r);
     }
 }
 
-void CodeGenerator::reload_cached_regs() {
-    for (int i = 0; i <= 2; ++i) {
+void CodeGenerator::reload_regs(const std::vector<uint16_t>& vm_regs, bool only_caller_saved) {
+    for (uint16_t i : vm_regs) {
         Reg r = map_vm_reg(i);
+        if (r == INVALID_REG) continue;
+        if (only_caller_saved && !RegisterAllocator::is_caller_saved(r)) continue;
         asm_.mov(r, MEM_REG(i));
     }
 }
 
-JitFunc CodeGenerator::compile(const uint8_t* bytecode, size_t len) {
+size_t CodeGenerator::native_target(size_t from_bc, size_t target_bc) {
+    auto guard = loop_guards_.find(target_bc);
+    if (guard != loop_guards_.end() && !bce_.in_loop(target_bc, from_bc)) return guard->second;
+    return bc_to_native_[target_bc];
+}
+
+void CodeGenerator::emit_loop_guards(const std::vector<LoopGuard>& guards, size_t deopt_bc, size_t insn_idx) {
+    auto use_reg = [&](uint16_t vm_reg, Reg scratch) {
+        Reg r = map_vm_reg(vm_reg);
+        if (r == INVALID_REG) { load_vm_reg(scratch, vm_reg); r = scratch; }
+        return r;
+    };
+    // Tag int -> jumps, payload sign-extend -> R9
+    auto unbox_int = [&](Reg r, std::vector<size_t>& jumps) {
+        asm_.mov(R9, r); asm_.sar(R9, TAG_SHIFT);
+        asm_.mov(R8, TAG_CHECK_VAL); asm_.cmp(R9, R8);
+        jumps.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+        asm_.mov(R9, r); asm_.shl(R9, 16); asm_.sar(R9, 16);
+    };
+
+    std::vector<size_t> fail;
+    for (const LoopGuard& g : guards) {
+        // Array: tag object + ObjectType::ARRAY, RAX = size
+        Reg arr = use_reg(g.array_reg, RAX);
+        asm_.mov(R8, arr); asm_.sar(R8, TAG_SHIFT);
+        asm_.mov(R9, TAG_OBJECT >> TAG_SHIFT); asm_.cmp(R8, R9);
+        fail.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+        asm_.mov(R8, arr); asm_.mov(R9, Layout::PAYLOAD_MASK); asm_.and_(R8, R9);
+        asm_.mov(R9, R8, OBJ_TYPE_OFFSET); asm_.movzx_b(R9, R9);
+        asm_.mov(RCX, (int64_t)meow::ObjectType::ARRAY); asm_.cmp(R9, RCX);
+        fail.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+        asm_.mov(RAX, R8, ARRAY_END_OFFSET);
+        asm_.mov(RCX, R8, ARRAY_DATA_OFFSET);
+        asm_.sub(RAX, RCX); asm_.sar(RAX, 3);
+
+        // Bound: int, <= size (âm thì loop không chạy lần nào, vẫn đúng)
+        unbox_int(use_reg(g.bound_reg, RCX), fail);
+        asm_.cmp(R9, RAX);
+        fail.push_back(asm_.cursor()); asm_.jcc(G, 0);
+
+        // Index: int, >= 0 (trong loop chỉ tăng)
+        unbox_int(use_reg(g.index_reg, RCX), fail);
+        asm_.test(R9, R9);
+        fail.push_back(asm_.cursor()); asm_.jcc(S, 0);
+    }
+    deopt_exits_.push_back({std::move(fail), deopt_bc, insn_idx});
+}
+
+void CodeGenerator::patch_jump(size_t pos, bool is_cond, size_t target) {
+    size_t jump_len = is_cond ? 6 : 5;
+    asm_.patch_u32(pos + (is_cond ? 2 : 1), (int32_t)(target - (pos + jump_len)));
+}
+
+InlineOrigin CodeGenerator::origin_of(size_t bc_offset) const {
+    if (!inlined_) return InlineOrigin{static_cast<uint32_t>(bc_offset), -1};
+    return inlined_->origin(bc_offset);
+}
+
+const uint8_t* CodeGenerator::source_of(size_t bc_offset) const {
+    return inlined_ ? inlined_->source(bc_offset) : bytecode_ + bc_offset;
+}
+
+std::vector<LineEntry> CodeGenerator::line_table() const {
+    std::vector<std::pair<size_t, size_t>> points; // {native, bc} (bc == len: vùng đệm HALT)
+    points.reserve(bc_to_native_.size());
+    for (auto [bc, native] : bc_to_native_) points.push_back({native, bc});
+    std::sort(points.begin(), points.end());
+
+    std::vector<LineEntry> lines;
+    for (size_t k = 0; k < points.size(); ++k) {
+        // Lệnh không sinh mã (NOP) trùng native offset với lệnh sau -> lấy lệnh sau
+        if (k + 1 < points.size() && points[k + 1].first == points[k].first) continue;
+        auto [native, bc] = points[k];
+        uint32_t source = static_cast<uint32_t>(bc);
+        if (inlined_) {
+            if (!inlined_->origins.count(bc)) continue; // Vùng đệm HALT của bản inline: gộp vào lệnh trước
+            InlineOrigin o = inlined_->origin(bc);
+            source = o.site < 0 ? o.offset : inlined_->sites[o.site].call_offset;
+        }
+        if (!lines.empty() && lines.back().bc_offset == source) continue;
+        lines.push_back({static_cast<uint32_t>(native), source});
+    }
+    return lines;
+}
+
+void CodeGenerator::emit_stub_address(Reg dst, RuntimeStub stub) {
+    size_t pos = asm_.mov_imm64(dst, runtime_stub_address(stub));
+    relocs_.push_back({static_cast<uint32_t>(pos), RelocKind::RUNTIME_STUB, static_cast<uint32_t>(stub)});
+}
+
+void CodeGenerator::emit_bytecode_address(Reg dst, size_t bc_offset, const void* ptr) {
+    size_t pos = asm_.mov_imm64(dst, reinterpret_cast<uint64_t>(ptr));
+    // Tính theo chunk chứa lệnh gốc (caller hoặc callee inline)
+    InlineOrigin o = origin_of(bc_offset);
+    const uint8_t* base = o.site >= 0 ? inlined_->sites[o.site].code : inlined_ ? inlined_->caller_code : bytecode_;
+    uint32_t offset = static_cast<uint32_t>(static_cast<const uint8_t*>(ptr) - base);
+    relocs_.push_back({static_cast<uint32_t>(pos), RelocKind::BYTECODE, offset, o.site});
+}
+
+void CodeGenerator::emit_load_const(Reg dst, size_t bc_offset, uint16_t idx) {
+    InlineOrigin o = origin_of(bc_offset);
+    if (o.site < 0) asm_.mov(dst, MEM_CONST(idx));
+    else asm_.mov(dst, (int64_t)inlined_->sites[o.site].constants[idx].raw());
+}
+
+void CodeGenerator::emit_deopt_result(size_t bc_offset) {
+    InlineOrigin o = origin_of(bc_offset);
+    if (o.site < 0) {
+        asm_.mov(RAX, (int64_t)TAG_NULL);
+        asm_.mov(RDX, (int64_t)o.offset);
+        return;
+    }
+    // Interpreter dựng frame cho callee (register đã ở home slot, closure nằm ở closure_slot)
+    const InlineSite& site = inlined_->sites[o.site];
+    asm_.mov(RAX, (int64_t)site.call_offset);
+    asm_.mov(RDX, (int64_t)(JIT_INLINE_DEOPT | ((uint64_t)site.closure_slot << 32) | o.offset));
+}
+
+void CodeGenerator::emit_write_barrier_stub(size_t jump_pos, size_t insn_idx, Reg val, size_t resume_at) {
+    const auto& live_out = ra_.live_out(insn_idx);
+    patch_jump(jump_pos, true, asm_.cursor());
+    spill_regs(live_out, true);
+    asm_.mov(RSI, val);
+    asm_.mov(RDI, R8);
+    asm_.mov(RCX, 8); asm_.sub(RSP, RCX);
+    emit_stub_address(RAX, RuntimeStub::WRITE_BARRIER);
+    asm_.call(RAX);
+    asm_.mov(RCX, 8); asm_.add(RSP, RCX);
+    reload_regs(live_out, true);
+    asm_.jmp((int32_t)(resume_at - (asm_.cursor() + 5)));
+}
+
+void CodeGenerator::emit_property_ic_stubs(PropertyIC& pic) {
+    // 1. Polymorphic: so tiếp các shape còn lại (R9 = shape của object)
+    if (!pic.poly_shapes.empty()) {
+        patch_jump(pic.poly_jump, true, asm_.cursor());
+        std::vector<size_t> hits;
+        for (auto [shape, offset] : pic.poly_shapes) {
+            asm_.mov(RCX, (int64_t)shape); asm_.cmp(R9, RCX);
+            hits.push_back(asm_.cursor()); asm_.jcc(E, 0);
+        }
+        pic.miss_jumps.push_back({asm_.cursor(), false}); asm_.jmp(0);
+        for (size_t k = 0; k < hits.size(); ++k) {
+            patch_jump(hits[k], true, asm_.cursor());
+            asm_.mov(RCX, (int64_t)pic.poly_shapes[k].second * 8);
+            asm_.jmp((int32_t)(pic.join - (asm_.cursor() + 5)));
+        }
+    }
+
+    const auto& live_in = ra_.live_in(pic.insn_idx);
+    const auto& live_out = ra_.live_out(pic.insn_idx);
+
+    // 2. Write barrier
+    if (pic.is_set && pic.barrier_jump) emit_write_barrier_stub(pic.barrier_jump, pic.insn_idx, pic.barrier_val, pic.resume_at);
+
+    // 3. Miss handler: có thể cấp phát (bound method, transition) -> mọi register sống về home slot
+    size_t miss_start = asm_.cursor();
+    for (auto [pos, is_cond] : pic.miss_jumps) patch_jump(pos, is_cond, miss_start);
+
+    spill_regs(live_in, false);
+    spill_regs(live_out, false);
+    asm_.mov(RAX, 8); asm_.sub(RSP, RAX);
+
+    asm_.mov(RDI, MEM_REG(pic.obj_reg));
+    emit_load_const(RSI, pic.bc_offset, pic.name_idx);
+    if (pic.is_set) {
+        asm_.mov(RDX, MEM_REG(pic.val_reg));
+        emit_bytecode_address(RCX, pic.bc_offset, pic.ic);
+        emit_stub_address(RAX, RuntimeStub::SET_PROP_MISS);
+    } else {
+        emit_bytecode_address(RDX, pic.bc_offset, pic.ic);
+        asm_.mov(RCX, REG_VM_REGS_BASE);
+        asm_.mov(RAX, pic.val_reg * 8);
+        asm_.add(RCX, RAX);
+        emit_stub_address(RAX, RuntimeStub::GET_PROP_MISS);
+    }
+    asm_.call(RAX);
+    asm_.mov(RCX, 8); asm_.add(RSP, RCX);
+
+    asm_.test(RAX, RAX);
+    size_t bail = asm_.cursor(); asm_.jcc(E, 0);
+
+    reload_regs(live_out, false);
+    if (!pic.is_set && map_vm_reg(pic.val_reg) != INVALID_REG) {
+        asm_.mov(map_vm_reg(pic.val_reg), MEM_REG(pic.val_reg));
+    }
+    asm_.jmp((int32_t)(pic.resume_at - (asm_.cursor() + 5)));
+
+    // Runtime không xử lý được (lỗi, method của primitive...) -> Interpreter chạy lại lệnh này.
+    // Register sống đã nằm ở home slot từ trước lời gọi.
+    patch_jump(bail, true, asm_.cursor());
+    emit_deopt_result(pic.bc_offset);
+    emit_epilogue();
+}
+
+void CodeGenerator::emit_index_stubs(IndexAccess& access) {
+    if (access.is_set && access.barrier_jump) {
+        emit_write_barrier_stub(access.barrier_jump, access.insn_idx, access.barrier_val, access.resume_at);
+    }
+    if (access.miss_jumps.empty()) return; // Site đã hoist check ra loop header
+
+    // Miss handler: hash table có thể cấp phát key string -> mọi register sống về home slot
+    size_t miss_start = asm_.cursor();
+    for (auto [pos, is_cond] : access.miss_jumps) patch_jump(pos, is_cond, miss_start);
+
+    const auto& live_in = ra_.live_in(access.insn_idx);
+    const auto& live_out = ra_.live_out(access.insn_idx);
+    spill_regs(live_in, false);
+    spill_regs(live_out, false);
+    asm_.mov(RAX, 8); asm_.sub(RSP, RAX);
+
+    asm_.mov(RDI, MEM_REG(access.obj_reg));
+    asm_.mov(RSI, MEM_REG(access.key_reg));
+    if (access.is_set) {
+        asm_.mov(RDX, MEM_REG(access.val_reg));
+        emit_stub_address(RAX, RuntimeStub::SET_INDEX_MISS);
+    } else {
+        asm_.mov(RDX, REG_VM_REGS_BASE);
+        asm_.mov(RAX, access.val_reg * 8);
+        asm_.add(RDX, RAX);
+        emit_stub_address(RAX, RuntimeStub::GET_INDEX_MISS);
+    }
+    asm_.call(RAX);
+    asm_.mov(RCX, 8); asm_.add(RSP, RCX);
+
+    asm_.test(RAX, RAX);
+    size_t bail = asm_.cursor(); asm_.jcc(E, 0);
+
+    reload_regs(live_out, false);
+    if (!access.is_set && map_vm_reg(access.val_reg) != INVALID_REG) {
+        asm_.mov(map_vm_reg(access.val_reg), MEM_REG(access.val_reg));
+    }
+    asm_.jmp((int32_t)(access.resume_at - (asm_.cursor() + 5)));
+
+    // Lỗi (index không phải int, index string/instance...) -> Interpreter chạy lại lệnh và báo lỗi
+    patch_jump(bail, true, asm_.cursor());
+    emit_deopt_result(access.bc_offset);
+    emit_epilogue();
+}
+
+JitFunc CodeGenerator::compile(const uint8_t* bytecode, size_t len, bool speculate,
+                               const std::vector<uint32_t>& failed_sites, const InlinedCode* inlined) {
+    bytecode_ = bytecode;
+    inlined_ = inlined;
     bc_to_native_.clear();
     fixups_.clear();
     slow_paths_.clear();
+    prop_ics_.clear();
+    index_ops_.clear();
+    loop_guards_.clear();
+    deopt_exits_.clear();
+    loop_headers_.clear();
+    osr_entries_.clear();
+    relocs_.clear();
+
+    // Quét trước: chỉ compile khi toàn bộ opcode đều được hỗ trợ.
+    // Hàm có CALL/INVOKE/... sẽ ở lại Interpreter, trừ CALL đã được inline.
+    for (size_t ip = 0; ip < len; ) {
+        OpCode op = generic_op(static_cast<OpCode>(bytecode[ip])); // Opcode quickened -> bản generic
+        const bool inlined_call = inlined_ && inlined_->call_sites.count(ip);
+        if (!is_supported(op) && !inlined_call) {
+            if (JIT_DEBUG_LOG) {
+                std::cerr << "[JIT] Reject: unsupported opcode " << meow::enum_name(op) << " at " << ip << std::endl;
+            }
+            return nullptr;
+        }
+        // Site truy cập thuộc tính/phần tử từng phải thoát về Interpreter -> để Interpreter chạy cả hàm
+        if ((op == OpCode::GET_PROP || op == OpCode::SET_PROP || op == OpCode::GET_INDEX || op == OpCode::SET_INDEX) &&
+            std::find(failed_sites.begin(), failed_sites.end(), ip) != failed_sites.end()) {
+            if (JIT_DEBUG_LOG) std::cerr << "[JIT] Reject: property site " << ip << " needs interpreter" << std::endl;
+            return nullptr;
+        }
+        ip += 1 + get_op_info(op).operand_bytes;
+    }
 
+    ra_.run(bytecode, len);
+    speculate_ = speculate;
+    spec_.run(bytecode, len, failed_sites, speculate_); // Tier generic vẫn cần kiểu chắc chắn (int/float)
+    bce_ = BoundsCheckElimination{};
+    if (speculate_ && ENABLE_BOUNDS_CHECK_ELIMINATION) bce_.run(bytecode, len, failed_sites);
     emit_prologue();
 
     size_t ip = 0;
+    size_t prev_offset = len;
     while (ip < len) {
+        const size_t insn_offset = ip;
+        const size_t insn_idx = ra_.index_of(ip);
+
+        // Loop header có guard: vào từ ngoài (rơi xuống, nhảy tới, OSR) phải qua guard,
+        // nhảy ngược trong loop đi thẳng vào thân (bc_to_native_ trỏ sau guard)
+        if (const std::vector<LoopGuard>* guards = bce_.guards_at(insn_offset)) {
+            size_t skip = 0;
+            if (prev_offset < len && bce_.in_loop(insn_offset, prev_offset)) { skip = asm_.cursor(); asm_.jmp(0); }
+            loop_guards_[insn_offset] = asm_.cursor();
+            emit_loop_guards(*guards, insn_offset, insn_idx);
+            if (skip) patch_jump(skip, false, asm_.cursor());
+        }
+        prev_offset = insn_offset;
+
         bc_to_native_[ip] = asm_.cursor();
+        const bool spec_site = speculate_ && spec_.speculates(insn_offset);
         
-        OpCode op = static_cast<OpCode>(bytecode[ip++]);
+        OpCode op = generic_op(static_cast<OpCode>(bytecode[ip++]));
+        const size_t next_ip = ip + get_op_info(op).operand_bytes;
 
         auto read_u8  = [&]() { return bytecode[ip++]; };
         auto read_u16 = [&]() { 
             uint16_t v; std::memcpy(&v, bytecode + ip, 2); ip += 2; return v; 
         };
+        auto read_reg = [&](bool is_byte_op) -> uint16_t { return is_byte_op ? read_u8() : read_u16(); };
+
+        // Offset nhảy là i16 tương đối, tính từ lệnh kế tiếp
+        // Nhảy ngược -> đích là loop header (điểm vào OSR)
+        auto read_target = [&]() -> size_t {
+            int16_t off = static_cast<int16_t>(read_u16());
+            size_t target = static_cast<size_t>(static_cast<int64_t>(next_ip) + off);
+            if (off < 0) loop_headers_.push_back(target);
+            return target;
+        };
+
+        // Lấy VM register ra CPU register (dùng scratch nếu không được cache)
+        auto use_reg = [&](uint16_t vm_reg, Reg scratch) {
+            Reg r = map_vm_reg(vm_reg);
+            if (r == INVALID_REG) { load_vm_reg(scratch, vm_reg); r = scratch; }
+            return r;
+        };
+
+        // Tag Check (Int): nhảy sang slow path / deopt nếu không phải int.
+        // Register đã được chứng minh là int (TypeSpeculation) thì bỏ qua check.
+        auto emit_int_guards = [&](Reg a, uint16_t a_idx, Reg b, uint16_t b_idx, std::vector<size_t>& jumps) {
+            for (auto [r, idx] : {std::pair{a, a_idx}, std::pair{b, b_idx}}) {
+                if (spec_.is_int(insn_idx, idx)) continue;
+                asm_.mov(R8, r); asm_.sar(R8, TAG_SHIFT);
+                asm_.mov(R9, TAG_CHECK_VAL); asm_.cmp(R8, R9);
+                jumps.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+            }
+        };
 
-        // --- Helper: Arithmetic ---
-        auto emit_binary_op = [&](uint8_t opcode_alu, bool is_byte_op) {
-            uint16_t dst = is_byte_op ? read_u8() : read_u16();
-            uint16_t r1  = is_byte_op ? read_u8() : read_u16();
-            uint16_t r2  = is_byte_op ? read_u8() : read_u16();
+        // Guard fail: site speculative -> deopt, còn lại -> slow path gọi runtime
+        auto register_guard_target = [&](SlowPath&& sp) {
+            if (sp.jumps_to_here.empty()) return;
+            if (spec_site) {
+                deopt_exits_.push_back({std::move(sp.jumps_to_here), insn_offset, insn_idx});
+            } else {
+                slow_paths_.push_back(std::move(sp));
+            }
+        };
 
-            Reg r1_reg = map_vm_reg(r1);
-            if (r1_reg == INVALID_REG) { load_vm_reg(RAX, r1); r1_reg = RAX; }
-            Reg r2_reg = map_vm_reg(r2);
-            if (r2_reg == INVALID_REG) { load_vm_reg(RCX, r2); r2_reg = RCX; }
+        // Sign-extend payload 48-bit -> R8, R9
+        auto emit_unbox_ints = [&](Reg a, Reg b) {
+            asm_.mov(R8, a); asm_.shl(R8, 16); asm_.sar(R8, 16);
+            asm_.mov(R9, b); asm_.shl(R9, 16); asm_.sar(R9, 16);
+        };
 
-            // Tag Checks
-            asm_.mov(R8, r1_reg); asm_.sar(R8, TAG_SHIFT);
+        // Operand số -> double trong xmm: float giữ nguyên bit (NaN-boxing), int -> cvtsi2sd.
+        // Float hợp lệ luôn có exponent khác toàn 1, còn lại (tag, inf/NaN đã mã hóa) -> jumps
+        auto emit_load_double = [&](Xmm x, Reg r, uint16_t idx, std::vector<size_t>& jumps) {
+            if (spec_.is_int(insn_idx, idx)) {
+                asm_.mov(R8, r); asm_.shl(R8, 16); asm_.sar(R8, 16);
+                asm_.cvtsi2sd(x, R8);
+                return;
+            }
+            asm_.mov(R8, r); asm_.mov(R9, (int64_t)Layout::EXP_MASK); asm_.and_(R8, R9); asm_.cmp(R8, R9);
+            if (spec_.is_float(insn_idx, idx)) {
+                jumps.push_back(asm_.cursor()); asm_.jcc(E, 0);
+                asm_.movq(x, r);
+                return;
+            }
+            size_t not_float = asm_.cursor(); asm_.jcc(E, 0);
+            asm_.movq(x, r);
+            size_t done = asm_.cursor(); asm_.jmp(0);
+
+            patch_jump(not_float, true, asm_.cursor());
+            asm_.mov(R8, r); asm_.sar(R8, TAG_SHIFT);
             asm_.mov(R9, TAG_CHECK_VAL); asm_.cmp(R8, R9);
-            size_t j1 = asm_.cursor(); asm_.jcc(NE, 0);
+            jumps.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+            asm_.mov(R8, r); asm_.shl(R8, 16); asm_.sar(R8, 16);
+            asm_.cvtsi2sd(x, R8);
+            patch_jump(done, false, asm_.cursor());
+        };
 
-            asm_.mov(R8, r2_reg); asm_.sar(R8, TAG_SHIFT); asm_.cmp(R8, R9);
-            size_t j2 = asm_.cursor(); asm_.jcc(NE, 0);
+        // XMM0 -> R8. Boxing double là identity, trừ inf/NaN (encode lật bit) -> để slow path tính lại
+        auto emit_box_double = [&](std::vector<size_t>& jumps) {
+            asm_.movq(R8, XMM0);
+            asm_.mov(R9, R8); asm_.mov(RCX, (int64_t)Layout::EXP_MASK); asm_.and_(R9, RCX); asm_.cmp(R9, RCX);
+            jumps.push_back(asm_.cursor()); asm_.jcc(E, 0);
+        };
 
-            // Fast Path (Int)
-            asm_.mov(R8, r1_reg); asm_.shl(R8, 16); asm_.sar(R8, 16);
-            asm_.mov(R9, r2_reg); asm_.shl(R9, 16); asm_.sar(R9, 16);
+        // So sánh XMM0 với XMM1 (đã loại NaN nên không có unordered): L/LE đảo operand để dùng A/AE
+        auto emit_double_compare = [&](Condition cond) -> Condition {
+            if (cond == L || cond == LE) { asm_.ucomisd(XMM1, XMM0); return cond == L ? A : AE; }
+            asm_.ucomisd(XMM0, XMM1);
+            return cond == G ? A : AE;
+        };
 
-            switch(opcode_alu) {
-                case 0: asm_.add(R8, R9); break;
-                case 1: asm_.sub(R8, R9); break;
-                case 2: asm_.imul(R8, R9); break;
+        // Fast path số cho r1, r2: int (R8, R9) rồi double (XMM0, XMM1).
+        // Site speculate int: guard fail -> deopt luôn, không thử double.
+        // Operand đã biết là float: bỏ qua nhánh int. Trả về các jump fail (slow path / deopt).
+        auto emit_numeric = [&](uint16_t r1, uint16_t r2, bool int_ok, bool double_ok,
+                                auto&& emit_int, auto&& emit_double) {
+            Reg a = use_reg(r1, RAX);
+            Reg b = use_reg(r2, RCX);
+
+            std::vector<size_t> fail, not_int;
+            const bool has_float = spec_.is_float(insn_idx, r1) || spec_.is_float(insn_idx, r2);
+            const bool try_int = int_ok && !(double_ok && has_float);
+            const bool try_double = double_ok && (!try_int || !spec_site);
+
+            if (try_int) {
+                emit_int_guards(a, r1, b, r2, try_double ? not_int : fail);
+                emit_unbox_ints(a, b);
+                emit_int();
             }
+            if (try_double && (!try_int || !not_int.empty())) {
+                size_t skip = 0;
+                if (try_int) {
+                    skip = asm_.cursor(); asm_.jmp(0);
+                    for (size_t pos : not_int) patch_jump(pos, true, asm_.cursor());
+                }
+                emit_load_double(XMM0, a, r1, fail);
+                emit_load_double(XMM1, b, r2, fail);
+                emit_double(fail);
+                if (try_int) patch_jump(skip, false, asm_.cursor());
+            }
+            return fail;
+        };
 
-            asm_.mov(R9, Layout::PAYLOAD_MASK); asm_.and_(R8, R9);
-            asm_.mov(R9, TAG_INT); asm_.or_(R8, R9);
-            store_vm_reg(dst, R8);
+        // Như emit_numeric nhưng vế phải là hằng int16 của opcode _I: chỉ guard r1, R9 / XMM1 nạp thẳng từ imm
+        auto emit_numeric_imm = [&](uint16_t r1, int64_t imm, bool double_ok, auto&& emit_int, auto&& emit_double) {
+            Reg a = use_reg(r1, RAX);
 
-            size_t j_over = asm_.cursor(); asm_.jmp(0);
+            std::vector<size_t> fail, not_int;
+            const bool try_int = !(double_ok && spec_.is_float(insn_idx, r1));
+            const bool try_double = double_ok && (!try_int || !spec_site);
 
-            SlowPath sp;
-            sp.jumps_to_here = {j1, j2};
-            sp.op = static_cast<int>(op);
+            if (try_int) {
+                if (!spec_.is_int(insn_idx, r1)) {
+                    asm_.mov(R8, a); asm_.sar(R8, TAG_SHIFT);
+                    asm_.mov(R9, TAG_CHECK_VAL); asm_.cmp(R8, R9);
+                    (try_double ? not_int : fail).push_back(asm_.cursor()); asm_.jcc(NE, 0);
+                }
+                asm_.mov(R8, a); asm_.shl(R8, 16); asm_.sar(R8, 16);
+                asm_.mov(R9, imm);
+                emit_int();
+            }
+            if (try_double && (!try_int || !not_int.empty())) {
+                size_t skip = 0;
+                if (try_int) {
+                    skip = asm_.cursor(); asm_.jmp(0);
+                    for (size_t pos : not_int) patch_jump(pos, true, asm_.cursor());
+                }
+                emit_load_double(XMM0, a, r1, fail);
+                asm_.mov(R8, imm); asm_.cvtsi2sd(XMM1, R8);
+                emit_double(fail);
+                if (try_int) patch_jump(skip, false, asm_.cursor());
+            }
+            return fail;
+        };
+
+        // Vế phải của opcode _I: đọc int16 ngay sau r1 (slow path dùng lại dưới dạng Value int)
+        auto read_imm = [&]() -> int64_t { return static_cast<int16_t>(read_u16()); };
+        auto set_imm_operand = [&](SlowPath& sp, bool imm, int64_t value) {
+            sp.src2_is_imm = imm;
+            sp.src2_imm = ((uint64_t)value & Layout::PAYLOAD_MASK) | TAG_INT;
+        };
+
+        // --- Helper: Arithmetic (opcode_alu 3 = DIV: kết quả luôn là float, không có nhánh int) ---
+        auto emit_binary_op = [&](uint8_t opcode_alu, bool is_byte_op, bool imm = false) {
+            uint16_t dst = read_reg(is_byte_op);
+            uint16_t r1  = read_reg(is_byte_op);
+            const int64_t imm_val = imm ? read_imm() : 0;
+            uint16_t r2  = imm ? r1 : read_reg(is_byte_op);
+
+            auto emit_int = [&] {
+                switch(opcode_alu) {
+                    case 0: asm_.add(R8, R9); break;
+                    case 1: asm_.sub(R8, R9); break;
+                    case 2: asm_.imul(R8, R9); break;
+                }
+                asm_.mov(R9, Layout::PAYLOAD_MASK); asm_.and_(R8, R9);
+                asm_.mov(R9, TAG_INT); asm_.or_(R8, R9);
+                store_vm_reg(dst, R8);
+            };
+            auto emit_double = [&](std::vector<size_t>& jumps) {
+                switch(opcode_alu) {
+                    case 0: asm_.addsd(XMM0, XMM1); break;
+                    case 1: asm_.subsd(XMM0, XMM1); break;
+                    case 2: asm_.mulsd(XMM0, XMM1); break;
+                    case 3: asm_.divsd(XMM0, XMM1); break;
+                }
+                emit_box_double(jumps);
+                store_vm_reg(dst, R8);
+            };
+
+            SlowPath sp{};
+            sp.jumps_to_here = imm ? emit_numeric_imm(r1, imm_val, true, emit_int, emit_double)
+                                   : emit_numeric(r1, r2, opcode_alu != 3, true, emit_int, emit_double);
+
+            sp.op = static_cast<int>(base_op(op));
             sp.dst_reg_idx = dst;
             sp.src1_reg_idx = r1;
             sp.src2_reg_idx = r2;
-            sp.patch_jump_over = j_over;
-            slow_paths_.push_back(sp);
+            set_imm_operand(sp, imm, imm_val);
+            sp.insn_idx = insn_idx;
+            sp.bc_offset = insn_offset;
+            sp.resume_at = asm_.cursor();
+            register_guard_target(std::move(sp));
         };
 
         // --- Helper: Standard Comparison ---
-        auto emit_cmp_op = [&](Condition cond_code, bool is_byte_op) {
-            uint16_t dst = is_byte_op ? read_u8() : read_u16();
-            uint16_t r1  = is_byte_op ? read_u8() : read_u16();
-            uint16_t r2  = is_byte_op ? read_u8() : read_u16();
-
-            Reg r1_reg = map_vm_reg(r1);
-            if (r1_reg == INVALID_REG) { load_vm_reg(RAX, r1); r1_reg = RAX; }
-            Reg r2_reg = map_vm_reg(r2);
-            if (r2_reg == INVALID_REG) { load_vm_reg(RCX, r2); r2_reg = RCX; }
-
-            asm_.mov(R8, r1_reg); asm_.sar(R8, TAG_SHIFT);
-            asm_.mov(R9, TAG_CHECK_VAL); asm_.cmp(R8, R9);
-            size_t j1 = asm_.cursor(); asm_.jcc(NE, 0);
-
-            asm_.mov(R8, r2_reg); asm_.sar(R8, TAG_SHIFT); asm_.cmp(R8, R9);
-            size_t j2 = asm_.cursor(); asm_.jcc(NE, 0);
+        // EQ/NEQ trên float so với epsilon (OperatorDispatcher) -> chỉ có fast path int
+        auto emit_cmp_op = [&](Condition cond_code, bool is_byte_op, bool imm = false) {
+            uint16_t dst = read_reg(is_byte_op);
+            uint16_t r1  = read_reg(is_byte_op);
+            const int64_t imm_val = imm ? read_imm() : 0;
+            uint16_t r2  = imm ? r1 : read_reg(is_byte_op);
+
+            auto store_bool = [&](Condition cond) {
+                asm_.setcc(cond, RAX);
+                asm_.movzx_b(RAX, RAX);
+                asm_.mov(R9, TAG_BOOL); asm_.or_(RAX, R9);
+                store_vm_reg(dst, RAX);
+            };
 
-            asm_.cmp(r1_reg, r2_reg);
-            asm_.setcc(cond_code, RAX);
-            asm_.movzx_b(RAX, RAX);
-            asm_.mov(R9, TAG_BOOL); asm_.or_(RAX, R9);
-            store_vm_reg(dst, RAX);
+            auto emit_int = [&] { asm_.cmp(R8, R9); store_bool(cond_code); };
+            auto emit_double = [&](std::vector<size_t>&) { store_bool(emit_double_compare(cond_code)); };
+            const bool double_ok = cond_code != E && cond_code != NE;
 
-            size_t j_over = asm_.cursor(); asm_.jmp(0);
+            SlowPath sp{};
+            sp.jumps_to_here = imm ? emit_numeric_imm(r1, imm_val, double_ok, emit_int, emit_double)
+                                   : emit_numeric(r1, r2, true, double_ok, emit_int, emit_double);
 
-            SlowPath sp;
-            sp.jumps_to_here = {j1, j2};
-            sp.op = static_cast<int>(op);
+            sp.op = static_cast<int>(base_op(op));
             sp.dst_reg_idx = dst;
             sp.src1_reg_idx = r1;
             sp.src2_reg_idx = r2;
-            sp.patch_jump_over = j_over;
-            slow_paths_.push_back(sp);
+            set_imm_operand(sp, imm, imm_val);
+            sp.insn_idx = insn_idx;
+            sp.bc_offset = insn_offset;
+            sp.resume_at = asm_.cursor();
+            register_guard_target(std::move(sp));
         };
 
-        // --- Helper: Fused Compare & Jump [FIXED] ---
-        auto emit_fused_cmp_jump = [&](Condition cond) {
-            uint16_t r1_idx = read_u16();
-            uint16_t r2_idx = read_u16();
-            uint16_t target_off = read_u16();
+        // --- Helper: Fused Compare & Jump ---
+        auto emit_fused_cmp_jump = [&](Condition cond, bool is_byte_op, bool imm = false) {
+            uint16_t r1_idx = read_reg(is_byte_op);
+            const int64_t imm_val = imm ? read_imm() : 0;
+            uint16_t r2_idx = imm ? r1_idx : read_reg(is_byte_op);
+            size_t target = read_target();
+
+            // Tag check + Compare & Jump (int hoặc double)
+            auto emit_int = [&] {
+                asm_.cmp(R8, R9);
+                fixups_.push_back({asm_.cursor(), target, true, insn_offset});
+                asm_.jcc(cond, 0);
+            };
+            auto emit_double = [&](std::vector<size_t>&) {
+                Condition c = emit_double_compare(cond);
+                fixups_.push_back({asm_.cursor(), target, true, insn_offset});
+                asm_.jcc(c, 0);
+            };
+            const bool double_ok = cond != E && cond != NE;
+
+            SlowPath sp{};
+            sp.jumps_to_here = imm ? emit_numeric_imm(r1_idx, imm_val, double_ok, emit_int, emit_double)
+                                   : emit_numeric(r1_idx, r2_idx, true, double_ok, emit_int, emit_double);
+
+            // Register Slow Path
+            sp.op = static_cast<int>(base_op(op));
+            sp.src1_reg_idx = r1_idx;
+            sp.src2_reg_idx = r2_idx;
+            set_imm_operand(sp, imm, imm_val);
+            sp.is_branch = true;
+            sp.target_bc = target;
+            sp.insn_idx = insn_idx;
+            sp.bc_offset = insn_offset;
+            sp.resume_at = asm_.cursor();
+            register_guard_target(std::move(sp));
+        };
 
-            Reg r1 = map_vm_reg(r1_idx);
-            if (r1 == INVALID_REG) { load_vm_reg(RAX, r1_idx); r1 = RAX; }
-            Reg r2 = map_vm_reg(r2_idx);
-            if (r2 == INVALID_REG) { load_vm_reg(RCX, r2_idx); r2 = RCX; }
+        // --- Helper: JUMP_IF_TRUE / JUMP_IF_FALSE (truthiness giống meow::to_bool) ---
+        auto emit_truthy_jump = [&](bool jump_if_true, bool is_byte_op) {
+            uint16_t reg = read_reg(is_byte_op);
+            size_t target = read_target();
 
-            // 1. Tag Check (Int)
-            asm_.mov(R8, r1); asm_.sar(R8, TAG_SHIFT);
-            asm_.mov(R9, TAG_CHECK_VAL); asm_.cmp(R8, R9);
-            size_t j1 = asm_.cursor(); asm_.jcc(NE, 0);
+            Reg value = use_reg(reg, RAX);
 
-            asm_.mov(R8, r2); asm_.sar(R8, TAG_SHIFT); asm_.cmp(R8, R9);
-            size_t j2 = asm_.cursor(); asm_.jcc(NE, 0);
+            std::vector<std::pair<size_t, bool>> truthy, falsy; // {vị trí lệnh nhảy, is_cond}
 
-            // 2. Fast Compare & Jump
-            asm_.cmp(r1, r2);
-            fixups_.push_back({asm_.cursor(), (size_t)target_off, true});
-            asm_.jcc(cond, 0); 
+            asm_.mov(RCX, VALUE_TRUE); asm_.cmp(value, RCX);
+            truthy.push_back({asm_.cursor(), true}); asm_.jcc(E, 0);
+            for (uint64_t falsy_val : {VALUE_FALSE, TAG_NULL, TAG_INT}) {
+                asm_.mov(RCX, falsy_val); asm_.cmp(value, RCX);
+                falsy.push_back({asm_.cursor(), true}); asm_.jcc(E, 0);
+            }
 
-            size_t j_over = asm_.cursor();
+            // Float/Object: hỏi runtime (không cấp phát -> chỉ cần giữ caller-saved còn sống)
+            const auto& live_out = ra_.live_out(insn_idx);
+            spill_regs(live_out, true);
+            asm_.mov(RDI, value);
+            asm_.mov(RCX, 8); asm_.sub(RSP, RCX);
+            emit_stub_address(RAX, RuntimeStub::TRUTHY);
+            asm_.call(RAX);
+            asm_.mov(RCX, 8); asm_.add(RSP, RCX);
+            reload_regs(live_out, true);
+            asm_.test(RAX, RAX);
+            truthy.push_back({asm_.cursor(), true}); asm_.jcc(NE, 0);
+            falsy.push_back({asm_.cursor(), false}); asm_.jmp(0);
+
+            auto& taken = jump_if_true ? truthy : falsy;
+            auto& fallthrough = jump_if_true ? falsy : truthy;
+            for (auto [pos, is_cond] : taken) fixups_.push_back({pos, target, is_cond, insn_offset});
+
+            size_t here = asm_.cursor();
+            for (auto [pos, is_cond] : fallthrough) {
+                size_t jump_len = is_cond ? 6 : 5;
+                asm_.patch_u32(pos + (is_cond ? 2 : 1), (int32_t)(here - (pos + jump_len)));
+            }
+        };
 
-            // 3. Register Slow Path
-            SlowPath sp;
-            sp.jumps_to_here = {j1, j2};
-            sp.op = static_cast<int>(op);
-            sp.src1_reg_idx = r1_idx;
-            sp.src2_reg_idx = r2_idx;
-            sp.dst_reg_idx = target_off; // Hack: Lưu target offset vào dst
-            sp.patch_jump_over = j_over;
-            slow_paths_.push_back(sp);
+        // --- Helper: GET_PROP dst, obj, name / SET_PROP obj, name, val (+ InlineCache trong bytecode) ---
+        auto emit_property_access = [&](bool is_set) {
+            uint16_t a = read_u16(), b = read_u16(), c = read_u16();
+
+            PropertyIC pic{};
+            pic.is_set = is_set;
+            pic.obj_reg  = is_set ? a : b;
+            pic.name_idx = is_set ? b : c;
+            pic.val_reg  = is_set ? c : a;
+            pic.ic = source_of(insn_offset) + (ip - insn_offset); // IC ở chunk gốc, không phải bản inline
+            pic.bc_offset = insn_offset;
+            pic.insn_idx = insn_idx;
+
+            // Seed từ IC của Interpreter (SET: chỉ các entry cập nhật field có sẵn, transition đi runtime).
+            // Mã relocatable (AOT) không nhúng shape: địa chỉ Shape chỉ đúng trong process này.
+            handlers::InlineCache ic;
+            std::memcpy(&ic, pic.ic, sizeof(ic));
+            std::vector<std::pair<uint64_t, uint32_t>> shapes;
+            for (const auto& e : ic.entries) {
+                if (relocatable_ || !handlers::PrimitiveShapes::is_real(e.shape) || e.transition) continue;
+                shapes.push_back({reinterpret_cast<uint64_t>(e.shape), e.offset});
+            }
+
+            if (shapes.empty()) {
+                // Site chưa chạy lần nào trên instance -> luôn hỏi runtime
+                pic.miss_jumps.push_back({asm_.cursor(), false}); asm_.jmp(0);
+                pic.resume_at = asm_.cursor();
+                prop_ics_.push_back(std::move(pic));
+                return;
+            }
+
+            Reg obj = use_reg(pic.obj_reg, RAX);
+
+            // Tag object + ObjectType::INSTANCE
+            asm_.mov(R8, obj); asm_.sar(R8, TAG_SHIFT);
+            asm_.mov(R9, TAG_OBJECT >> TAG_SHIFT); asm_.cmp(R8, R9);
+            pic.miss_jumps.push_back({asm_.cursor(), true}); asm_.jcc(NE, 0);
+
+            asm_.mov(R8, obj); asm_.mov(R9, Layout::PAYLOAD_MASK); asm_.and_(R8, R9);
+            asm_.mov(R9, R8, OBJ_TYPE_OFFSET); asm_.movzx_b(R9, R9);
+            asm_.mov(RCX, (int64_t)meow::ObjectType::INSTANCE); asm_.cmp(R9, RCX);
+            pic.miss_jumps.push_back({asm_.cursor(), true}); asm_.jcc(NE, 0);
+
+            // Shape inline (monomorphic)
+            asm_.mov(R9, R8, INSTANCE_SHAPE_OFFSET);
+            asm_.mov(RCX, (int64_t)shapes[0].first); asm_.cmp(R9, RCX);
+            if (shapes.size() > 1) {
+                pic.poly_jump = asm_.cursor();
+                pic.poly_shapes.assign(shapes.begin() + 1, shapes.end());
+            } else {
+                pic.miss_jumps.push_back({asm_.cursor(), true});
+            }
+            asm_.jcc(NE, 0);
+            asm_.mov(RCX, (int64_t)shapes[0].second * 8);
+
+            // Đọc/ghi thẳng fields_[offset]
+            pic.join = asm_.cursor();
+            asm_.mov(R9, R8, INSTANCE_FIELDS_OFFSET);
+            asm_.add(R9, RCX);
+            if (!is_set) {
+                asm_.mov(RAX, R9, 0);
+                store_vm_reg(pic.val_reg, RAX);
+            } else {
+                Reg val = use_reg(pic.val_reg, RAX);
+                asm_.mov(R9, 0, val);
+                // Write barrier chỉ cần khi giá trị là object
+                asm_.mov(R9, val); asm_.sar(R9, TAG_SHIFT);
+                asm_.mov(RCX, TAG_OBJECT >> TAG_SHIFT); asm_.cmp(R9, RCX);
+                pic.barrier_jump = asm_.cursor(); asm_.jcc(E, 0);
+                pic.barrier_val = val;
+            }
+            pic.resume_at = asm_.cursor();
+            prop_ics_.push_back(std::move(pic));
         };
 
+        // --- Helper: GET_INDEX dst, arr, key / SET_INDEX arr, key, val ---
+        // Site đã hoist (BoundsCheckElimination): guard ở loop header đảm bảo array + 0 <= key < size
+        auto emit_index_access = [&](bool is_set) {
+            uint16_t a = read_u16(), b = read_u16(), c = read_u16();
+
+            IndexAccess access{};
+            access.is_set = is_set;
+            access.obj_reg = is_set ? a : b;
+            access.key_reg = is_set ? b : c;
+            access.val_reg = is_set ? c : a;
+            access.bc_offset = insn_offset;
+            access.insn_idx = insn_idx;
+
+            Reg obj = use_reg(access.obj_reg, RAX);
+            if (bce_.is_hoisted(insn_offset)) {
+                asm_.mov(R8, obj); asm_.mov(R9, Layout::PAYLOAD_MASK); asm_.and_(R8, R9);
+                Reg key = use_reg(access.key_reg, RCX);
+                asm_.mov(R9, key); asm_.shl(R9, 16); asm_.sar(R9, 13); // Sign-extend rồi nhân 8
+                asm_.mov(RCX, R8, ARRAY_DATA_OFFSET);
+            } else {
+                // Tag object + ObjectType::ARRAY
+                asm_.mov(R8, obj); asm_.sar(R8, TAG_SHIFT);
+                asm_.mov(R9, TAG_OBJECT >> TAG_SHIFT); asm_.cmp(R8, R9);
+                access.miss_jumps.push_back({asm_.cursor(), true}); asm_.jcc(NE, 0);
+
+                asm_.mov(R8, obj); asm_.mov(R9, Layout::PAYLOAD_MASK); asm_.and_(R8, R9);
+                asm_.mov(R9, R8, OBJ_TYPE_OFFSET); asm_.movzx_b(R9, R9);
+                asm_.mov(RCX, (int64_t)meow::ObjectType::ARRAY); asm_.cmp(R9, RCX);
+                access.miss_jumps.push_back({asm_.cursor(), true}); asm_.jcc(NE, 0);
+
+                Reg key = use_reg(access.key_reg, RCX);
+                if (!spec_.is_int(insn_idx, access.key_reg)) {
+                    asm_.mov(R9, key); asm_.sar(R9, TAG_SHIFT);
+                    asm_.mov(RAX, TAG_CHECK_VAL); asm_.cmp(R9, RAX);
+                    access.miss_jumps.push_back({asm_.cursor(), true}); asm_.jcc(NE, 0);
+                }
+                asm_.mov(R9, key); asm_.shl(R9, 16); asm_.sar(R9, 16);
+
+                // size = (end - begin) / 8; so sánh unsigned loại luôn index âm
+                asm_.mov(RAX, R8, ARRAY_END_OFFSET);
+                asm_.mov(RCX, R8, ARRAY_DATA_OFFSET);
+                asm_.sub(RAX, RCX); asm_.sar(RAX, 3);
+                asm_.cmp(R9, RAX);
+                access.miss_jumps.push_back({asm_.cursor(), true}); asm_.jcc(AE, 0);
+                asm_.shl(R9, 3);
+            }
+
+            // RCX = data của elements_, R9 = index * 8, R8 = array
+            asm_.add(RCX, R9);
+            if (!is_set) {
+                asm_.mov(RAX, RCX, 0);
+                store_vm_reg(access.val_reg, RAX);
+            } else {
+                Reg val = use_reg(access.val_reg, RAX);
+                asm_.mov(RCX, 0, val);
+                asm_.mov(R9, val); asm_.sar(R9, TAG_SHIFT);
+                asm_.mov(RCX, TAG_OBJECT >> TAG_SHIFT); asm_.cmp(R9, RCX);
+                access.barrier_jump = asm_.cursor(); asm_.jcc(E, 0);
+                access.barrier_val = val;
+            }
+            access.resume_at = asm_.cursor();
+            index_ops_.push_back(std::move(access));
+        };
+
+        auto emit_load_imm = [&](uint16_t dst, uint64_t bits) {
+            asm_.mov(RAX, (int64_t)bits);
+            store_vm_reg(dst, RAX);
+        };
+
+        const bool is_b = get_op_schema(op).count > 0 && get_op_schema(op).args[0] == ArgType::REG8;
+
         switch (op) {
-            case OpCode::LOAD_CONST: {
-                uint16_t dst = read_u16();
+            case OpCode::NOP: break;
+
+            case OpCode::LOAD_CONST: case OpCode::LOAD_CONST_B: {
+                uint16_t dst = read_reg(is_b);
                 uint16_t idx = read_u16();
-                asm_.mov(RAX, MEM_CONST(idx));
+                emit_load_const(RAX, insn_offset, idx);
                 store_vm_reg(dst, RAX);
                 break;
             }
-            case OpCode::LOAD_INT: {
-                uint16_t dst = read_u16();
+            case OpCode::LOAD_INT: case OpCode::LOAD_INT_B: {
+                uint16_t dst = read_reg(is_b);
                 int64_t val; std::memcpy(&val, bytecode + ip, 8); ip += 8;
-                asm_.mov(RAX, val);
-                asm_.mov(RCX, Layout::PAYLOAD_MASK); asm_.and_(RAX, RCX);
-                asm_.mov(RCX, TAG_INT); asm_.or_(RAX, RCX);
-                store_vm_reg(dst, RAX);
+                emit_load_imm(dst, ((uint64_t)val & Layout::PAYLOAD_MASK) | TAG_INT);
                 break;
             }
-            case OpCode::LOAD_TRUE: {
-                 uint16_t dst = read_u16();
-                 asm_.mov(RAX, TAG_BOOL | 1); store_vm_reg(dst, RAX);
-                 break;
-            }
-            case OpCode::LOAD_FALSE: {
-                 uint16_t dst = read_u16();
-                 asm_.mov(RAX, TAG_BOOL); store_vm_reg(dst, RAX);
-                 break;
+            case OpCode::LOAD_FLOAT: case OpCode::LOAD_FLOAT_B: {
+                uint16_t dst = read_reg(is_b);
+                uint64_t bits; std::memcpy(&bits, bytecode + ip, 8); ip += 8;
+                emit_load_imm(dst, bits);
+                break;
             }
-            case OpCode::MOVE: {
-                uint16_t dst = read_u16();
-                uint16_t src = read_u16();
-                Reg src_reg = map_vm_reg(src);
-                if (src_reg != INVALID_REG) store_vm_reg(dst, src_reg);
-                else { asm_.mov(RAX, MEM_REG(src)); store_vm_reg(dst, RAX); }
+            case OpCode::LOAD_NULL:  case OpCode::LOAD_NULL_B:  emit_load_imm(read_reg(is_b), TAG_NULL); break;
+            case OpCode::LOAD_TRUE:  case OpCode::LOAD_TRUE_B:  emit_load_imm(read_reg(is_b), VALUE_TRUE); break;
+            case OpCode::LOAD_FALSE: case OpCode::LOAD_FALSE_B: emit_load_imm(read_reg(is_b), VALUE_FALSE); break;
+
+            case OpCode::MOVE: case OpCode::MOVE_B: {
+                uint16_t dst = read_reg(is_b);
+                uint16_t src = read_reg(is_b);
+                store_vm_reg(dst, use_reg(src, RAX));
                 break;
             }
 
-            case OpCode::ADD: case OpCode::ADD_B: emit_binary_op(0, op == OpCode::ADD_B); break;
-            case OpCode::SUB: case OpCode::SUB_B: emit_binary_op(1, op == OpCode::SUB_B); break;
-            case OpCode::MUL: case OpCode::MUL_B: emit_binary_op(2, op == OpCode::MUL_B); break;
+            case OpCode::ADD: case OpCode::ADD_B: emit_binary_op(0, is_b); break;
+            case OpCode::SUB: case OpCode::SUB_B: emit_binary_op(1, is_b); break;
+            case OpCode::MUL: case OpCode::MUL_B: emit_binary_op(2, is_b); break;
+            case OpCode::DIV: case OpCode::DIV_B: emit_binary_op(3, is_b); break;
 
-            case OpCode::EQ:  case OpCode::EQ_B:  emit_cmp_op(E,  op == OpCode::EQ_B); break;
-            case OpCode::NEQ: case OpCode::NEQ_B: emit_cmp_op(NE, op == OpCode::NEQ_B); break;
-            case OpCode::LT:  case OpCode::LT_B:  emit_cmp_op(L,  op == OpCode::LT_B); break;
-            case OpCode::LE:  case OpCode::LE_B:  emit_cmp_op(LE, op == OpCode::LE_B); break;
-            case OpCode::GT:  case OpCode::GT_B:  emit_cmp_op(G,  op == OpCode::GT_B); break;
-            case OpCode::GE:  case OpCode::GE_B:  emit_cmp_op(GE, op == OpCode::GE_B); break;
+            case OpCode::EQ:  case OpCode::EQ_B:  emit_cmp_op(E,  is_b); break;
+            case OpCode::NEQ: case OpCode::NEQ_B: emit_cmp_op(NE, is_b); break;
+            case OpCode::LT:  case OpCode::LT_B:  emit_cmp_op(L,  is_b); break;
+            case OpCode::LE:  case OpCode::LE_B:  emit_cmp_op(LE, is_b); break;
+            case OpCode::GT:  case OpCode::GT_B:  emit_cmp_op(G,  is_b); break;
+            case OpCode::GE:  case OpCode::GE_B:  emit_cmp_op(GE, is_b); break;
 
             // --- Fused Compare & Jump ---
-            case OpCode::JUMP_IF_EQ: emit_fused_cmp_jump(E); break;
-            case OpCode::JUMP_IF_NEQ: emit_fused_cmp_jump(NE); break;
-            case OpCode::JUMP_IF_GT: emit_fused_cmp_jump(G); break;
-            case OpCode::JUMP_IF_GE: emit_fused_cmp_jump(GE); break;
-            case OpCode::JUMP_IF_LT: emit_fused_cmp_jump(L); break;
-            case OpCode::JUMP_IF_LE: emit_fused_cmp_jump(LE); break;
+            case OpCode::JUMP_IF_EQ:  case OpCode::JUMP_IF_EQ_B:  emit_fused_cmp_jump(E,  is_b); break;
+            case OpCode::JUMP_IF_NEQ: case OpCode::JUMP_IF_NEQ_B: emit_fused_cmp_jump(NE, is_b); break;
+            case OpCode::JUMP_IF_GT:  case OpCode::JUMP_IF_GT_B:  emit_fused_cmp_jump(G,  is_b); break;
+            case OpCode::JUMP_IF_GE:  case OpCode::JUMP_IF_GE_B:  emit_fused_cmp_jump(GE, is_b); break;
+            case OpCode::JUMP_IF_LT:  case OpCode::JUMP_IF_LT_B:  emit_fused_cmp_jump(L,  is_b); break;
+            case OpCode::JUMP_IF_LE:  case OpCode::JUMP_IF_LE_B:  emit_fused_cmp_jump(LE, is_b); break;
+
+            // --- Immediate (vế phải là hằng int16) ---
+            case OpCode::ADD_I: case OpCode::ADD_I_B: emit_binary_op(0, is_b, true); break;
+            case OpCode::SUB_I: case OpCode::SUB_I_B: emit_binary_op(1, is_b, true); break;
+            case OpCode::MUL_I: case OpCode::MUL_I_B: emit_binary_op(2, is_b, true); break;
+
+            case OpCode::EQ_I:  case OpCode::EQ_I_B:  emit_cmp_op(E,  is_b, true); break;
+            case OpCode::NEQ_I: case OpCode::NEQ_I_B: emit_cmp_op(NE, is_b, true); break;
+            case OpCode::LT_I:  case OpCode::LT_I_B:  emit_cmp_op(L,  is_b, true); break;
+            case OpCode::LE_I:  case OpCode::LE_I_B:  emit_cmp_op(LE, is_b, true); break;
+            case OpCode::GT_I:  case OpCode::GT_I_B:  emit_cmp_op(G,  is_b, true); break;
+            case OpCode::GE_I:  case OpCode::GE_I_B:  emit_cmp_op(GE, is_b, true); break;
+
+            case OpCode::JUMP_IF_EQ_I:  case OpCode::JUMP_IF_EQ_I_B:  emit_fused_cmp_jump(E,  is_b, true); break;
+            case OpCode::JUMP_IF_NEQ_I: case OpCode::JUMP_IF_NEQ_I_B: emit_fused_cmp_jump(NE, is_b, true); break;
+            case OpCode::JUMP_IF_GT_I:  case OpCode::JUMP_IF_GT_I_B:  emit_fused_cmp_jump(G,  is_b, true); break;
+            case OpCode::JUMP_IF_GE_I:  case OpCode::JUMP_IF_GE_I_B:  emit_fused_cmp_jump(GE, is_b, true); break;
+            case OpCode::JUMP_IF_LT_I:  case OpCode::JUMP_IF_LT_I_B:  emit_fused_cmp_jump(L,  is_b, true); break;
+            case OpCode::JUMP_IF_LE_I:  case OpCode::JUMP_IF_LE_I_B:  emit_fused_cmp_jump(LE, is_b, true); break;
 
             case OpCode::JUMP: {
-                uint16_t off = read_u16();
-                size_t target = off;
+                size_t target = read_target();
                 if (bc_to_native_.count(target)) {
-                    size_t target_native = bc_to_native_[target];
+                    size_t target_native = native_target(insn_offset, target);
                     size_t current = asm_.cursor();
                     int32_t diff = (int32_t)(target_native - (current + 5));
                     asm_.jmp(diff);
                 } else {
-                    fixups_.push_back({asm_.cursor(), target, false});
+                    fixups_.push_back({asm_.cursor(), target, false, insn_offset});
                     asm_.jmp(0); 
                 }
                 break;
             }
-            case OpCode::JUMP_IF_FALSE: case OpCode::JUMP_IF_FALSE_B: {
-                bool is_b = (op == OpCode::JUMP_IF_FALSE_B);
-                uint16_t reg = is_b ? read_u8() : read_u16();
-                uint16_t off = read_u16();
-
-                Reg r = map_vm_reg(reg);
-                if (r == INVALID_REG) { load_vm_reg(RAX, reg); r = RAX; }
-
-                asm_.mov(RCX, VALUE_FALSE); asm_.cmp(r, RCX);
-                fixups_.push_back({asm_.cursor(), (size_t)off, true}); asm_.jcc(E, 0); 
-
-                asm_.mov(RCX, TAG_NULL); asm_.cmp(r, RCX);
-                fixups_.push_back({asm_.cursor(), (size_t)off, true}); asm_.jcc(E, 0); 
+            case OpCode::JUMP_IF_FALSE: case OpCode::JUMP_IF_FALSE_B: emit_truthy_jump(false, is_b); break;
+            case OpCode::JUMP_IF_TRUE:  case OpCode::JUMP_IF_TRUE_B:  emit_truthy_jump(true, is_b); break;
+
+            // Hàm đã inline: guard closure->proto_ rồi chạy tiếp vào thân callee ngay phía sau.
+            // Callee khác -> Interpreter gọi lại bằng CALL như thường (chưa có side effect nào).
+            case OpCode::CALL: case OpCode::CALL_VOID: {
+                const InlineSite& site = inlined_->sites[inlined_->call_sites.at(insn_offset)];
+                if (op == OpCode::CALL) read_u16();
+                uint16_t fn_reg = read_u16();
+
+                std::vector<size_t> guard_jumps;
+                Reg fn = use_reg(fn_reg, RAX);
+                asm_.mov(R8, fn); asm_.sar(R8, TAG_SHIFT);
+                asm_.mov(R9, TAG_OBJECT >> TAG_SHIFT); asm_.cmp(R8, R9);
+                guard_jumps.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+
+                asm_.mov(R8, fn); asm_.mov(R9, Layout::PAYLOAD_MASK); asm_.and_(R8, R9);
+                asm_.mov(R9, R8, OBJ_TYPE_OFFSET); asm_.movzx_b(R9, R9);
+                asm_.mov(RCX, (int64_t)meow::ObjectType::FUNCTION); asm_.cmp(R9, RCX);
+                guard_jumps.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+
+                asm_.mov(R9, R8, CLOSURE_PROTO_OFFSET);
+                asm_.mov(RCX, (int64_t)site.callee); asm_.cmp(R9, RCX);
+                guard_jumps.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+                deopt_exits_.push_back({std::move(guard_jumps), insn_offset, insn_idx});
+
+                // Closure chỉ cần khi phải dựng frame callee lúc deopt
+                asm_.mov(MEM_REG(site.closure_slot), fn);
                 break;
             }
-            case OpCode::JUMP_IF_TRUE: case OpCode::JUMP_IF_TRUE_B: {
-                bool is_b = (op == OpCode::JUMP_IF_TRUE_B);
-                uint16_t reg = is_b ? read_u8() : read_u16();
-                uint16_t off = read_u16();
-
-                Reg r = map_vm_reg(reg);
-                if (r == INVALID_REG) { load_vm_reg(RAX, reg); r = RAX; }
-
-                asm_.mov(RCX, VALUE_FALSE); asm_.cmp(r, RCX);
-                size_t skip1 = asm_.cursor(); asm_.jcc(E, 0);
 
-                asm_.mov(RCX, TAG_NULL); asm_.cmp(r, RCX);
-                size_t skip2 = asm_.cursor(); asm_.jcc(E, 0);
+            case OpCode::GET_PROP: emit_property_access(false); break;
+            case OpCode::SET_PROP: emit_property_access(true); break;
 
-                fixups_.push_back({asm_.cursor(), (size_t)off, false}); asm_.jmp(0); 
+            case OpCode::GET_INDEX: emit_index_access(false); break;
+            case OpCode::SET_INDEX: emit_index_access(true); break;
 
-                size_t next = asm_.cursor();
-                asm_.patch_u32(skip1 + 2, (int32_t)(next - (skip1 + 6)));
-                asm_.patch_u32(skip2 + 2, (int32_t)(next - (skip2 + 6)));
+            case OpCode::RETURN: {
+                uint16_t reg = read_u16();
+                if (reg == 0xFFFF) asm_.mov(RAX, (int64_t)TAG_NULL);
+                else load_vm_reg(RAX, reg);
+                asm_.mov(RDX, (int64_t)JIT_NO_DEOPT);
+                emit_epilogue();
                 break;
             }
-
-            case OpCode::RETURN: case OpCode::HALT:
+            case OpCode::HALT:
+                asm_.mov(RAX, (int64_t)TAG_NULL);
+                asm_.mov(RDX, (int64_t)JIT_NO_DEOPT);
                 emit_epilogue();
                 break;
 
             default: break;
         }
+
+        ip = next_ip;
+    }
+
+    // Cuối chunk là vùng đệm HALT (Chunk::finalize) -> trả về null
+    bc_to_native_[len] = asm_.cursor();
+    asm_.mov(RAX, (int64_t)TAG_NULL);
+    asm_.mov(RDX, (int64_t)JIT_NO_DEOPT);
+    emit_epilogue();
+
+    // --- Generate OSR Entries ---
+    // Prologue riêng nạp các register sống tại loop header rồi nhảy vào thân vòng lặp.
+    // Register mà tier speculative coi là int tại header phải được check lại:
+    // Interpreter không đảm bảo điều đó -> fail thì deopt ngay tại header.
+    std::sort(loop_headers_.begin(), loop_headers_.end());
+    loop_headers_.erase(std::unique(loop_headers_.begin(), loop_headers_.end()), loop_headers_.end());
+    for (size_t header : loop_headers_) {
+        if (!bc_to_native_.count(header)) continue; // Đích không hợp lệ, sẽ bị từ chối ở bước patch
+        // Loop nằm trong hàm được inline: Interpreter không bao giờ OSR vào đó
+        const InlineOrigin header_origin = origin_of(header);
+        if (header_origin.site >= 0) continue;
+        const size_t header_idx = ra_.index_of(header);
+        const size_t osr_start = asm_.cursor();
+
+        emit_prologue(header_idx);
+
+        // Vào giữa thân loop có guard (loop con): guard của loop ngoài chưa chạy lần nào
+        for (const auto& [outer, guard_pos] : loop_guards_) {
+            if (outer != header && bce_.in_loop(outer, header)) emit_loop_guards(*bce_.guards_at(outer), header, header_idx);
+        }
+
+        if (speculate_) {
+            std::vector<size_t> guard_jumps;
+            for (uint16_t r : spec_.known_ints(header_idx)) {
+                if (!ra_.is_live_in(header_idx, r)) continue;
+                Reg loc = map_vm_reg(r);
+                if (loc == INVALID_REG) { asm_.mov(RAX, MEM_REG(r)); loc = RAX; }
+                asm_.mov(R8, loc); asm_.sar(R8, TAG_SHIFT);
+                asm_.mov(R9, TAG_CHECK_VAL); asm_.cmp(R8, R9);
+                guard_jumps.push_back(asm_.cursor()); asm_.jcc(NE, 0);
+            }
+            if (!guard_jumps.empty()) deopt_exits_.push_back({std::move(guard_jumps), header, header_idx});
+        }
+
+        asm_.jmp((int32_t)(native_target(len, header) - (asm_.cursor() + 5))); // Vào từ ngoài loop: qua guard BCE
+        osr_entries_.push_back({header_origin.offset, osr_start});
     }
 
     // --- Generate Slow Paths ---
@@ -364,74 +1157,90 @@ JitFunc CodeGenerator::compile(const uint8_t* bytecode, size_t len) {
             asm_.patch_u32(jump_src + 2, off);
         }
 
-        flush_cached_regs();
+        // Dispatcher có thể cấp phát (GC): mọi register đang sống phải nằm ở home slot
+        const auto& live_in = ra_.live_in(sp.insn_idx);
+        const auto& live_out = ra_.live_out(sp.insn_idx);
+        spill_regs(live_in, false);
+        spill_regs(live_out, false);
 
-        asm_.mov(RAX, 8); asm_.sub(RSP, RAX); // Align Stack
+        // Sau 5 lần push trong prologue RSP lệch 8 byte so với 16
+        int32_t frame_adjust = sp.is_branch ? 24 : 8; // Branch cần thêm 1 slot tạm (giữ align 16)
+        asm_.mov(RAX, frame_adjust); asm_.sub(RSP, RAX);
 
-        bool is_fused_jump = (sp.op >= static_cast<int>(OpCode::JUMP_IF_EQ) && 
-                              sp.op <= static_cast<int>(OpCode::JUMP_IF_LE));
+        // Đọc tham số từ home slot (RSI/RDX có thể đang giữ VM register khác)
+        asm_.mov(RDI, (int64_t)sp.op);    
+        asm_.mov(RSI, MEM_REG(sp.src1_reg_idx)); 
+        if (sp.src2_is_imm) asm_.mov(RDX, (int64_t)sp.src2_imm);
+        else asm_.mov(RDX, MEM_REG(sp.src2_reg_idx)); 
 
-        asm_.mov(RDI, (uint64_t)sp.op);    
-        load_vm_reg(RSI, sp.src1_reg_idx); 
-        load_vm_reg(RDX, sp.src2_reg_idx); 
-
-        if (is_fused_jump) {
-            // FIXED: Dùng RCX làm temp để trừ RSP
-            asm_.mov(RCX, 8);
-            asm_.sub(RSP, RCX); 
-            
+        if (sp.is_branch) {
             asm_.mov(RCX, RSP);  // Arg4: Address of temp slot
-            
-            asm_.mov(RAX, (uint64_t)&runtime::compare_generic);
+            emit_stub_address(RAX, RuntimeStub::COMPARE);
             asm_.call(RAX);
 
-            // FIXED: Dùng mov(dst, base, disp) thay vì MEM_REG_PTR
             asm_.mov(RAX, RSP, 0);
+            asm_.mov(RCX, frame_adjust); asm_.add(RSP, RCX);
+            reload_regs(live_out, false);
 
-            // FIXED: Dùng RCX làm temp để cộng RSP
-            asm_.mov(RCX, 8);    
-            asm_.add(RSP, RCX);
-
-            // Check if True (TAG_BOOL | 1)
-            asm_.mov(RCX, TAG_BOOL | 1);
+            asm_.mov(RCX, VALUE_TRUE);
             asm_.cmp(RAX, RCX);
-
-            // Restore Stack Alignment trước khi Jump
-            asm_.mov(RCX, 8); asm_.add(RSP, RCX); 
-            reload_cached_regs();
-
-            fixups_.push_back({asm_.cursor(), (size_t)sp.dst_reg_idx, true});
+            fixups_.push_back({asm_.cursor(), sp.target_bc, true, sp.bc_offset});
             asm_.jcc(E, 0); 
         } 
         else {
-            // Standard Op
+            // Standard Op: ghi kết quả thẳng vào regs[dst]
             asm_.mov(RCX, REG_VM_REGS_BASE);
             asm_.mov(RAX, sp.dst_reg_idx * 8);
             asm_.add(RCX, RAX); 
 
-            if (sp.op >= static_cast<int>(OpCode::EQ)) asm_.mov(RAX, (uint64_t)&runtime::compare_generic);
-            else asm_.mov(RAX, (uint64_t)&runtime::binary_op_generic);
+            OpCode base = static_cast<OpCode>(sp.op);
+            bool is_cmp = (base == OpCode::EQ || base == OpCode::NEQ || base == OpCode::LT ||
+                           base == OpCode::LE || base == OpCode::GT  || base == OpCode::GE);
+            if (is_cmp) emit_stub_address(RAX, RuntimeStub::COMPARE);
+            else emit_stub_address(RAX, RuntimeStub::BINARY_OP);
             asm_.call(RAX);
             
-            asm_.mov(RAX, 8); asm_.add(RSP, RAX); 
-            reload_cached_regs();
-
-            Reg mapped_dst = map_vm_reg(sp.dst_reg_idx);
-            if (mapped_dst != INVALID_REG) asm_.mov(mapped_dst, MEM_REG(sp.dst_reg_idx));
+            asm_.mov(RAX, frame_adjust); asm_.add(RSP, RAX); 
+            reload_regs(live_out, false);
+            if (map_vm_reg(sp.dst_reg_idx) != INVALID_REG) {
+                asm_.mov(map_vm_reg(sp.dst_reg_idx), MEM_REG(sp.dst_reg_idx));
+            }
         }
 
-        size_t jump_back_target = sp.patch_jump_over + 5; 
-        int32_t back_off = (int32_t)(jump_back_target - (asm_.cursor() + 5));
+        int32_t back_off = (int32_t)(sp.resume_at - (asm_.cursor() + 5));
         asm_.jmp(back_off);
     }
 
+    // --- Generate Inline Cache Stubs ---
+    for (auto& pic : prop_ics_) emit_property_ic_stubs(pic);
+    for (auto& access : index_ops_) emit_index_stubs(access);
+
+    // --- Generate Deopt Exits ---
+    // Guard đặt trước mọi side effect của lệnh -> Interpreter chạy lại nguyên lệnh.
+    // Chỉ cần đưa các register đang sống trong CPU về home slot; CallFrame/ip_ của frame
+    // hiện tại vẫn do Interpreter quản lý (mã JIT chạy ngay trên frame đó).
+    for (auto& d : deopt_exits_) {
+        size_t exit_start = asm_.cursor();
+        for (size_t jump_src : d.jumps_to_here) {
+            asm_.patch_u32(jump_src + 2, (int32_t)(exit_start - (jump_src + 6)));
+        }
+
+        spill_regs(ra_.live_in(d.insn_idx), false);
+        emit_deopt_result(d.bc_offset);
+        emit_epilogue();
+    }
+
     // --- Patch Forward Jumps ---
     for (const auto& fix : fixups_) {
         if (bc_to_native_.count(fix.target_bc)) {
-            size_t target_native = bc_to_native_[fix.target_bc];
+            size_t target_native = native_target(fix.from_bc, fix.target_bc);
             size_t jump_len = fix.is_cond ? 6 : 5;
             int32_t rel = (int32_t)(target_native - (fix.jump_op_pos + jump_len));
             asm_.patch_u32(fix.jump_op_pos + (fix.is_cond ? 2 : 1), rel);
+        } else {
+            // Đích nhảy không phải đầu lệnh hợp lệ -> không an toàn để chạy
+            if (JIT_DEBUG_LOG) std::cerr << "[JIT] Reject: bad jump target " << fix.target_bc << std::endl;
+            return nullptr;
         }
     }
 
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "jit_compiler.h"
+#include "inliner.h"
+#include "relocation.h"
 #include "x64/assembler.h"
 #include "x64/common.h"
+#include "x64/register_allocator.h"
+#include "x64/type_speculation.h"
+#include "x64/bounds_check_elimination.h"
+#include "meow/bytecode/op_codes.h"
 #include <vector>
 #include <unordered_map>
 
@@ -12,17 +18,66 @@ struct Fixup {
     size_t jump_op_pos; // Vị trí ghi opcode nhảy
     size_t target_bc;   // Bytecode đích đến
     bool is_cond;       // Là nhảy có điều kiện? (JCC) hay không (JMP)
+    size_t from_bc;     // Lệnh chứa lệnh nhảy (từ ngoài loop có guard -> nhảy vào guard)
 };
 
 struct SlowPath {
-    size_t label_start;           // Địa chỉ bắt đầu sinh mã slow path
     std::vector<size_t> jumps_to_here; // Các chỗ cần patch để nhảy vào đây
-    size_t patch_jump_over;       // Chỗ cần nhảy về sau khi xong (Fast path end)
+    size_t resume_at;             // Native offset cần nhảy về sau khi xong (Fast path end)
     
-    int op;           // Opcode gốc
+    int op;           // Opcode gốc (đã bỏ hậu tố _B / JUMP_IF_)
     int dst_reg_idx;  // VM Register index
     int src1_reg_idx;
     int src2_reg_idx;
+    bool src2_is_imm;     // Opcode _I: vế phải là hằng (src2_reg_idx bỏ qua)
+    uint64_t src2_imm;    // Value int đã box
+    bool is_branch;   // Fused Compare & Jump: nhảy tới target_bc nếu kết quả true
+    size_t target_bc;
+    size_t insn_idx;  // Chỉ số lệnh (tra liveness để spill/reload)
+    size_t bc_offset;
+};
+
+// Guard speculative fail -> ghi register về VM stack rồi thoát với bytecode offset
+struct DeoptExit {
+    std::vector<size_t> jumps_to_here;
+    size_t bc_offset; // Interpreter chạy lại từ đầu lệnh này
+    size_t insn_idx;
+};
+
+// Inline Cache của GET_PROP/SET_PROP: shape đầu tiên (seed từ IC trong bytecode) so sánh inline,
+// các shape còn lại nằm trong stub polymorphic ngoài luồng; không khớp -> miss handler ở runtime
+struct PropertyIC {
+    bool is_set;
+    uint16_t obj_reg;
+    uint16_t val_reg;   // GET: register đích, SET: register giá trị
+    uint16_t name_idx;
+    const void* ic;     // InlineCache trong bytecode (miss handler cập nhật tại chỗ)
+    size_t bc_offset;
+    size_t insn_idx;
+
+    std::vector<std::pair<size_t, bool>> miss_jumps; // {vị trí lệnh nhảy, is_cond}
+    size_t poly_jump = 0;                            // jne từ fast path sang stub polymorphic
+    std::vector<std::pair<uint64_t, uint32_t>> poly_shapes; // {shape, offset} ngoài shape inline
+    size_t join = 0;                                 // Đọc/ghi field: R8 = object, RCX = offset * 8
+    size_t barrier_jump = 0;                         // SET: giá trị là object -> write barrier
+    Reg barrier_val = INVALID_REG;
+    size_t resume_at = 0;
+};
+
+// GET_INDEX dst, arr, key / SET_INDEX arr, key, val: fast path array + index int trong biên,
+// còn lại (ngoài biên, hash table...) đi miss handler ở runtime. Site đã hoist check: không có miss.
+struct IndexAccess {
+    bool is_set;
+    uint16_t obj_reg;
+    uint16_t key_reg;
+    uint16_t val_reg;   // GET: register đích, SET: register giá trị
+    size_t bc_offset;
+    size_t insn_idx;
+
+    std::vector<std::pair<size_t, bool>> miss_jumps; // {vị trí lệnh nhảy, is_cond}
+    size_t barrier_jump = 0;                         // SET: giá trị là object -> write barrier (R8 = array)
+    Reg barrier_val = INVALID_REG;
+    size_t resume_at = 0;
 };
 
 class CodeGenerator {
@@ -30,7 +85,34 @@ public:
     CodeGenerator(uint8_t* buffer, size_t capacity);
     
     // Compile bytecode -> trả về con trỏ hàm JIT
-    JitFunc compile(const uint8_t* bytecode, size_t len);
+    // Trả về nullptr nếu bytecode chứa opcode mà backend chưa hỗ trợ
+    // speculate: số học/so sánh giả định int và deopt khi sai (trừ các site trong failed_sites)
+    // inlined: bytecode là InlinedCode::code (offset deopt/OSR được đổi về chunk gốc)
+    JitFunc compile(const uint8_t* bytecode, size_t len, bool speculate = false,
+                    const std::vector<uint32_t>& failed_sites = {},
+                    const InlinedCode* inlined = nullptr);
+
+    // Kích thước chính xác của mã vừa sinh (bytes)
+    size_t code_size() const { return asm_.cursor(); }
+
+    // Điểm vào OSR (mỗi loop header = đích của một lệnh nhảy ngược)
+    const std::vector<OsrEntry>& osr_entries() const { return osr_entries_; }
+    bool overflowed() const { return asm_.overflowed(); }
+
+    // Mã relocatable (AOT image): không seed shape từ InlineCache
+    void set_relocatable(bool relocatable) { relocatable_ = relocatable; }
+
+    // Mọi ô imm64 phụ thuộc process (kể cả khi không relocatable: compile nền chạy trên bản chụp bytecode)
+    const std::vector<Relocation>& relocs() const { return relocs_; }
+
+    // Native offset -> bytecode offset của chunk gốc (lệnh inline quy về lệnh CALL), tăng dần theo native
+    std::vector<LineEntry> line_table() const;
+
+    // Backend có sinh được mã cho opcode này không?
+    static bool is_supported(OpCode op);
+
+    // Băm các hằng số layout (tag, offset field) nhúng trong mã: AOT image của bản build khác bị bỏ qua
+    static uint64_t abi_fingerprint();
 
 private:
     Assembler asm_;
@@ -44,18 +126,67 @@ private:
     // Danh sách Slow Paths (sinh mã ở cuối buffer)
     std::vector<SlowPath> slow_paths_;
 
+    // Inline Cache cho truy cập thuộc tính
+    std::vector<PropertyIC> prop_ics_;
+
+    // Truy cập phần tử array/hash
+    std::vector<IndexAccess> index_ops_;
+
+    // Vòng lặp đếm: check của GET_INDEX/SET_INDEX gom về guard ở loop header
+    BoundsCheckElimination bce_;
+    std::unordered_map<size_t, size_t> loop_guards_; // Header -> native offset của guard (trước bc_to_native_[header])
+    size_t native_target(size_t from_bc, size_t target_bc);
+    // Guard fail -> deopt tại deopt_bc (header, hoặc loop con khi OSR vào giữa loop có guard)
+    void emit_loop_guards(const std::vector<LoopGuard>& guards, size_t deopt_bc, size_t insn_idx);
+
+    // Tier speculative: điểm thoát về Interpreter
+    bool speculate_ = false;
+    TypeSpeculation spec_;
+    std::vector<DeoptExit> deopt_exits_;
+
+    // OSR: Interpreter chuyển frame đang chạy vào giữa vòng lặp
+    std::vector<size_t> loop_headers_;
+    std::vector<OsrEntry> osr_entries_;
+
+    // Ô imm64 phụ thuộc process (địa chỉ runtime stub, InlineCache trong bytecode)
+    bool relocatable_ = false;
+    std::vector<Relocation> relocs_;
+    void emit_stub_address(Reg dst, RuntimeStub stub);
+    void emit_bytecode_address(Reg dst, size_t bc_offset, const void* ptr);
+
+    // Hàm được inline (nullptr: bytecode là chunk gốc)
+    const uint8_t* bytecode_ = nullptr;
+    const InlinedCode* inlined_ = nullptr;
+    InlineOrigin origin_of(size_t bc_offset) const;
+    const uint8_t* source_of(size_t bc_offset) const;
+
     // --- Helpers ---
-    void emit_prologue();
+    // Prologue nạp các register sống tại lệnh thứ insn_idx (0 = entry thường, khác = OSR)
+    void emit_prologue(size_t insn_idx = 0);
     void emit_epilogue();
 
-    // Register Allocator đơn giản (Map VM Reg -> CPU Reg)
+    // Stub ngoài luồng của PropertyIC (polymorphic, write barrier, miss handler)
+    void emit_property_ic_stubs(PropertyIC& pic);
+    void emit_index_stubs(IndexAccess& access);
+    // Gọi write barrier cho owner R8 rồi quay về resume_at (không cấp phát -> chỉ giữ caller-saved còn sống)
+    void emit_write_barrier_stub(size_t jump_pos, size_t insn_idx, Reg val, size_t resume_at);
+    void patch_jump(size_t pos, bool is_cond, size_t target);
+
+    // Constant của lệnh tại bc_offset (lệnh của callee -> nhúng giá trị từ constant pool của callee)
+    void emit_load_const(Reg dst, size_t bc_offset, uint16_t idx);
+    // RAX:RDX cho lần thoát về Interpreter tại lệnh bc_offset (lệnh của callee -> JIT_INLINE_DEOPT)
+    void emit_deopt_result(size_t bc_offset);
+
+    // Linear Scan: VM Reg -> CPU Reg (INVALID_REG = ở home slot trên VM stack)
+    RegisterAllocator ra_;
     Reg map_vm_reg(int vm_reg) const;
     void load_vm_reg(Reg cpu_dst, int vm_src);
     void store_vm_reg(int vm_dst, Reg cpu_src);
 
-    // [MỚI] Đồng bộ trạng thái VM State (QUAN TRỌNG)
-    void flush_cached_regs();
-    void reload_cached_regs();
+    // Đồng bộ VM register đang nằm trong CPU register với home slot quanh lời gọi runtime
+    // (only_caller_saved: chỉ các thanh ghi bị lời gọi C phá)
+    void spill_regs(const std::vector<uint16_t>& vm_regs, bool only_caller_saved);
+    void reload_regs(const std::vector<uint16_t>& vm_regs, bool only_caller_saved);
 };
 
 } // namespace meow::jit::x64
\ No newline at end of file
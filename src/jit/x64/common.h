@@ -18,6 +18,12 @@ namespace meow::jit::x64 {
         INVALID_REG = 0xFF
     };
 
+    // --- SSE2 Registers (scratch cho số học double, không giữ giá trị qua lệnh bytecode) ---
+    enum Xmm : uint8_t {
+        XMM0 = 0, XMM1 = 1, XMM2 = 2,  XMM3 = 3,
+        XMM4 = 4, XMM5 = 5, XMM6 = 6,  XMM7 = 7
+    };
+
     // --- CPU Condition Codes (EFLAGS) ---
     enum Condition : uint8_t {
         O  = 0,  NO = 1,  // Overflow
@@ -0,0 +1,96 @@
+#include "x64/register_allocator.h"
+#include <algorithm>
+
+namespace meow::jit::x64 {
+
+void RegisterAllocator::run(const uint8_t* bytecode, size_t len) {
+    assignment_.clear();
+    live_in_.clear();
+    live_out_.clear();
+    intervals_.clear();
+
+    analysis::DecodedCode code = analysis::decode(bytecode, len);
+    const auto& insns = code.insns;
+    const uint16_t num_regs = code.num_regs;
+    const size_t n = insns.size();
+    index_of_ = std::move(code.index_of);
+
+    // 1. Liveness
+    liveness_.emplace(insns, num_regs);
+    const analysis::Liveness& live = *liveness_;
+
+    // 2. Live interval: [vị trí sống đầu tiên, vị trí sống cuối cùng]
+    constexpr size_t NONE = static_cast<size_t>(-1);
+    std::vector<size_t> start(num_regs, NONE), end(num_regs, 0);
+    auto touch = [&](uint16_t r, size_t pos) {
+        if (start[r] == NONE || pos < start[r]) start[r] = pos;
+        if (pos > end[r]) end[r] = pos;
+    };
+
+    for (size_t k = 0; k < n; ++k) {
+        for (uint16_t r = 0; r < num_regs; ++r) {
+            if (live.is_live_in(k, r) || live.is_live_out(k, r)) touch(r, k);
+        }
+        if (insns[k].def >= 0) touch(static_cast<uint16_t>(insns[k].def), k);
+    }
+
+    for (uint16_t r = 0; r < num_regs; ++r) {
+        if (start[r] != NONE) intervals_.push_back({r, start[r], end[r]});
+    }
+    std::sort(intervals_.begin(), intervals_.end(), [](const LiveInterval& a, const LiveInterval& b) {
+        return a.start < b.start || (a.start == b.start && a.vm_reg < b.vm_reg);
+    });
+
+    // 3. Linear Scan: ưu tiên callee-saved (không phải lưu quanh lời gọi runtime)
+    assignment_.assign(num_regs, INVALID_REG);
+
+    std::vector<Reg> free_regs;
+    for (Reg r : CALLER_SAVED) free_regs.push_back(r);
+    for (Reg r : CALLEE_SAVED) free_regs.push_back(r); // pop_back() lấy callee-saved trước
+
+    std::vector<const LiveInterval*> active; // Sắp theo end tăng dần
+
+    for (const LiveInterval& cur : intervals_) {
+        // Expire các interval đã kết thúc trước điểm bắt đầu hiện tại
+        while (!active.empty() && active.front()->end < cur.start) {
+            free_regs.push_back(assignment_[active.front()->vm_reg]);
+            active.erase(active.begin());
+        }
+
+        auto insert_active = [&](const LiveInterval* iv) {
+            auto pos = std::upper_bound(active.begin(), active.end(), iv,
+                [](const LiveInterval* a, const LiveInterval* b) { return a->end < b->end; });
+            active.insert(pos, iv);
+        };
+
+        if (!free_regs.empty()) {
+            assignment_[cur.vm_reg] = free_regs.back();
+            free_regs.pop_back();
+            insert_active(&cur);
+            continue;
+        }
+
+        // Hết thanh ghi: spill interval kết thúc muộn nhất
+        const LiveInterval* spill = active.back();
+        if (spill->end > cur.end) {
+            assignment_[cur.vm_reg] = assignment_[spill->vm_reg];
+            assignment_[spill->vm_reg] = INVALID_REG;
+            active.pop_back();
+            insert_active(&cur);
+        }
+        // Ngược lại cur nằm ở spill slot (home của chính VM register)
+    }
+
+    // 4. Chỉ giữ các register được cấp CPU register (dùng cho spill/reload quanh lời gọi)
+    live_in_.resize(n + 1);
+    live_out_.resize(n + 1);
+    for (size_t k = 0; k < n; ++k) {
+        for (uint16_t r = 0; r < num_regs; ++r) {
+            if (assignment_[r] == INVALID_REG) continue;
+            if (live.is_live_in(k, r)) live_in_[k].push_back(r);
+            if (live.is_live_out(k, r)) live_out_[k].push_back(r);
+        }
+    }
+}
+
+} // namespace meow::jit::x64
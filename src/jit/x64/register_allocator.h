@@ -0,0 +1,70 @@
+/**
+ * @file register_allocator.h
+ * @brief Linear Scan Register Allocator (Poletto & Sarkar) cho x64 backend
+ */
+
+#pragma once
+
+#include "x64/common.h"
+#include "analysis/bytecode_analysis.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <unordered_map>
+
+namespace meow::jit::x64 {
+
+    // Khoảng sống của một VM register, tính theo chỉ số lệnh (không có "lỗ")
+    struct LiveInterval {
+        uint16_t vm_reg;
+        size_t start;
+        size_t end;
+    };
+
+    class RegisterAllocator {
+    public:
+        // Thanh ghi dùng để cấp phát (R14/R15 giữ base, RAX/RCX/R8/R9 làm scratch cho template)
+        static constexpr Reg CALLEE_SAVED[] = { RBX, R12, R13 };
+        static constexpr Reg CALLER_SAVED[] = { RSI, RDI, RDX, R10, R11 };
+
+        static bool is_caller_saved(Reg r) {
+            for (Reg c : CALLER_SAVED) if (c == r) return true;
+            return false;
+        }
+
+        /**
+         * @brief Tính liveness trên bytecode và cấp phát thanh ghi.
+         * Bytecode phải chỉ chứa opcode CodeGenerator hỗ trợ.
+         */
+        void run(const uint8_t* bytecode, size_t len);
+
+        // VM register -> CPU register. INVALID_REG = nằm ở spill slot (home [R14 + idx*8])
+        Reg location(uint16_t vm_reg) const {
+            return vm_reg < assignment_.size() ? assignment_[vm_reg] : INVALID_REG;
+        }
+
+        // Chỉ số lệnh tại bytecode offset
+        size_t index_of(size_t bc_offset) const { return index_of_.at(bc_offset); }
+
+        // Các VM register đã được cấp CPU register và còn sống trước/sau lệnh
+        const std::vector<uint16_t>& live_in(size_t insn) const { return live_in_[insn]; }
+        const std::vector<uint16_t>& live_out(size_t insn) const { return live_out_[insn]; }
+
+        // Liveness đầy đủ (kể cả register nằm ở spill slot)
+        bool is_live_in(size_t insn, uint16_t vm_reg) const {
+            return liveness_ && liveness_->is_live_in(insn, vm_reg);
+        }
+
+        const std::vector<LiveInterval>& intervals() const { return intervals_; }
+
+    private:
+        std::vector<Reg> assignment_;
+        std::unordered_map<size_t, size_t> index_of_;
+        std::vector<std::vector<uint16_t>> live_in_;
+        std::vector<std::vector<uint16_t>> live_out_;
+        std::optional<analysis::Liveness> liveness_;
+        std::vector<LiveInterval> intervals_;
+    };
+
+} // namespace meow::jit::x64
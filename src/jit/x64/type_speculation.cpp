@@ -0,0 +1,136 @@
+#include "x64/type_speculation.h"
+#include "analysis/bytecode_analysis.h"
+#include <algorithm>
+
+namespace meow::jit::x64 {
+
+namespace {
+
+    enum class SiteKind { NONE, ARITH, DIV, COMPARE, BRANCH };
+
+    SiteKind classify(OpCode op) {
+        switch (op) {
+            case OpCode::ADD: case OpCode::ADD_B:
+            case OpCode::SUB: case OpCode::SUB_B:
+            case OpCode::MUL: case OpCode::MUL_B:
+            case OpCode::ADD_I: case OpCode::ADD_I_B:
+            case OpCode::SUB_I: case OpCode::SUB_I_B:
+            case OpCode::MUL_I: case OpCode::MUL_I_B:
+                return SiteKind::ARITH;
+            case OpCode::DIV: case OpCode::DIV_B:
+                return SiteKind::DIV;
+            case OpCode::EQ: case OpCode::EQ_B: case OpCode::NEQ: case OpCode::NEQ_B:
+            case OpCode::LT: case OpCode::LT_B: case OpCode::LE:  case OpCode::LE_B:
+            case OpCode::GT: case OpCode::GT_B: case OpCode::GE:  case OpCode::GE_B:
+            case OpCode::EQ_I: case OpCode::EQ_I_B: case OpCode::NEQ_I: case OpCode::NEQ_I_B:
+            case OpCode::LT_I: case OpCode::LT_I_B: case OpCode::LE_I:  case OpCode::LE_I_B:
+            case OpCode::GT_I: case OpCode::GT_I_B: case OpCode::GE_I:  case OpCode::GE_I_B:
+                return SiteKind::COMPARE;
+            case OpCode::JUMP_IF_EQ: case OpCode::JUMP_IF_EQ_B: case OpCode::JUMP_IF_NEQ: case OpCode::JUMP_IF_NEQ_B:
+            case OpCode::JUMP_IF_LT: case OpCode::JUMP_IF_LT_B: case OpCode::JUMP_IF_LE:  case OpCode::JUMP_IF_LE_B:
+            case OpCode::JUMP_IF_GT: case OpCode::JUMP_IF_GT_B: case OpCode::JUMP_IF_GE:  case OpCode::JUMP_IF_GE_B:
+            case OpCode::JUMP_IF_EQ_I: case OpCode::JUMP_IF_EQ_I_B: case OpCode::JUMP_IF_NEQ_I: case OpCode::JUMP_IF_NEQ_I_B:
+            case OpCode::JUMP_IF_LT_I: case OpCode::JUMP_IF_LT_I_B: case OpCode::JUMP_IF_LE_I:  case OpCode::JUMP_IF_LE_I_B:
+            case OpCode::JUMP_IF_GT_I: case OpCode::JUMP_IF_GT_I_B: case OpCode::JUMP_IF_GE_I:  case OpCode::JUMP_IF_GE_I_B:
+                return SiteKind::BRANCH;
+            default:
+                return SiteKind::NONE;
+        }
+    }
+
+    using Kinds = std::vector<uint8_t>;
+
+    bool is_number(uint8_t k) { return k == TypeSpeculation::INT || k == TypeSpeculation::FLOAT; }
+
+    // Kiểu của mọi register trước mỗi lệnh với tập site speculate cho trước
+    std::vector<Kinds> solve(const std::vector<analysis::Instruction>& insns, uint16_t num_regs,
+                             const std::unordered_set<size_t>& speculated) {
+        const size_t n = insns.size();
+        std::vector<Kinds> in(n, Kinds(num_regs, TypeSpeculation::UNKNOWN));
+        std::vector<bool> reached(n, false);
+        if (n > 0) reached[0] = true;
+
+        auto transfer = [&](const analysis::Instruction& insn, Kinds state) {
+            const bool spec = speculated.count(insn.offset) != 0;
+            if (spec) {
+                for (uint16_t r : insn.uses) state[r] = TypeSpeculation::INT; // Qua được guard
+            }
+            if (insn.def >= 0) {
+                uint8_t def = TypeSpeculation::UNKNOWN;
+                const SiteKind site = classify(insn.op);
+                if (insn.op == OpCode::LOAD_INT || insn.op == OpCode::LOAD_INT_B) def = TypeSpeculation::INT;
+                else if (insn.op == OpCode::LOAD_FLOAT || insn.op == OpCode::LOAD_FLOAT_B) def = TypeSpeculation::FLOAT;
+                else if (insn.op == OpCode::MOVE || insn.op == OpCode::MOVE_B) def = state[insn.uses[0]];
+                else if (spec && site == SiteKind::ARITH) def = TypeSpeculation::INT;
+                else if ((site == SiteKind::ARITH || site == SiteKind::DIV) && !insn.uses.empty()) {
+                    // ADD_I...: chỉ một use, vế phải là hằng int
+                    const uint8_t a = state[insn.uses[0]];
+                    const uint8_t b = insn.uses.size() == 2 ? state[insn.uses[1]] : TypeSpeculation::INT;
+                    // int (+) float -> float; DIV trên hai số luôn ra float
+                    if (is_number(a) && is_number(b) &&
+                        (site == SiteKind::DIV || a == TypeSpeculation::FLOAT || b == TypeSpeculation::FLOAT)) {
+                        def = TypeSpeculation::FLOAT;
+                    }
+                }
+                state[insn.def] = def;
+            }
+            return state;
+        };
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t k = 0; k < n; ++k) {
+                if (!reached[k]) continue;
+                Kinds out = transfer(insns[k], in[k]);
+
+                for (size_t j : insns[k].succs) {
+                    if (j >= n) continue;
+
+                    Kinds merged = reached[j] ? in[j] : out;
+                    for (uint16_t r = 0; r < num_regs; ++r) {
+                        if (merged[r] != out[r]) merged[r] = TypeSpeculation::UNKNOWN;
+                    }
+                    if (j == 0) std::fill(merged.begin(), merged.end(), TypeSpeculation::UNKNOWN); // Entry luôn không biết gì
+
+                    if (!reached[j] || merged != in[j]) {
+                        in[j] = std::move(merged);
+                        reached[j] = true;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return in;
+    }
+
+} // namespace
+
+void TypeSpeculation::run(const uint8_t* bytecode, size_t len, const std::vector<uint32_t>& failed_sites,
+                          bool speculate) {
+    speculated_.clear();
+    known_.clear();
+
+    const analysis::DecodedCode code = analysis::decode(bytecode, len);
+    const auto& insns = code.insns;
+
+    if (speculate) {
+        // Lượt đầu (chưa speculate) tìm operand chắc chắn là float: site đó speculate int chỉ tổ deopt
+        const std::vector<Kinds> proven = solve(insns, code.num_regs, speculated_);
+        for (size_t k = 0; k < insns.size(); ++k) {
+            const auto& insn = insns[k];
+            const SiteKind site = classify(insn.op);
+            if (site == SiteKind::NONE || site == SiteKind::DIV) continue;
+            if (std::find(failed_sites.begin(), failed_sites.end(), insn.offset) != failed_sites.end()) continue;
+            if (std::any_of(insn.uses.begin(), insn.uses.end(),
+                            [&](uint16_t r) { return proven[k][r] == FLOAT; })) continue;
+            speculated_.insert(insn.offset);
+        }
+    }
+
+    // Lệnh không đến được: không biết gì (vector đã khởi tạo UNKNOWN)
+    known_ = solve(insns, code.num_regs, speculated_);
+    known_.emplace_back(); // Vùng đệm HALT cuối chunk
+}
+
+} // namespace meow::jit::x64
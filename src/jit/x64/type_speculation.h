@@ -0,0 +1,63 @@
+/**
+ * @file type_speculation.h
+ * @brief Phân tích kiểu cho JIT: VM register nào chắc chắn là int / float tại mỗi lệnh
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace meow::jit::x64 {
+
+    /**
+     * @brief Forward dataflow (giao tại điểm hợp nhất).
+     * Lệnh số học/so sánh được speculate sẽ deopt nếu operand không phải int,
+     * nên sau lệnh đó các operand (và kết quả ADD/SUB/MUL) được coi là int.
+     * Nhờ vậy guard chỉ còn ở lần đầu thấy register, không lặp lại trong loop.
+     *
+     * Float được suy ra không cần speculate: LOAD_FLOAT, MOVE, và ADD/SUB/MUL/DIV
+     * trên hai số mà ít nhất một là float (DIV: luôn float). Site có operand float
+     * không bị speculate int (chắc chắn deopt), CodeGenerator đi thẳng fast path double.
+     * Float chỉ là gợi ý bố trí mã: kết quả inf/NaN từ slow path không còn là float
+     * trong NaN-boxing nên fast path double vẫn luôn check exponent.
+     */
+    class TypeSpeculation {
+    public:
+        enum Kind : uint8_t { UNKNOWN = 0, INT, FLOAT };
+
+        // failed_sites: bytecode offset đã từng deopt -> không speculate lại
+        // speculate = false: chỉ suy kiểu chắc chắn (tier generic)
+        void run(const uint8_t* bytecode, size_t len, const std::vector<uint32_t>& failed_sites,
+                 bool speculate = true);
+
+        // Lệnh tại bytecode offset có được speculate (guard -> deopt) không
+        bool speculates(size_t bc_offset) const { return speculated_.count(bc_offset) != 0; }
+
+        Kind kind(size_t insn, uint16_t vm_reg) const {
+            const auto& kinds = known_[insn];
+            return vm_reg < kinds.size() ? static_cast<Kind>(kinds[vm_reg]) : UNKNOWN;
+        }
+
+        // VM register chắc chắn là int trước lệnh thứ insn (bỏ được tag check)
+        bool is_int(size_t insn, uint16_t vm_reg) const { return kind(insn, vm_reg) == INT; }
+
+        // VM register được ghi bởi lệnh sinh float trước lệnh thứ insn (không thử fast path int)
+        bool is_float(size_t insn, uint16_t vm_reg) const { return kind(insn, vm_reg) == FLOAT; }
+
+        // Các VM register chắc chắn là int trước lệnh thứ insn
+        std::vector<uint16_t> known_ints(size_t insn) const {
+            std::vector<uint16_t> regs;
+            const auto& kinds = known_[insn];
+            for (size_t r = 0; r < kinds.size(); ++r) if (kinds[r] == INT) regs.push_back(static_cast<uint16_t>(r));
+            return regs;
+        }
+
+    private:
+        std::unordered_set<size_t> speculated_;
+        std::vector<std::vector<uint8_t>> known_;
+    };
+
+} // namespace meow::jit::x64
@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "memory/background_finalizer.h"
+#include <meow/core/meow_object.h>
+
+namespace meow {
+
+BackgroundFinalizer::BackgroundFinalizer() : thread_(&BackgroundFinalizer::thread_main, this) {}
+
+BackgroundFinalizer::~BackgroundFinalizer() noexcept {
+    shutdown();
+}
+
+void BackgroundFinalizer::shutdown() noexcept {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void BackgroundFinalizer::submit(std::vector<ObjectMeta*>& batch) {
+    {
+        std::lock_guard lock(mutex_);
+        pending_.insert(pending_.end(), batch.begin(), batch.end());
+    }
+    batch.clear();
+    wake_.notify_one();
+}
+
+void BackgroundFinalizer::reclaim(heap& h) {
+    std::vector<ObjectMeta*> done;
+    {
+        std::lock_guard lock(mutex_);
+        if (finished_.empty()) return;
+        done.swap(finished_);
+    }
+    for (ObjectMeta* meta : done) {
+        h.deallocate_raw(meta, sizeof(ObjectMeta) + meta->size);
+    }
+}
+
+void BackgroundFinalizer::thread_main() {
+    std::vector<ObjectMeta*> batch;
+    for (;;) {
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || !pending_.empty(); });
+            if (pending_.empty()) return;  // stop_ và đã hết việc
+            batch.swap(pending_);
+        }
+
+        for (ObjectMeta* meta : batch) {
+            std::destroy_at(static_cast<MeowObject*>(heap::get_data(meta)));
+        }
+
+        std::lock_guard lock(mutex_);
+        finished_.insert(finished_.end(), batch.begin(), batch.end());
+        batch.clear();
+    }
+}
+
+}
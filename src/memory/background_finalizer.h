@@ -0,0 +1,41 @@
+#pragma once
+
+#include "pch.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "meow_heap.h"
+
+namespace meow {
+
+// Gọi destructor của object old đã chết trên thread nền (free() buffer vector là phần tốn nhất của sweep).
+// Heap không thread-safe nên block nhớ quay về thread VM rồi mới vào free-list qua reclaim().
+class BackgroundFinalizer {
+public:
+    BackgroundFinalizer();
+    ~BackgroundFinalizer() noexcept;
+
+    BackgroundFinalizer(const BackgroundFinalizer&) = delete;
+    BackgroundFinalizer& operator=(const BackgroundFinalizer&) = delete;
+
+    // Nhận cả lô (batch bị làm rỗng)
+    void submit(std::vector<ObjectMeta*>& batch);
+
+    // Trả các block đã chạy xong destructor về free-list, gọi trên thread VM
+    void reclaim(heap& h);
+
+    // Chạy nốt hàng đợi rồi dừng thread
+    void shutdown() noexcept;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<ObjectMeta*> pending_;
+    std::vector<ObjectMeta*> finished_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    void thread_main();
+};
+}
@@ -1,15 +1,63 @@
 #include "pch.h"
 #include "memory/generational_gc.h"
+#include "memory/prefetch_fifo.h"
 #include <meow/value.h>
 #include "runtime/execution_context.h"
 #include <meow/core/meow_object.h>
 #include <module/module_manager.h>
 #include "meow_heap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
 
 namespace meow {
 
 using namespace gc_flags;
 
+static uint32_t slice_budget_us = 500;
+static constexpr uint32_t AUTO_THREADS = UINT32_MAX;
+static uint32_t worker_threads = AUTO_THREADS;
+
+// Lát đánh dấu tuần tự chừng này object mà hàng xám chưa cạn thì mới đánh thức worker
+static constexpr size_t PARALLEL_AFTER = 1024;
+
+void set_gc_slice_budget(uint32_t micros) noexcept { slice_budget_us = micros; }
+uint32_t gc_slice_budget() noexcept { return slice_budget_us; }
+
+void set_gc_worker_threads(uint32_t threads) noexcept { worker_threads = threads; }
+uint32_t gc_worker_threads() noexcept {
+    if (worker_threads == AUTO_THREADS) {
+        const uint32_t cores = std::min(std::thread::hardware_concurrency(), 8u);
+        worker_threads = cores > 1 ? cores - 1 : 0;
+    }
+    return worker_threads;
+}
+
+// Địa chỉ cao nhất của stack thread hiện tại (stack mọc xuống)
+static const std::byte* native_stack_base() noexcept {
+#if defined(_WIN32)
+    ULONG_PTR low = 0, high = 0;
+    GetCurrentThreadStackLimits(&low, &high);
+    return reinterpret_cast<const std::byte*>(high);
+#elif defined(__APPLE__)
+    return static_cast<const std::byte*>(pthread_get_stackaddr_np(pthread_self()));
+#else
+    pthread_attr_t attr;
+    void* addr = nullptr;
+    size_t size = 0;
+    pthread_getattr_np(pthread_self(), &attr);
+    pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+    return static_cast<const std::byte*>(addr) + size;
+#endif
+}
+
 static void clear_list(heap* h, ObjectMeta* head) {
     while (head) {
         ObjectMeta* next = head->next_gc;
@@ -21,9 +69,17 @@ static void clear_list(heap* h, ObjectMeta* head) {
 }
 
 GenerationalGC::~GenerationalGC() noexcept {
+    if (finalizer_) {
+        finalizer_->shutdown();
+        if (heap_) finalizer_->reclaim(*heap_);
+    }
+    for (MeowObject* obj : nursery_.finalizable()) {
+        std::destroy_at(obj);
+    }
     if (heap_) {
         clear_list(heap_, young_head_);
         clear_list(heap_, old_head_);
+        clear_list(heap_, unswept_);
         clear_list(heap_, perm_head_);
     }
 }
@@ -58,38 +114,242 @@ void GenerationalGC::write_barrier(MeowObject* owner, Value value) noexcept {
         if (target) {
             auto* target_meta = heap::get_meta(target);
             if (!(target_meta->flags & GEN_OLD)) {
-                remembered_set_.push_back(owner);
+                remember(owner, owner_meta);
+            } else if (marking_) {
+                // Dijkstra: không để object đen trỏ tới object trắng
+                shade(target);
             }
         }
     }
 }
 
+void GenerationalGC::write_barrier_bulk(MeowObject* owner) noexcept {
+    auto* owner_meta = heap::get_meta(owner);
+    if (!(owner_meta->flags & GEN_OLD)) return;
+
+    remember(owner, owner_meta);
+    // Object đã đen thì trả lại xám để lát sau trace lại toàn bộ slot
+    if (marking_ && (owner_meta->flags & MARKED)) grey_.push_back(owner);
+}
+
+void GenerationalGC::remember(MeowObject* owner, ObjectMeta* owner_meta) {
+    if (owner_meta->flags & REMEMBERED) return;
+    owner_meta->flags |= REMEMBERED;
+    remembered_set_.push_back(owner);
+}
+
 size_t GenerationalGC::collect() noexcept {
+    minor_collect();
+
+    if (unswept_) sweep_slice();
+    else if (finalizer_) finalizer_->reclaim(*heap_);
+
+    // Chu kỳ mới dùng lại bit MARKED -> phải sweep xong chu kỳ trước
+    if (!marking_ && !unswept_ && old_count_ > old_gen_threshold_) start_major();
+
+    // Minor GC vừa quét lại root và toàn bộ object trẻ -> nếu lát này vét hết xám thì chốt luôn (remark)
+    if (marking_ && mark_slice()) finish_major();
+
+    return young_count_ + old_count_;
+}
+
+bool GenerationalGC::step() noexcept {
+    if (unswept_) {
+        sweep_slice();
+        return false;
+    }
+    if (!marking_) return false;
+    return mark_slice();
+}
+
+void GenerationalGC::minor_collect() noexcept {
+    in_minor_ = true;
+
+    // Native stack trước tiên: object nursery bị C++ giữ con trỏ thô phải đứng yên trước khi có gì bị dời
+    pin_native_roots();
+
+    trace_roots();
+
+    // Old gen chỉ được quét qua các owner đã ghi tham chiếu tới object trẻ.
+    // Tách ra trước: owner trỏ tới object bị ghim được ghi lại vào tập mới ngay trong lúc trace
+    std::vector<MeowObject*> owners;
+    owners.swap(remembered_set_);
+    for (auto* owner : owners) {
+        heap::get_meta(owner)->flags &= ~REMEMBERED;
+        trace_owner(owner);
+    }
+
+    drain_scan_queue();
+    sweep_young();
+    release_nursery();
+
+    in_minor_ = false;
+}
+
+void GenerationalGC::trace_roots() noexcept {
     context_->trace(*this);
     module_manager_->trace(*this);
     
-    ObjectMeta* perm = perm_head_;
-    while (perm) {
+    // Object permanent luôn mang MARKED nên không bao giờ xám -> trace thẳng con của chúng
+    for (ObjectMeta* perm = perm_head_; perm; perm = perm->next_gc) {
         MeowObject* obj = static_cast<MeowObject*>(heap::get_data(perm));
         if (obj->get_type() != ObjectType::STRING) {
-            mark_object(obj);
+            obj->trace(*this);
         }
-        perm = perm->next_gc;
     }
+}
 
-    for (auto* obj : remembered_set_) {
-        mark_object(obj);
+void GenerationalGC::start_major() noexcept {
+    marking_ = true;
+    if (!marker_ && gc_worker_threads() > 0) {
+        marker_ = std::make_unique<ParallelMarker>(nursery_, gc_worker_threads());
     }
+    // Object trẻ chưa cần quét: Minor GC nào trong chu kỳ cũng quét lại chúng và tô xám old mà chúng trỏ tới
+    trace_roots();
+}
 
-    if (old_count_ > old_gen_threshold_) {
-        sweep_full();
-        old_gen_threshold_ = std::max((size_t)100, old_count_ * 2);
-    } else {
-        sweep_young();
+bool GenerationalGC::mark_slice() noexcept {
+    using clock = std::chrono::steady_clock;
+    const bool bounded = slice_budget_us != 0;
+    const auto deadline = clock::now() + std::chrono::microseconds(slice_budget_us);
+
+    PrefetchFifo fifo;
+    size_t traced = 0;
+    while (MeowObject* obj = fifo.next(grey_)) {
+        obj->trace(*this);
+        ++traced;
+
+        if (marker_ && traced == PARALLEL_AFTER) {
+            fifo.flush(grey_);
+            return marker_->drain(grey_, deadline, bounded);
+        }
+        // Đọc đồng hồ mỗi 64 object cho rẻ
+        if ((traced & 63) == 0 && bounded && clock::now() >= deadline) {
+            fifo.flush(grey_);
+            return grey_.empty();
+        }
     }
+    return true;
+}
 
-    remembered_set_.clear();
-    return young_count_ + old_count_;
+void GenerationalGC::finish_major() noexcept {
+    marking_ = false;
+
+    // Không sweep trong lần dừng này: tách Old Gen ra, các lát sau quét dần.
+    // Object promote từ giờ vào old_head_ mới; object chết trong unswept_ không ai chạm tới nữa
+    unswept_ = old_head_;
+    old_head_ = nullptr;
+    old_count_ = 0;
+    if (!finalizer_) finalizer_ = std::make_unique<BackgroundFinalizer>();
+}
+
+void GenerationalGC::pin_native_roots() noexcept {
+    // Ép các register callee-saved xuống frame này; scan_native_stack() nằm dưới nên quét được cả chúng
+    __builtin_unwind_init();
+    scan_native_stack();
+    asm volatile("" ::: "memory");  // Chặn tail call: frame này phải còn sống khi quét
+}
+
+[[gnu::noinline]] [[gnu::no_sanitize_address]]
+void GenerationalGC::scan_native_stack() noexcept {
+    static thread_local const std::byte* stack_base = native_stack_base();
+
+    auto* word = static_cast<const uintptr_t*>(__builtin_frame_address(0));
+    auto* end = reinterpret_cast<const uintptr_t*>(stack_base);
+
+    for (; word < end; ++word) {
+        const uintptr_t bits = *word;
+        pin_candidate(reinterpret_cast<const void*>(bits));
+
+        Value value = Value::from_raw(bits);
+        if (value.is_object()) pin_candidate(value.as_object());
+    }
+}
+
+void GenerationalGC::pin_candidate(const void* address) noexcept {
+    if (!nursery_.contains(address)) return;
+    if (MeowObject* obj = nursery_.find_object(address)) {
+        pin_object(obj);
+    }
+}
+
+void GenerationalGC::pin_object(MeowObject* object) {
+    auto* meta = heap::get_meta(object);
+    if (meta->flags & (PINNED | FORWARDED)) return;
+
+    meta->flags |= PINNED;
+    pinned_.push_back(meta);
+    scan_queue_.push_back(object);
+}
+
+MeowObject* GenerationalGC::evacuate(MeowObject* object) {
+    auto* meta = heap::get_meta(object);
+    if (meta->flags & FORWARDED) {
+        return static_cast<MeowObject*>(heap::get_data(meta->next_gc));
+    }
+    if (meta->flags & PINNED) return object;
+
+    // Các kiểu trong nursery chỉ chứa con trỏ/vector -> dời bằng memcpy, bản cũ không chạy destructor
+    auto* copy = reinterpret_cast<MeowObject*>(heap_->allocate_array<std::byte>(meta->size));
+    std::memcpy(static_cast<void*>(copy), object, meta->size);
+
+    // Sinh ra giữa chu kỳ đánh dấu thì đen luôn (được trace ngay trong Minor GC này)
+    auto* copy_meta = heap::get_meta(copy);
+    copy_meta->flags = GEN_OLD | (marking_ ? MARKED : 0);
+    copy_meta->next_gc = old_head_;
+    old_head_ = copy_meta;
+    old_count_++;
+
+    meta->flags |= FORWARDED;
+    meta->next_gc = copy_meta;
+
+    scan_queue_.push_back(copy);
+    return copy;
+}
+
+void GenerationalGC::drain_scan_queue() {
+    PrefetchFifo fifo;
+    while (MeowObject* obj = fifo.next(scan_queue_)) {
+        trace_owner(obj);
+    }
+}
+
+void GenerationalGC::trace_owner(MeowObject* owner) noexcept {
+    // Owner nằm ngoài nursery (old, bản copy, young free-list sắp promote) mới cần nhớ cạnh tới object bị ghim
+    current_owner_ = nursery_.contains(owner) ? nullptr : owner;
+    owner->trace(*this);
+    current_owner_ = nullptr;
+}
+
+void GenerationalGC::keep_pinned_edge(MeowObject* target) noexcept {
+    // Object ghim ở lại nursery: owner phải vào remembered set, nếu không Minor GC sau
+    // không thấy cạnh này và nursery reset thu hồi object còn sống
+    if (current_owner_ && nursery_.contains(target)) {
+        remember(current_owner_, heap::get_meta(current_owner_));
+    }
+}
+
+void GenerationalGC::release_nursery() noexcept {
+    // Chết trong nursery: chỉ object còn giữ buffer (vector, entry hash table) mới cần destructor, còn lại bỏ cả vùng một lần
+    auto& finalizable = nursery_.finalizable();
+    size_t kept = 0;
+    for (MeowObject* obj : finalizable) {
+        const uint32_t flags = heap::get_meta(obj)->flags;
+        if (flags & FORWARDED) continue;
+        if (flags & PINNED) {
+            finalizable[kept++] = obj;
+            continue;
+        }
+        std::destroy_at(obj);
+    }
+    finalizable.resize(kept);
+
+    std::sort(pinned_.begin(), pinned_.end());
+    for (ObjectMeta* meta : pinned_) {
+        meta->flags &= ~PINNED;
+    }
+    nursery_.reset(pinned_);
+    pinned_.clear();
 }
 
 void GenerationalGC::destroy_object(ObjectMeta* meta) {
@@ -100,7 +360,6 @@ void GenerationalGC::destroy_object(ObjectMeta* meta) {
 
 void GenerationalGC::sweep_young() {
     ObjectMeta** curr = &young_head_;
-    size_t survived = 0;
 
     while (*curr) {
         ObjectMeta* meta = *curr;
@@ -109,7 +368,7 @@ void GenerationalGC::sweep_young() {
             *curr = meta->next_gc; 
             meta->next_gc = old_head_;
             old_head_ = meta;
-            meta->flags = GEN_OLD; 
+            meta->flags = GEN_OLD | (marking_ ? MARKED : 0); 
             
             old_count_++;
             young_count_--;
@@ -123,44 +382,100 @@ void GenerationalGC::sweep_young() {
     }
 }
 
-void GenerationalGC::sweep_full() {
-    ObjectMeta** curr_old = &old_head_;
-    size_t old_survived = 0;
-    while (*curr_old) {
-        ObjectMeta* meta = *curr_old;
+bool GenerationalGC::sweep_slice() noexcept {
+    using clock = std::chrono::steady_clock;
+    const bool bounded = slice_budget_us != 0;
+    const auto deadline = clock::now() + std::chrono::microseconds(slice_budget_us);
+
+    size_t swept = 0;
+    while (unswept_) {
+        ObjectMeta* meta = unswept_;
+        unswept_ = meta->next_gc;
+
         if (meta->flags & MARKED) {
             meta->flags &= ~MARKED;
-            curr_old = &meta->next_gc;
-            old_survived++;
+            meta->next_gc = old_head_;
+            old_head_ = meta;
+            old_count_++;
         } else {
-            ObjectMeta* dead = meta;
-            *curr_old = dead->next_gc;
-            destroy_object(dead);
+            // Owner chết vẫn có thể nằm trong remembered set (ghi lại vì trỏ tới object bị ghim)
+            if (meta->flags & REMEMBERED) {
+                std::erase(remembered_set_, static_cast<MeowObject*>(heap::get_data(meta)));
+            }
+            // Giữ vector -> destructor (free buffer) chạy trên thread nền; còn lại trả ngay về free-list
+            const ObjectType type = static_cast<MeowObject*>(heap::get_data(meta))->get_type();
+            if (type == ObjectType::ARRAY || type == ObjectType::INSTANCE || type == ObjectType::FUNCTION) {
+                deferred_.push_back(meta);
+            } else {
+                destroy_object(meta);
+            }
         }
+
+        if ((++swept & 63) == 0 && bounded && clock::now() >= deadline) break;
     }
-    old_count_ = old_survived;
 
-    sweep_young(); 
+    if (!deferred_.empty()) finalizer_->submit(deferred_);
+    finalizer_->reclaim(*heap_);
+
+    if (unswept_) return false;
+    old_gen_threshold_ = std::max((size_t)100, old_count_ * 2);
+    return true;
 }
 
 void GenerationalGC::visit_value(param_t value) noexcept {
-    if (value.is_object()) mark_object(value.as_object());
+    if (value.is_object()) visit_object(value.as_object());
 }
 
 void GenerationalGC::visit_object(const MeowObject* object) noexcept {
-    mark_object(const_cast<MeowObject*>(object));
+    auto* obj = const_cast<MeowObject*>(object);
+    if (obj == nullptr) return;
+    // Không có slot để ghi địa chỉ mới -> object nursery gặp qua đường này bị ghim tại chỗ
+    if (in_minor_ && nursery_.contains(obj)) {
+        pin_object(obj);
+        keep_pinned_edge(obj);
+    } else {
+        visit_movable(obj);
+    }
 }
 
-void GenerationalGC::mark_object(MeowObject* object) {
-    if (object == nullptr) return;
-    
+void GenerationalGC::visit_slot(Value& slot) noexcept {
+    if (!slot.is_object()) return;
+    MeowObject* obj = slot.as_object();
+    MeowObject* moved = visit_movable(obj);
+    if (moved != obj) slot = moved;
+}
+
+MeowObject* GenerationalGC::visit_movable(MeowObject* object) noexcept {
+    if (object == nullptr) return nullptr;
+
+    if (nursery_.contains(object)) {
+        // Lát đánh dấu chạy giữa chừng mutator: không dời được, để Minor GC kế tiếp lo
+        if (!in_minor_) return object;
+        MeowObject* moved = evacuate(object);
+        if (moved == object) keep_pinned_edge(object);
+        return moved;
+    }
+
+    if (heap::get_meta(object)->flags & GEN_OLD) {
+        if (marking_) shade(object);
+    } else if (in_minor_) {
+        mark_young(object);
+    }
+    return object;
+}
+
+void GenerationalGC::mark_young(MeowObject* object) {
     auto* meta = heap::get_meta(object);
-    
     if (meta->flags & MARKED) return;
-    
     meta->flags |= MARKED;
-    
-    object->trace(*this);
+    scan_queue_.push_back(object);
 }
 
-}
\ No newline at end of file
+void GenerationalGC::shade(MeowObject* object) {
+    auto* meta = heap::get_meta(object);
+    if (meta->flags & MARKED) return;
+    meta->flags |= MARKED;
+    grey_.push_back(object);
+}
+
+}
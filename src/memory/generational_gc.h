@@ -4,6 +4,10 @@
 #include <meow/common.h>
 #include <meow/memory/garbage_collector.h>
 #include <meow/memory/gc_visitor.h>
+#include <meow/memory/nursery.h>
+#include "memory/parallel_marker.h"
+#include "memory/background_finalizer.h"
+#include <memory>
 #include <vector> 
 #include "meow_heap.h"
 
@@ -21,9 +25,16 @@ public:
     size_t collect() noexcept override;
 
     void write_barrier(MeowObject* owner, Value value) noexcept override;
+    void write_barrier_bulk(MeowObject* owner) noexcept override;
+    bool step() noexcept override;
 
     void visit_value(param_t value) noexcept override;
     void visit_object(const MeowObject* object) noexcept override;
+    void visit_slot(Value& slot) noexcept override;
+    MeowObject* visit_movable(MeowObject* object) noexcept override;
+    using GCVisitor::visit_slot;
+
+    Nursery* nursery() noexcept override { return &nursery_; }
 
     void set_module_manager(ModuleManager* mm) { module_manager_ = mm; }
 
@@ -37,14 +48,49 @@ private:
     
     std::vector<MeowObject*> remembered_set_;
 
+    Nursery nursery_;
+    std::vector<MeowObject*> scan_queue_;   // Minor GC: object trẻ sống sót (copy/ghim/free-list) chờ trace
+    MeowObject* current_owner_ = nullptr;   // Minor GC: object ngoài nursery đang được trace
+    std::vector<ObjectMeta*> pinned_;
+
+    // Major GC incremental (tri-color): trắng = old chưa MARKED, xám = MARKED nằm trong grey_, đen = MARKED đã trace
+    bool marking_ = false;
+    bool in_minor_ = false;                 // Visitor đang chạy trong Minor GC (được dời object) hay trong lát đánh dấu
+    std::vector<MeowObject*> grey_;
+    std::unique_ptr<ParallelMarker> marker_; // Tạo lúc bắt đầu chu kỳ đầu tiên nếu có worker thread
+
+    // Sweep Old Gen lười: danh sách tách ra lúc chốt chu kỳ, quét dần theo lát trên thread VM
+    ObjectMeta* unswept_ = nullptr;
+    std::vector<ObjectMeta*> deferred_;      // Object chết giữ vector, gom lô gửi finalizer
+    std::unique_ptr<BackgroundFinalizer> finalizer_;
+
     size_t young_count_ = 0;
     size_t old_count_ = 0;
     size_t old_gen_threshold_ = 100;
 
-    void mark_object(MeowObject* object);
+    void mark_young(MeowObject* object);
+    void shade(MeowObject* object);
+    void remember(MeowObject* owner, ObjectMeta* owner_meta);
+    void pin_object(MeowObject* object);
+    MeowObject* evacuate(MeowObject* object);
+    void trace_owner(MeowObject* owner) noexcept;
+    void keep_pinned_edge(MeowObject* target) noexcept;
+
+    void pin_native_roots() noexcept;
+    void scan_native_stack() noexcept;
+    void pin_candidate(const void* address) noexcept;
+
+    void minor_collect() noexcept;
+    void drain_scan_queue();
+    void release_nursery() noexcept;
+
+    void start_major() noexcept;
+    bool mark_slice() noexcept;
+    void finish_major() noexcept;
+    void trace_roots() noexcept;
     
     void sweep_young(); 
-    void sweep_full();
+    bool sweep_slice() noexcept;
     
     void destroy_object(ObjectMeta* meta);
 };
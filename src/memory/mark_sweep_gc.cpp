@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "memory/mark_sweep_gc.h"
+#include "memory/prefetch_fifo.h"
 #include <meow/value.h>
 #include <module/module_manager.h>
 #include "runtime/execution_context.h"
@@ -35,6 +36,19 @@ void MarkSweepGC::register_permanent(const MeowObject* object) {
 size_t MarkSweepGC::collect() noexcept {
     context_->trace(*this);
     module_manager_->trace(*this);
+    drain_mark_stack();
+
+    // Stack từng tràn: object MARKED nào cũng trace lại (kể cả PERMANENT), con chưa đánh dấu sẽ vào stack
+    while (overflowed_) {
+        overflowed_ = false;
+        for (ObjectMeta* meta = head_; meta; meta = meta->next_gc) {
+            if (meta->flags & MARKED) {
+                static_cast<MeowObject*>(heap::get_data(meta))->trace(*this);
+                drain_mark_stack();
+            }
+        }
+    }
+
     ObjectMeta** curr = &head_;
     size_t survived = 0;
 
@@ -71,6 +85,16 @@ void MarkSweepGC::visit_object(const MeowObject* object) noexcept {
     mark(const_cast<MeowObject*>(object));
 }
 
+// Không dời object -> slot giữ nguyên
+void MarkSweepGC::visit_slot(Value& slot) noexcept {
+    visit_value(slot);
+}
+
+MeowObject* MarkSweepGC::visit_movable(MeowObject* object) noexcept {
+    mark(object);
+    return object;
+}
+
 void MarkSweepGC::mark(MeowObject* object) {
     if (object == nullptr) return;
     auto* meta = heap::get_meta(object);
@@ -78,7 +102,18 @@ void MarkSweepGC::mark(MeowObject* object) {
     if (meta->flags & MARKED) return;
     
     meta->flags |= MARKED;
-    object->trace(*this);
+    if (mark_stack_.size() < MARK_STACK_LIMIT) {
+        mark_stack_.push_back(object);
+    } else {
+        overflowed_ = true;
+    }
+}
+
+void MarkSweepGC::drain_mark_stack() noexcept {
+    PrefetchFifo fifo;
+    while (MeowObject* obj = fifo.next(mark_stack_)) {
+        obj->trace(*this);
+    }
 }
 
 }
\ No newline at end of file
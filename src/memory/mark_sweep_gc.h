@@ -21,6 +21,9 @@ public:
 
     void visit_value(param_t value) noexcept override;
     void visit_object(const MeowObject* object) noexcept override;
+    void visit_slot(Value& slot) noexcept override;
+    MeowObject* visit_movable(MeowObject* object) noexcept override;
+    using GCVisitor::visit_slot;
 
     void set_module_manager(ModuleManager* mm) { module_manager_ = mm; }
 private:
@@ -30,6 +33,13 @@ private:
     ObjectMeta* head_ = nullptr;
     size_t object_count_ = 0;
 
+    // Đánh dấu không đệ quy: object MARKED chờ trace nằm ở đây thay vì trên native stack.
+    // Vượt trần thì bỏ qua (object vẫn MARKED) và quét lại heap sau khi stack cạn
+    static constexpr size_t MARK_STACK_LIMIT = 1 << 20;
+    std::vector<MeowObject*> mark_stack_;
+    bool overflowed_ = false;
+
     void mark(MeowObject* object);
+    void drain_mark_stack() noexcept;
 };
 }
\ No newline at end of file
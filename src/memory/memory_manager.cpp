@@ -15,6 +15,7 @@ MemoryManager::MemoryManager(std::unique_ptr<GarbageCollector> gc) noexcept
 { 
     if (gc_) {
         gc_->set_heap(&heap_);
+        nursery_ = gc_->nursery();
     }
 }
 
@@ -45,8 +46,7 @@ array_t MemoryManager::new_array(const std::vector<Value>& elements) {
 }
 
 hash_table_t MemoryManager::new_hash(uint32_t capacity) {
-    auto alloc = heap_.get_allocator<Entry>();
-    return heap_.create<ObjHashTable>(alloc, capacity);
+    return new_object<ObjHashTable>(heap_.get_allocator<Entry>(), capacity);
 }
 
 upvalue_t MemoryManager::new_upvalue(size_t index) {
@@ -0,0 +1,85 @@
+#include <meow/memory/nursery.h>
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <new>
+
+namespace meow {
+
+Nursery::Nursery(size_t size) {
+    size = align_up(size);
+    begin_ = static_cast<std::byte*>(std::aligned_alloc(alignof(ObjectMeta), size));
+    if (begin_ == nullptr) throw std::bad_alloc();
+    end_ = begin_ + size;
+
+    starts_.assign((size / GRANULE + 63) / 64, 0);
+    reset({});
+}
+
+Nursery::~Nursery() noexcept {
+    std::free(begin_);
+}
+
+void* Nursery::allocate_slow(size_t data_size) noexcept {
+    const size_t total = align_up(sizeof(ObjectMeta) + data_size);
+
+    // Lỗ hiện tại không đủ: bỏ phần thừa, nhảy sang lỗ kế tiếp giữa các object bị ghim
+    while (next_hole_ < holes_.size()) {
+        const Hole hole = holes_[next_hole_++];
+        top_ = hole.begin;
+        limit_ = hole.end;
+        if (static_cast<size_t>(limit_ - top_) >= total) {
+            return carve(data_size, total);
+        }
+    }
+    return nullptr;
+}
+
+MeowObject* Nursery::find_object(const void* addr) const noexcept {
+    if (!contains(addr)) return nullptr;
+
+    auto* p = static_cast<const std::byte*>(addr);
+    const size_t granule = static_cast<size_t>(p - begin_) / GRANULE;
+
+    // Tìm bit start gần nhất <= granule
+    size_t word = granule >> 6;
+    uint64_t bits = starts_[word] & (~uint64_t{0} >> (63 - (granule & 63)));
+    while (bits == 0) {
+        if (word == 0) return nullptr;
+        bits = starts_[--word];
+    }
+
+    const size_t start = (word << 6) + 63 - static_cast<size_t>(std::countl_zero(bits));
+    auto* meta = reinterpret_cast<ObjectMeta*>(begin_ + start * GRANULE);
+    const std::byte* object_end = reinterpret_cast<const std::byte*>(meta) + align_up(sizeof(ObjectMeta) + meta->size);
+    if (p >= object_end) return nullptr;
+
+    return static_cast<MeowObject*>(heap::get_data(meta));
+}
+
+void Nursery::reset(const std::vector<ObjectMeta*>& pinned) noexcept {
+    std::fill(starts_.begin(), starts_.end(), 0);
+    holes_.clear();
+
+    std::byte* cursor = begin_;
+    for (ObjectMeta* meta : pinned) {
+        auto* start = reinterpret_cast<std::byte*>(meta);
+        if (start > cursor) holes_.push_back({cursor, start});
+
+        const size_t granule = static_cast<size_t>(start - begin_) / GRANULE;
+        starts_[granule >> 6] |= uint64_t{1} << (granule & 63);
+
+        cursor = start + align_up(sizeof(ObjectMeta) + meta->size);
+    }
+    if (end_ > cursor) holes_.push_back({cursor, end_});
+
+    next_hole_ = 0;
+    top_ = limit_ = end_;
+    if (!holes_.empty()) {
+        top_ = holes_[0].begin;
+        limit_ = holes_[0].end;
+        next_hole_ = 1;
+    }
+}
+
+}
@@ -0,0 +1,195 @@
+#include "pch.h"
+#include "memory/parallel_marker.h"
+#include "memory/prefetch_fifo.h"
+#include <meow/memory/garbage_collector.h>
+#include <meow/core/meow_object.h>
+#include <meow/value.h>
+#include "meow_heap.h"
+
+namespace meow {
+
+using namespace gc_flags;
+
+ParallelMarker::ParallelMarker(const Nursery& nursery, size_t threads) {
+    for (size_t i = 0; i <= threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>(nursery));
+    }
+    for (size_t i = 1; i <= threads; ++i) {
+        threads_.emplace_back(&ParallelMarker::thread_main, this, i);
+    }
+}
+
+ParallelMarker::~ParallelMarker() noexcept {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void ParallelMarker::thread_main(size_t index) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || epoch_ != seen; });
+            if (stop_) return;
+            seen = epoch_;
+        }
+
+        run(index);
+
+        std::lock_guard lock(mutex_);
+        if (--running_ == 0) done_.notify_one();
+    }
+}
+
+bool ParallelMarker::drain(std::vector<MeowObject*>& grey, clock::time_point deadline, bool bounded) noexcept {
+    // Chia đều hàng xám ban đầu (root, remembered set...) cho các hàng chia sẻ
+    const size_t count = workers_.size();
+    for (size_t i = 0; i < grey.size(); ++i) {
+        workers_[i % count]->shared.push_back(grey[i]);
+    }
+    for (auto& worker : workers_) {
+        worker->shared_size.store(worker->shared.size(), std::memory_order_relaxed);
+    }
+    grey.clear();
+
+    deadline_ = deadline;
+    bounded_ = bounded;
+    idle_.store(0, std::memory_order_relaxed);
+    expired_.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(mutex_);
+        running_ = threads_.size();
+        ++epoch_;
+    }
+    wake_.notify_all();
+
+    run(0);
+
+    {
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [&] { return running_ == 0; });
+    }
+
+    // Hết giờ: việc dở dang quay về hàng xám của GC cho lát sau
+    for (auto& worker : workers_) {
+        grey.insert(grey.end(), worker->local.begin(), worker->local.end());
+        grey.insert(grey.end(), worker->shared.begin(), worker->shared.end());
+        worker->local.clear();
+        worker->shared.clear();
+        worker->shared_size.store(0, std::memory_order_relaxed);
+    }
+    return grey.empty();
+}
+
+void ParallelMarker::run(size_t index) noexcept {
+    Worker& self = *workers_[index];
+    const size_t count = workers_.size();
+    PrefetchFifo fifo;
+    size_t traced = 0;
+
+    for (;;) {
+        while (MeowObject* obj = fifo.next(self.local)) {
+            obj->trace(self);
+
+            if ((++traced & 63) == 0) {
+                bool stop = expired_.load(std::memory_order_relaxed);
+                if (!stop && bounded_ && clock::now() >= deadline_) {
+                    expired_.store(true, std::memory_order_relaxed);
+                    stop = true;
+                }
+                if (stop) {
+                    fifo.flush(self.local);
+                    return;
+                }
+            }
+            if (self.local.size() > PUBLISH_THRESHOLD && self.shared_size.load(std::memory_order_relaxed) == 0) {
+                self.publish();
+            }
+        }
+
+        if (steal(index)) continue;
+
+        // Rảnh: chỉ kết thúc khi mọi worker cùng rảnh (không ai còn giữ việc để chia)
+        idle_.fetch_add(1, std::memory_order_acq_rel);
+        for (;;) {
+            if (idle_.load(std::memory_order_acquire) == count || expired_.load(std::memory_order_relaxed)) return;
+
+            bool has_work = false;
+            for (auto& worker : workers_) {
+                if (worker->shared_size.load(std::memory_order_acquire) != 0) {
+                    has_work = true;
+                    break;
+                }
+            }
+            if (has_work) {
+                idle_.fetch_sub(1, std::memory_order_acq_rel);
+                if (steal(index)) break;
+                idle_.fetch_add(1, std::memory_order_acq_rel);
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool ParallelMarker::steal(size_t index) noexcept {
+    Worker& self = *workers_[index];
+    const size_t count = workers_.size();
+
+    // k = 0 là hàng của chính mình, sau đó đi vòng các worker khác
+    for (size_t k = 0; k < count; ++k) {
+        Worker& victim = *workers_[(index + k) % count];
+        if (victim.shared_size.load(std::memory_order_acquire) == 0) continue;
+
+        std::lock_guard lock(victim.lock);
+        const size_t size = victim.shared.size();
+        if (size == 0) continue;
+
+        const size_t take = (size + 1) / 2;
+        self.local.insert(self.local.end(), victim.shared.end() - take, victim.shared.end());
+        victim.shared.resize(size - take);
+        victim.shared_size.store(size - take, std::memory_order_release);
+        return true;
+    }
+    return false;
+}
+
+void ParallelMarker::Worker::publish() {
+    // Đẩy nửa đáy stack (object cũ hơn, thường là gốc của cây con lớn) sang hàng chia sẻ
+    const size_t half = local.size() / 2;
+    std::lock_guard guard(lock);
+    shared.insert(shared.end(), local.begin(), local.begin() + half);
+    shared_size.store(shared.size(), std::memory_order_release);
+    local.erase(local.begin(), local.begin() + half);
+}
+
+void ParallelMarker::Worker::visit_value(param_t value) noexcept {
+    if (value.is_object()) visit_movable(value.as_object());
+}
+
+void ParallelMarker::Worker::visit_object(const MeowObject* object) noexcept {
+    visit_movable(const_cast<MeowObject*>(object));
+}
+
+void ParallelMarker::Worker::visit_slot(Value& slot) noexcept {
+    if (slot.is_object()) visit_movable(slot.as_object());
+}
+
+MeowObject* ParallelMarker::Worker::visit_movable(MeowObject* object) noexcept {
+    // Object trẻ (nursery/free-list) để Minor GC lo, giống lát đánh dấu tuần tự
+    if (object == nullptr || nursery.contains(object)) return object;
+
+    std::atomic_ref<uint32_t> flags(heap::get_meta(object)->flags);
+    const uint32_t seen = flags.load(std::memory_order_relaxed);
+    if (!(seen & GEN_OLD) || (seen & MARKED)) return object;
+
+    if (!(flags.fetch_or(MARKED, std::memory_order_relaxed) & MARKED)) {
+        local.push_back(object);
+    }
+    return object;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "pch.h"
+#include <meow/common.h>
+#include <meow/memory/gc_visitor.h>
+#include <meow/memory/nursery.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace meow {
+
+// Đánh dấu Old Gen song song cho một lát của Major GC (mutator đang dừng, fork-join).
+// Mỗi worker có stack riêng; khi dài quá thì đẩy một nửa sang hàng chia sẻ để worker rảnh ăn cắp.
+// Bit MARKED đặt bằng fetch_or nên hai worker gặp cùng object thì chỉ một bên trace.
+class ParallelMarker {
+public:
+    using clock = std::chrono::steady_clock;
+
+    ParallelMarker(const Nursery& nursery, size_t threads);
+    ~ParallelMarker() noexcept;
+
+    ParallelMarker(const ParallelMarker&) = delete;
+    ParallelMarker& operator=(const ParallelMarker&) = delete;
+
+    // Trace hết grey (kể cả object mới tô xám) hoặc tới deadline; phần còn dở trả lại grey. true = cạn
+    bool drain(std::vector<MeowObject*>& grey, clock::time_point deadline, bool bounded) noexcept;
+
+private:
+    static constexpr size_t PUBLISH_THRESHOLD = 64;
+
+    struct Worker final : GCVisitor {
+        const Nursery& nursery;
+        std::vector<MeowObject*> local;      // Chỉ worker chủ đụng tới
+
+        std::mutex lock;
+        std::vector<MeowObject*> shared;     // Worker khác lấy từ đây
+        std::atomic<size_t> shared_size{0};
+
+        explicit Worker(const Nursery& n) noexcept : nursery(n) {}
+
+        void visit_value(param_t value) noexcept override;
+        void visit_object(const MeowObject* object) noexcept override;
+        void visit_slot(Value& slot) noexcept override;
+        MeowObject* visit_movable(MeowObject* object) noexcept override;
+        using GCVisitor::visit_slot;
+
+        void publish();
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;   // workers_[0] chạy trên thread gọi drain()
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t epoch_ = 0;
+    size_t running_ = 0;
+    bool stop_ = false;
+
+    std::atomic<size_t> idle_{0};
+    std::atomic<bool> expired_{false};
+    clock::time_point deadline_;
+    bool bounded_ = false;
+
+    void thread_main(size_t index);
+    void run(size_t index) noexcept;
+    bool steal(size_t index) noexcept;
+};
+}
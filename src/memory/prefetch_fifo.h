@@ -0,0 +1,56 @@
+#pragma once
+
+#include "pch.h"
+#include <meow/core/meow_object.h>
+#include <vector>
+
+namespace meow {
+
+// Hàng đợi nhỏ đứng giữa mark stack và trace(): object được prefetch lúc vào hàng,
+// tới lúc ra (sau SIZE object khác) thì header đã nằm sẵn trong cache.
+// Nhờ vậy vài cache miss chạy chồng lên nhau thay vì đuổi con trỏ từng cái một.
+class PrefetchFifo {
+public:
+    static constexpr size_t SIZE = 8;
+
+    // Object kế tiếp cần trace: rút từ stack cho tới khi hàng đầy, stack cạn thì vét nốt hàng. nullptr = hết việc
+    MeowObject* next(std::vector<MeowObject*>& stack) noexcept {
+        while (!stack.empty()) {
+            MeowObject* obj = stack.back();
+            stack.pop_back();
+            if (MeowObject* ready = push(obj)) return ready;
+        }
+        if (count_ == 0) return nullptr;
+        MeowObject* obj = slots_[(pos_ + SIZE - count_) % SIZE];
+        --count_;
+        return obj;
+    }
+
+    // Dừng giữa chừng (hết giờ, chuyển sang marker song song): trả object chưa trace về stack
+    void flush(std::vector<MeowObject*>& stack) {
+        for (; count_ > 0; --count_) {
+            stack.push_back(slots_[(pos_ + SIZE - count_) % SIZE]);
+        }
+    }
+
+private:
+    MeowObject* slots_[SIZE] = {};
+    size_t pos_ = 0;      // Ô ghi kế tiếp; hàng là [pos_ - count_, pos_)
+    size_t count_ = 0;
+
+    // Cho obj vào cuối hàng, trả object đầu hàng nếu hàng đã đầy
+    MeowObject* push(MeowObject* obj) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(obj, 0, 3);
+#endif
+        MeowObject* out = slots_[pos_];
+        slots_[pos_] = obj;
+        pos_ = (pos_ + 1) % SIZE;
+        if (count_ < SIZE) {
+            ++count_;
+            return nullptr;
+        }
+        return out;
+    }
+};
+}
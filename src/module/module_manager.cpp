@@ -8,6 +8,7 @@
 #include <meow/memory/gc_visitor.h>
 #include "module/module_utils.h"
 #include "bytecode/loader.h"
+#include "jit/aot/native_image.h"
 
 #include <fstream> 
 
@@ -186,6 +187,9 @@ Result<module_t, ModuleErrorCode> ModuleManager::load_module(string_t module_pat
     std::unordered_set<proto_t> visited;
     link_module_to_proto(meow_module, main_proto, visited);
 
+    // Mã máy AOT cạnh file (.meowx): chỉ dùng khi khớp bytecode, ngược lại vẫn chạy Interpreter/JIT như thường
+    jit::aot::attach(binary_file_path_fs, buffer, loader.protos());
+
     module_cache_[module_path_obj] = meow_module;
     module_cache_[binary_file_path_obj] = meow_module;
     
@@ -198,6 +202,7 @@ Result<module_t, ModuleErrorCode> ModuleManager::load_module(string_t module_pat
         auto native_res = load_module(native_name, nullptr);
         if (native_res.ok()) {
             meow_module->import_all_global(native_res.value());
+            heap_->write_barrier_bulk(meow_module);
         }
     }
     
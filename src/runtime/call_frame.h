@@ -1,5 +1,6 @@
 #pragma once
 #include <meow/common.h>
+#include <meow/core/function.h>
 
 namespace meow {
 
@@ -8,11 +9,37 @@ struct CallFrame {
     Value* regs_base_ = nullptr; 
     Value* ret_dest_ = nullptr;
     const uint8_t* ip_ = nullptr;
+
+    // Cache của proto: update_pointers() đọc thẳng từ frame thay vì function -> proto -> chunk
+    const uint8_t* code_ = nullptr;
+    const Value* constants_ = nullptr;
+    module_t module_ = nullptr;
+
+    // stack_top_ của caller lúc gọi, RETURN trả stack_top_ về đây. Bằng regs_base_ khi tham số được chép
+    // lên đỉnh stack; register window / deopt inline thì frame nằm trong vùng của caller nên cao hơn regs_base_.
+    // Bắt buộc truyền ở mọi chỗ dựng frame: không có giá trị mặc định đúng cho mọi kiểu gọi
+    Value* caller_top_ = nullptr;
+
     CallFrame() = default;
 
-    CallFrame(function_t func, Value* regs, Value* ret, const uint8_t* ip)
-        : function_(func), regs_base_(regs), ret_dest_(ret), ip_(ip) {
+    CallFrame(function_t func, Value* regs, Value* ret, const uint8_t* ip, Value* caller_top)
+        : function_(func), regs_base_(regs), ret_dest_(ret), ip_(ip), caller_top_(caller_top) {
+        cache_proto();
+    }
+
+    // TAIL_CALL thay hàm ngay trên frame hiện tại
+    inline void set_function(function_t func) noexcept {
+        function_ = func;
+        cache_proto();
+    }
+
+private:
+    inline void cache_proto() noexcept {
+        proto_t proto = function_->get_proto();
+        code_ = proto->get_chunk().get_code();
+        constants_ = proto->get_chunk().get_constants_raw();
+        module_ = proto->get_module();
     }
 };
 
-}
\ No newline at end of file
+}
@@ -50,23 +50,21 @@ struct ExecutionContext {
         return (frame_ptr_ + 1) < (call_stack_ + FRAMES_MAX);
     }
 
-    inline void trace(GCVisitor& visitor) const noexcept {
+    inline void trace(GCVisitor& visitor) noexcept {
         // 1. Trace Operand Stack
-        for (const Value* slot = stack_; slot < stack_top_; ++slot) {
-            visitor.visit_value(*slot);
+        for (Value* slot = stack_; slot < stack_top_; ++slot) {
+            visitor.visit_slot(*slot);
         }
         
         // 2. [FIX] Trace Call Stack
         // Iterate from the first frame up to the current frame_ptr_
-        for (const CallFrame* frame = call_stack_; frame <= frame_ptr_; ++frame) {
-            if (frame->function_) {
-                visitor.visit_object(frame->function_);
-            }
+        for (CallFrame* frame = call_stack_; frame <= frame_ptr_; ++frame) {
+            visitor.visit_slot(frame->function_);
         }
 
         // 3. Trace Open Upvalues
-        for (const auto& upvalue : open_upvalues_) {
-            visitor.visit_object(upvalue);
+        for (auto& upvalue : open_upvalues_) {
+            visitor.visit_slot(upvalue);
         }
     }
 };
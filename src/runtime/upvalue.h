@@ -19,11 +19,14 @@ inline upvalue_t capture_upvalue(ExecutionContext* context, MemoryManager* heap,
     return new_uv;
 }
 
-inline void close_upvalues(ExecutionContext* context, size_t last_index) noexcept {
+inline void close_upvalues(ExecutionContext* context, MemoryManager* heap, size_t last_index) noexcept {
     while (!context->open_upvalues_.empty() && context->open_upvalues_.back()->get_index() >= last_index) {
         upvalue_t uv = context->open_upvalues_.back();
         // [FIX] Truy cập mảng tĩnh stack_ thay vì vector registers_
-        uv->close(context->stack_[uv->get_index()]);
+        Value value = context->stack_[uv->get_index()];
+        uv->close(value);
+        // Upvalue mở lâu có thể đã lên old gen
+        heap->write_barrier(uv, value);
         context->open_upvalues_.pop_back();
     }
 }
@@ -32,7 +35,7 @@ inline upvalue_t capture_upvalue(ExecutionContext& context, MemoryManager& heap,
     return capture_upvalue(&context, &heap, register_index);
 }
 
-inline void close_upvalues(ExecutionContext& context, size_t last_index) noexcept {
-    return close_upvalues(&context, last_index);
+inline void close_upvalues(ExecutionContext& context, MemoryManager& heap, size_t last_index) noexcept {
+    return close_upvalues(&context, &heap, last_index);
 }
 }
\ No newline at end of file
@@ -47,6 +47,8 @@ private:
     std::string parse_string_literal(std::string_view sv);
     Status link_proto_refs();
     Status patch_labels();
+    void fold_immediates();
+    void select_call_windows();
 
     inline void emit_byte(uint8_t b);
     inline void emit_u16(uint16_t v);
@@ -21,7 +21,7 @@ enum class ErrorCode : uint8_t {
     UNDEFINED_LABEL, UNDEFINED_PROTO_REF, OUTSIDE_FUNC, LABEL_REDEFINITION,
     FILE_OPEN_FAILED, WRITE_ERROR, READ_ERROR, INDEX_OUT_OF_BOUNDS,
     
-    REG_INDEX_TOO_LARGE, UNKNOWN_ARG_TYPE
+    REG_INDEX_TOO_LARGE, UNKNOWN_ARG_TYPE, IMMEDIATE_OUT_OF_RANGE
 };
 
 struct Status {
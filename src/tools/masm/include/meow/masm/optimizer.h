@@ -15,9 +15,10 @@ enum class OptFlags : uint8_t {
     Peephole    = 1 << 1, 
     RegAlloc    = 1 << 2, 
     ConstFold   = 1 << 3, 
+    SuperInstr  = 1 << 4, // Gộp chuỗi lệnh thành superinstruction (meow/bytecode/super_ops.h)
     
     O1 = DCE | Peephole,
-    O2 = DCE | Peephole | RegAlloc | ConstFold,
+    O2 = DCE | Peephole | RegAlloc | ConstFold | SuperInstr,
     All = 0xFF
 };
 
@@ -31,6 +31,7 @@ constexpr std::string_view get_error_msg(ErrorCode code) {
         
         case ErrorCode::REG_INDEX_TOO_LARGE: return "Register index too large (max 255)";
         case ErrorCode::UNKNOWN_ARG_TYPE: return "Unknown argument type";
+        case ErrorCode::IMMEDIATE_OUT_OF_RANGE: return "Immediate out of range (int16)";
         
         default: return "Unknown error";
     }
@@ -3,6 +3,11 @@ type: uploaded file
 fileName: masm/src/assembler.cpp
 */
 #include <meow/masm/assembler.h>
+#include "analysis/bytecode_analysis.h"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
 #include <charconv> 
 #include <bit>
 #include <cstring>
@@ -210,6 +215,12 @@ Status Assembler::parse_arg(ArgType type, OpCode op) {
         int64_t val; std::from_chars(tk.lexeme.data(), tk.lexeme.data() + tk.lexeme.size(), val);
         emit_u64(std::bit_cast<uint64_t>(val));
     }
+    else if (type == ArgType::I16) {
+        MASM_CHECK(consume(TokenType::NUMBER_INT, ErrorCode::EXPECTED_NUMBER, &tk));
+        int64_t val = 0; std::from_chars(tk.lexeme.data(), tk.lexeme.data() + tk.lexeme.size(), val);
+        if (val < INT16_MIN || val > INT16_MAX) return Status::error(ErrorCode::IMMEDIATE_OUT_OF_RANGE, tk.line, tk.col);
+        emit_u16(static_cast<uint16_t>(static_cast<int16_t>(val)));
+    }
     else if (type == ArgType::F64) {
         MASM_CHECK(consume(TokenType::NUMBER_FLOAT, ErrorCode::EXPECTED_DOUBLE, &tk));
         double val; std::from_chars(tk.lexeme.data(), tk.lexeme.data() + tk.lexeme.size(), val);
@@ -301,6 +312,277 @@ Status Assembler::patch_labels() {
     return Status::ok();
 }
 
+namespace {
+namespace an = meow::jit::analysis;
+
+bool has_try(const an::DecodedCode& code) {
+    return std::any_of(code.insns.begin(), code.insns.end(),
+                       [](const an::Instruction& insn) { return insn.op == OpCode::SETUP_TRY; });
+}
+
+// Register local lớn nhất bị closure con capture (upvalue mở), -1 nếu không có
+int max_captured_reg(const std::vector<Prototype>& protos, const Prototype& p, const an::DecodedCode& code) {
+    int max_captured = -1;
+    for (const auto& insn : code.insns) {
+        if (insn.op != OpCode::CLOSURE) continue;
+
+        const auto ops = an::read_operands(p.bytecode.data(), insn.offset);
+        const size_t const_idx = static_cast<size_t>(ops[1]);
+        if (const_idx >= p.constants.size() || p.constants[const_idx].type != ConstType::PROTO_REF_T) continue;
+        for (const auto& uv : protos[p.constants[const_idx].proto_index].upvalues) {
+            if (uv.is_local) max_captured = std::max(max_captured, static_cast<int>(uv.index));
+        }
+    }
+    return max_captured;
+}
+
+// Dạng immediate (bản register 16-bit) của phép toán/so sánh/nhảy so sánh, NOP nếu không có.
+// Dựa vào thứ tự liên tiếp của các nhóm trong enum OpCode.
+OpCode imm_form(OpCode op) {
+    auto in = [op](OpCode first, OpCode last) { return op >= first && op <= last; };
+    auto shift = [op](OpCode from, OpCode to) {
+        return static_cast<OpCode>(static_cast<uint8_t>(to) + (static_cast<uint8_t>(op) - static_cast<uint8_t>(from)));
+    };
+    using enum OpCode;
+    if (in(ADD, MUL))                   return shift(ADD, ADD_I);
+    if (in(ADD_B, MUL_B))               return shift(ADD_B, ADD_I);
+    if (in(EQ, LE))                     return shift(EQ, EQ_I);
+    if (in(EQ_B, LE_B))                 return shift(EQ_B, EQ_I);
+    if (in(JUMP_IF_EQ, JUMP_IF_LE))     return shift(JUMP_IF_EQ, JUMP_IF_EQ_I);
+    if (in(JUMP_IF_EQ_B, JUMP_IF_LE_B)) return shift(JUMP_IF_EQ_B, JUMP_IF_EQ_I);
+    return NOP;
+}
+
+// Bản _B của lệnh immediate (mọi register < 256)
+OpCode narrow_imm(OpCode op) {
+    using enum OpCode;
+    const uint8_t v = static_cast<uint8_t>(op);
+    if (op >= ADD_I && op <= MUL_I) return static_cast<OpCode>(v + (static_cast<uint8_t>(ADD_I_B) - static_cast<uint8_t>(ADD_I)));
+    if (op >= EQ_I && op <= LE_I) return static_cast<OpCode>(v + (static_cast<uint8_t>(EQ_I_B) - static_cast<uint8_t>(EQ_I)));
+    if (op >= JUMP_IF_EQ_I && op <= JUMP_IF_LE_I) return static_cast<OpCode>(v + (static_cast<uint8_t>(JUMP_IF_EQ_I_B) - static_cast<uint8_t>(JUMP_IF_EQ_I)));
+    return op;
+}
+
+// Đổi chỗ hai toán hạng: a OP b == b OP' a. Chỉ so sánh mới đổi được:
+// ADD/MUL với string/array đi qua OperatorDispatcher theo đúng thứ tự (1 + "a" != "a" + 1) -> NOP
+OpCode mirror_form(OpCode op) {
+    using enum OpCode;
+    switch (op) {
+        case ADD: case ADD_B: case SUB: case SUB_B: case MUL: case MUL_B: return NOP;
+        case GT: return LT; case GE: return LE; case LT: return GT; case LE: return GE;
+        case GT_B: return LT_B; case GE_B: return LE_B; case LT_B: return GT_B; case LE_B: return GE_B;
+        case JUMP_IF_GT: return JUMP_IF_LT; case JUMP_IF_GE: return JUMP_IF_LE;
+        case JUMP_IF_LT: return JUMP_IF_GT; case JUMP_IF_LE: return JUMP_IF_GE;
+        case JUMP_IF_GT_B: return JUMP_IF_LT_B; case JUMP_IF_GE_B: return JUMP_IF_LE_B;
+        case JUMP_IF_LT_B: return JUMP_IF_GT_B; case JUMP_IF_LE_B: return JUMP_IF_GE_B;
+        default: return op;
+    }
+}
+
+// CMP_I c, a, #k -> JUMP_IF_CMP_I a, #k, off (NOP nếu không phải so sánh immediate)
+OpCode imm_jump_form(OpCode op) {
+    using enum OpCode;
+    if (op >= EQ_I && op <= LE_I)
+        return static_cast<OpCode>(static_cast<uint8_t>(JUMP_IF_EQ_I) + (static_cast<uint8_t>(op) - static_cast<uint8_t>(EQ_I)));
+    if (op >= EQ_I_B && op <= LE_I_B)
+        return static_cast<OpCode>(static_cast<uint8_t>(JUMP_IF_EQ_I) + (static_cast<uint8_t>(op) - static_cast<uint8_t>(EQ_I_B)));
+    return NOP;
+}
+
+// Vị trí (tính từ đầu lệnh) của operand thứ idx theo OpSchema
+size_t operand_pos(const OpSchema& schema, size_t idx) {
+    size_t pos = 1;
+    for (size_t i = 0; i < idx; ++i) pos += (schema.args[i] == ArgType::REG8) ? 1 : 2;
+    return pos;
+}
+
+// Encode lệnh gộp (chỉ REG8/REG16/I16/OFFSET16)
+void encode_insn(std::vector<uint8_t>& out, OpCode op, std::span<const int64_t> operands) {
+    const OpSchema& schema = get_op_schema(op);
+    out.push_back(static_cast<uint8_t>(op));
+    for (uint8_t i = 0; i < schema.count; ++i) {
+        const uint16_t v = static_cast<uint16_t>(operands[i]);
+        out.push_back(v & 0xFF);
+        if (schema.args[i] != ArgType::REG8) out.push_back((v >> 8) & 0xFF);
+    }
+}
+
+} // namespace
+
+// Immediate: LOAD_INT t, #k (k vừa int16) + phép toán/so sánh/nhảy so sánh đọc t -> dạng _I,
+// rồi CMP_I c, a, #k + JUMP_IF_TRUE c -> JUMP_IF_CMP_I a, #k.
+// Chỉ gộp khi t (hoặc c) chết sau lệnh thứ hai, lệnh thứ hai không phải đích nhảy
+// và t không bị closure capture. Bỏ qua hàm có try/catch (như select_call_windows).
+// Bytecode được dựng lại, offset nhảy và bảng dòng được ánh xạ sang vị trí mới.
+void Assembler::fold_immediates() {
+    struct Fused {
+        OpCode op;
+        std::array<int64_t, 3> operands;
+    };
+
+    for (auto& p : protos_) {
+        for (bool changed = true; changed && !p.bytecode.empty();) {
+            changed = false;
+            const an::DecodedCode code = an::decode(p.bytecode.data(), p.bytecode.size());
+            if (!code.valid || has_try(code)) break;
+
+            const size_t n = code.insns.size();
+            const int max_captured = max_captured_reg(protos_, p, code);
+            const uint16_t num_regs = std::max<uint16_t>(code.num_regs, static_cast<uint16_t>(p.num_regs));
+            const an::Liveness live(code.insns, num_regs);
+
+            std::vector<bool> is_target(n + 1, false);
+            for (const auto& insn : code.insns) {
+                if (insn.target != an::NO_INDEX) is_target[insn.target] = true;
+            }
+
+            // fused[i]: lệnh i và i + 1 được thay bằng một lệnh
+            std::vector<std::optional<Fused>> fused(n);
+            for (size_t i = 0; i + 1 < n; ++i) {
+                const auto& first = code.insns[i];
+                const auto& second = code.insns[i + 1];
+                if (is_target[i + 1]) continue;
+
+                const auto a_ops = an::read_operands(p.bytecode.data(), first.offset);
+                const auto b_ops = an::read_operands(p.bytecode.data(), second.offset);
+
+                if (first.op == OpCode::LOAD_INT || first.op == OpCode::LOAD_INT_B) {
+                    const int64_t t = a_ops[0], k = a_ops[1];
+                    if (k < INT16_MIN || k > INT16_MAX || t <= max_captured) continue;
+
+                    if (imm_form(second.op) == OpCode::NOP) continue;
+
+                    // Nhảy so sánh: (a, b, off), còn lại: (dst, a, b)
+                    const bool is_jump = get_op_schema(second.op).args[2] == ArgType::OFFSET16;
+                    const size_t lhs = is_jump ? 0 : 1;
+                    const bool t_dead = (!is_jump && b_ops[0] == t) || !live.is_live_out(i + 1, static_cast<uint16_t>(t));
+                    if (!t_dead) continue;
+
+                    OpCode op = second.op;
+                    int64_t other;
+                    if (b_ops[lhs + 1] == t && b_ops[lhs] != t) other = b_ops[lhs];
+                    else if (b_ops[lhs] == t && b_ops[lhs + 1] != t) { op = mirror_form(op); other = b_ops[lhs + 1]; }
+                    else continue;
+                    if (op == OpCode::NOP) continue;
+
+                    Fused f{imm_form(op), {}};
+                    if (is_jump) f.operands = {other, k, 0};
+                    else f.operands = {b_ops[0], other, k};
+                    if (other < 256 && (is_jump || b_ops[0] < 256)) f.op = narrow_imm(f.op);
+                    fused[i] = f;
+                    ++i; changed = true;
+                }
+                else if (second.op == OpCode::JUMP_IF_TRUE || second.op == OpCode::JUMP_IF_TRUE_B) {
+                    OpCode op = imm_jump_form(first.op);
+                    if (op == OpCode::NOP) continue;
+                    const int64_t c = a_ops[0], a = a_ops[1];
+                    if (b_ops[0] != c || a == c) continue;
+                    if (live.is_live_out(i + 1, static_cast<uint16_t>(c))) continue;
+                    if (a < 256) op = narrow_imm(op);
+
+                    fused[i] = Fused{op, {a, a_ops[2], 0}};
+                    ++i; changed = true;
+                }
+            }
+            if (!changed) break;
+
+            // Dựng lại bytecode: lệnh giữ nguyên chép cả inline cache, offset nhảy vá lại sau
+            struct JumpFix { size_t pos; size_t next_ip; size_t old_target; };
+            std::vector<uint8_t> out;
+            out.reserve(p.bytecode.size());
+            std::unordered_map<size_t, size_t> new_offset;
+            std::vector<JumpFix> fixes;
+
+            auto old_next = [&](size_t i) { return i + 1 < n ? code.insns[i + 1].offset : p.bytecode.size(); };
+            auto old_target = [&](size_t i) {
+                const OpCode op = code.insns[i].op;
+                const OpSchema& schema = get_op_schema(op);
+                const auto ops = an::read_operands(p.bytecode.data(), code.insns[i].offset);
+                for (uint8_t a = 0; a < schema.count; ++a) {
+                    if (schema.args[a] == ArgType::OFFSET16) return std::pair{operand_pos(schema, a), static_cast<size_t>(static_cast<int64_t>(old_next(i)) + ops[a])};
+                }
+                return std::pair{size_t{0}, an::NO_INDEX};
+            };
+
+            for (size_t i = 0; i < n; ++i) {
+                const size_t start = out.size();
+                new_offset[code.insns[i].offset] = start;
+
+                if (fused[i]) {
+                    new_offset[code.insns[i + 1].offset] = start;
+                    encode_insn(out, fused[i]->op, fused[i]->operands);
+                    if (auto [pos, target] = old_target(i + 1); target != an::NO_INDEX) {
+                        const OpSchema& schema = get_op_schema(fused[i]->op);
+                        fixes.push_back({start + operand_pos(schema, schema.count - 1), out.size(), target});
+                    }
+                    ++i;
+                    continue;
+                }
+
+                out.insert(out.end(), p.bytecode.begin() + code.insns[i].offset, p.bytecode.begin() + old_next(i));
+                if (auto [pos, target] = old_target(i); target != an::NO_INDEX) {
+                    fixes.push_back({start + pos, start + (old_next(i) - code.insns[i].offset), target});
+                }
+            }
+            new_offset[p.bytecode.size()] = out.size();
+
+            for (const auto& fix : fixes) {
+                const int32_t offset = static_cast<int32_t>(new_offset.at(fix.old_target)) - static_cast<int32_t>(fix.next_ip);
+                out[fix.pos] = offset & 0xFF;
+                out[fix.pos + 1] = (offset >> 8) & 0xFF;
+            }
+
+            // Bảng dòng: hai lệnh gộp chung offset thì giữ dòng của lệnh sau
+            std::vector<LineInfo> lines;
+            lines.reserve(p.lines.size());
+            for (LineInfo li : p.lines) {
+                if (auto it = new_offset.find(li.offset); it != new_offset.end()) li.offset = static_cast<uint32_t>(it->second);
+                if (!lines.empty() && lines.back().offset == li.offset) lines.back() = li;
+                else lines.push_back(li);
+            }
+
+            p.bytecode = std::move(out);
+            p.lines = std::move(lines);
+        }
+    }
+}
+
+// Register window: CALL / CALL_VOID -> CALL_WINDOW / CALL_VOID_WINDOW khi mọi register từ arg_start
+// trở lên (trừ dst) chết sau lệnh gọi, để frame callee nằm đè lên vùng tham số thay vì chép.
+// Đặt tham số ở các register cao nhất của hàm để được chọn.
+// Bỏ qua hàm có try/catch (liveness không có edge ngoại lệ) và register bị closure capture (upvalue mở).
+void Assembler::select_call_windows() {
+    for (auto& p : protos_) {
+        if (p.bytecode.empty()) continue;
+        const an::DecodedCode code = an::decode(p.bytecode.data(), p.bytecode.size());
+        if (!code.valid) continue;
+
+        if (has_try(code)) continue;
+        const int max_captured = max_captured_reg(protos_, p, code);
+
+        const uint16_t num_regs = std::max<uint16_t>(code.num_regs, static_cast<uint16_t>(p.num_regs));
+        const an::Liveness live(code.insns, num_regs);
+
+        for (size_t i = 0; i < code.insns.size(); ++i) {
+            const size_t offset = code.insns[i].offset;
+            const OpCode raw = static_cast<OpCode>(p.bytecode[offset]);
+            if (raw != OpCode::CALL && raw != OpCode::CALL_VOID) continue;
+
+            const auto ops = an::read_operands(p.bytecode.data(), offset);
+            const bool has_dst = raw == OpCode::CALL;
+            const int64_t dst = has_dst ? ops[0] : -1;
+            const int64_t arg_start = has_dst ? ops[2] : ops[1];
+            if (arg_start <= max_captured) continue;
+
+            bool safe = true;
+            for (uint16_t r : live.live_out(i)) {
+                if (r >= arg_start && r != dst) { safe = false; break; }
+            }
+            if (safe) p.bytecode[offset] = static_cast<uint8_t>(has_dst ? OpCode::CALL_WINDOW : OpCode::CALL_VOID_WINDOW);
+        }
+    }
+}
+
 std::string Assembler::parse_string_literal(std::string_view sv) {
     if (sv.length() >= 2) sv = sv.substr(1, sv.length() - 2);
     std::string res; res.reserve(sv.length());
@@ -382,6 +664,8 @@ Status Assembler::assemble() {
     while (!is_at_end()) { MASM_CHECK(parse_statement()); }
     MASM_CHECK(link_proto_refs());
     MASM_CHECK(patch_labels());
+    fold_immediates();
+    select_call_windows();
     return Status::ok();
 }
 
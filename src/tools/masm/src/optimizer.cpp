@@ -1,11 +1,13 @@
 #include <meow/masm/optimizer.h>
 #include <meow/bytecode/op_codes.h>
+#include "analysis/bytecode_analysis.h"
 #include <iostream>
 #include <algorithm>
 #include <print>
 #include <bit>
 #include <set>
 #include <cmath> 
+#include <array>
 
 namespace meow::masm {
 
@@ -406,18 +408,75 @@ bool Optimizer::pass_reg_alloc() {
 }
 
 void Optimizer::build_liveness() {
+    namespace an = meow::jit::analysis;
     intervals_.clear();
-    int pc = 0;
-    for (const auto& inst : ir_code_) {
+
+    // IR -> analysis::Instruction (label là NOP mang LabelIdx, nhảy tới vị trí của NOP đó)
+    std::map<uint32_t, size_t> label_pos;
+    for (size_t pc = 0; pc < ir_code_.size(); ++pc) {
+        const auto& inst = ir_code_[pc];
+        if (inst.op == meow::OpCode::NOP && inst.arg_count > 0 && inst.args[0].is<LabelIdx>()) {
+            label_pos[inst.args[0].unsafe_get<LabelIdx>().id] = pc;
+        }
+    }
+
+    const size_t n = ir_code_.size();
+    std::vector<an::Instruction> insns(n);
+    uint16_t num_regs = 0;
+    std::vector<int64_t> operands;
+    for (size_t pc = 0; pc < n; ++pc) {
+        const auto& inst = ir_code_[pc];
+        an::Instruction& out = insns[pc];
+        out.offset = pc;
+        out.op = inst.op;
+
+        operands.clear();
         for (int k = 0; k < inst.arg_count; ++k) {
             inst.args[k].visit(
-                [&](Reg r) {
-                    if (intervals_.find(r.id) == intervals_.end()) intervals_[r.id] = {r.id, pc, pc};
-                    else intervals_[r.id].end = pc;
+                [&](Reg r) { operands.push_back(r.id); },
+                [&](int64_t v) { operands.push_back(v); },
+                [&](LabelIdx l) {
+                    operands.push_back(0);
+                    if (auto it = label_pos.find(l.id); it != label_pos.end()) out.target = it->second;
                 },
+                [&](auto) { operands.push_back(0); }
+            );
+        }
+        if (inst.op != meow::OpCode::NOP) {
+            an::OperandEffects fx = an::operand_effects(inst.op, operands);
+            out.uses = std::move(fx.uses);
+            out.def = fx.def;
+        }
+        for (uint16_t r : out.uses) num_regs = std::max<uint16_t>(num_regs, r + 1);
+        if (out.def >= 0) num_regs = std::max<uint16_t>(num_regs, out.def + 1);
+
+        if (an::is_function_exit(inst.op)) continue;
+        if (inst.op != meow::OpCode::JUMP || out.target == an::NO_INDEX) out.succs.push_back(pc + 1);
+        if (out.target != an::NO_INDEX && out.target != pc + 1) out.succs.push_back(out.target);
+    }
+
+    const an::Liveness live(insns, num_regs);
+
+    auto touch = [&](uint16_t r, int pc) {
+        auto it = intervals_.find(r);
+        if (it == intervals_.end()) intervals_[r] = {r, pc, pc};
+        else {
+            it->second.start = std::min(it->second.start, pc);
+            it->second.end = std::max(it->second.end, pc);
+        }
+    };
+
+    for (size_t pc = 0; pc < n; ++pc) {
+        const auto& inst = ir_code_[pc];
+        for (int k = 0; k < inst.arg_count; ++k) {
+            inst.args[k].visit(
+                [&](Reg r) { touch(r.id, (int)pc); },
                 [](auto) {}
             );
         }
+        // Register sống xuyên qua lệnh (vd: qua back-edge của loop) cũng chiếm interval
+        for (uint16_t r : live.live_in(pc)) touch(r, (int)pc);
+        for (uint16_t r : live.live_out(pc)) touch(r, (int)pc);
         
         if (inst.op == meow::OpCode::MOVE && inst.arg_count >= 2 && 
             inst.args[0].is<Reg>() && inst.args[1].is<Reg>()) {
@@ -434,7 +493,6 @@ void Optimizer::build_liveness() {
                  }
              }
         }
-        pc++;
     }
 }
 
@@ -464,6 +522,40 @@ static meow::OpCode to_byte_op(meow::OpCode op) {
     }
 }
 
+// Superinstruction: opcode của lệnh đầu trong chuỗi khớp được thay bằng SUPER_*, ưu tiên chuỗi dài.
+// Các lệnh sau giữ nguyên trong bytecode nên label trỏ vào giữa chuỗi vẫn đúng.
+static void fuse_superinstructions(const std::vector<IrInstruction*>& code) {
+    struct Pattern {
+        std::array<meow::OpCode, 3> ops;
+        size_t len;
+        meow::OpCode super;
+    };
+    static const std::vector<Pattern> patterns = [] {
+        using enum meow::OpCode;
+        std::vector<Pattern> p;
+        #define MEOW_SUPER_PATTERN2(NAME, A, A_BYTES, B) p.push_back({{A, B, NOP}, 2, NAME});
+        #define MEOW_SUPER_PATTERN3(NAME, A, A_BYTES, B, B_BYTES, C) p.push_back({{A, B, C}, 3, NAME});
+        MEOW_SUPER_OPS(MEOW_SUPER_PATTERN2, MEOW_SUPER_PATTERN3)
+        #undef MEOW_SUPER_PATTERN2
+        #undef MEOW_SUPER_PATTERN3
+        std::stable_sort(p.begin(), p.end(), [](const Pattern& a, const Pattern& b) { return a.len > b.len; });
+        return p;
+    }();
+
+    for (size_t i = 0; i < code.size(); ) {
+        const Pattern* hit = nullptr;
+        for (const Pattern& p : patterns) {
+            if (i + p.len > code.size()) continue;
+            bool match = true;
+            for (size_t k = 0; k < p.len && match; ++k) match = code[i + k]->op == p.ops[k];
+            if (match) { hit = &p; break; }
+        }
+        if (!hit) { ++i; continue; }
+        code[i]->op = hit->super;
+        i += hit->len;
+    }
+}
+
 void Optimizer::rewrite_proto() {
     uint16_t max_phys = 0;
     
@@ -506,27 +598,36 @@ void Optimizer::rewrite_proto() {
     std::vector<Patch> patches;
     std::map<uint32_t, size_t> label_locs;
 
+    // Chốt opcode cuối cùng (dạng _B, bỏ MOVE r, r) trước khi gộp superinstruction
+    std::vector<IrInstruction*> emitted;
     for (auto& inst : ir_code_) {
-        if (inst.op == meow::OpCode::NOP && inst.arg_count > 0 && inst.args[0].is<LabelIdx>()) {
-            label_locs[inst.args[0].unsafe_get<LabelIdx>().id] = proto_.bytecode.size();
-            continue;
-        }
         if (inst.op == meow::OpCode::NOP) continue;
 
         if (inst.op == meow::OpCode::MOVE && inst.arg_count >= 2) {
              if (inst.args[0].is<Reg>() && inst.args[1].is<Reg>()) {
                  if (inst.args[0].unsafe_get<Reg>().id == inst.args[1].unsafe_get<Reg>().id) {
+                     inst.op = meow::OpCode::NOP;
                      continue; 
                  }
              }
         }
 
         if (use_byte_ops) inst.op = to_byte_op(inst.op);
+        emitted.push_back(&inst);
+    }
+    if (has_flag(config_.flags, OptFlags::SuperInstr)) fuse_superinstructions(emitted);
+
+    for (auto& inst : ir_code_) {
+        if (inst.op == meow::OpCode::NOP && inst.arg_count > 0 && inst.args[0].is<LabelIdx>()) {
+            label_locs[inst.args[0].unsafe_get<LabelIdx>().id] = proto_.bytecode.size();
+            continue;
+        }
+        if (inst.op == meow::OpCode::NOP) continue;
 
         emit_byte(static_cast<uint8_t>(inst.op));
         
         int written_bytes = 0;
-        bool is_byte_mode = is_byte_op(inst.op);
+        bool is_byte_mode = is_byte_op(meow::generic_op(inst.op)); // Superinstruction: theo lệnh đầu
 
         for(int k=0; k < inst.arg_count; ++k) {
             inst.args[k].visit(
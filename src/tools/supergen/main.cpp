@@ -0,0 +1,190 @@
+/**
+ * @file main.cpp
+ * @brief meow-supergen: chọn superinstruction từ profile n-gram và sinh include/meow/bytecode/super_ops.h
+ *
+ * Usage: meow-supergen [--max N] [-o out.h] <profile.txt>...
+ * Nhiều profile được cộng dồn. Điểm của một ứng viên = số lần dispatch tiết kiệm được
+ * (cặp: count, bộ ba: 2 * count). Bộ ba chồng lên cặp đã chọn vẫn được tính đủ điểm:
+ * masm gộp chuỗi dài trước nên cặp chỉ dùng ở chỗ bộ ba không khớp.
+ */
+
+#include <meow/bytecode/op_codes.h>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <print>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace meow;
+
+namespace {
+
+    struct Candidate {
+        std::vector<OpCode> ops;
+        uint64_t count = 0;
+        uint64_t score() const { return count * (ops.size() - 1); }
+    };
+
+    std::unordered_map<std::string_view, OpCode> build_name_map() {
+        std::unordered_map<std::string_view, OpCode> names;
+        for (size_t i = 0; i < static_cast<size_t>(OpCode::TOTAL_OPCODES); ++i) {
+            OpCode op = static_cast<OpCode>(i);
+            if (generic_op(op) != op) continue; // Quickened / superinstruction không nằm trong profile
+            names.emplace(meow::enum_name(op), op);
+        }
+        return names;
+    }
+
+    // Lệnh kết thúc frame / luồng, hay nhảy vô điều kiện ở giữa chuỗi: gộp không có ích
+    bool fusible(OpCode op, bool last) {
+        switch (op) {
+            case OpCode::NOP: case OpCode::HALT:
+            case OpCode::RETURN: case OpCode::TAIL_CALL: case OpCode::THROW:
+                return false;
+            case OpCode::JUMP:
+                return last;
+            default:
+                return true;
+        }
+    }
+
+    bool read_profile(const std::string& path, const std::unordered_map<std::string_view, OpCode>& names,
+                      std::map<std::vector<OpCode>, uint64_t>& counts) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            std::println(stderr, "Error: Cannot open profile '{}'.", path);
+            return false;
+        }
+        std::string line;
+        size_t line_no = 0;
+        while (std::getline(in, line)) {
+            ++line_no;
+            if (line.empty() || line[0] == '#') continue;
+
+            std::istringstream ss(line);
+            uint64_t count = 0;
+            std::vector<OpCode> ops;
+            std::string word;
+            if (!(ss >> count)) {
+                std::println(stderr, "Warning: {}:{}: bad line, skipped.", path, line_no);
+                continue;
+            }
+            bool ok = true;
+            while (ss >> word) {
+                auto it = names.find(word);
+                if (it == names.end()) { ok = false; break; }
+                ops.push_back(it->second);
+            }
+            // Opcode lạ (profile từ bản VM khác) thì bỏ qua dòng
+            if (!ok || ops.size() < 2 || ops.size() > 3) continue;
+            counts[ops] += count;
+        }
+        return true;
+    }
+
+    std::string super_name(const std::vector<OpCode>& ops) {
+        std::string name = "SUPER";
+        for (OpCode op : ops) {
+            name += '_';
+            name += meow::enum_name(op);
+        }
+        return name;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Opcode còn trống trong 1 byte sau khi bỏ superinstruction đang có
+    const size_t base_ops = static_cast<size_t>(OpCode::TOTAL_OPCODES) - SUPER_OP_COUNT;
+    const size_t capacity = 256 - base_ops;
+
+    size_t max_supers = std::min<size_t>(16, capacity);
+    std::string out_path;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if ((arg == "-o" || arg == "--max") && i + 1 >= argc) {
+            std::println(stderr, "Error: Missing value for {}.", arg);
+            return 1;
+        }
+        if (arg == "-o") {
+            out_path = argv[++i];
+        } else if (arg == "--max") {
+            std::string_view value = argv[++i];
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), max_supers);
+            if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                std::println(stderr, "Error: Invalid --max value '{}'.", value);
+                return 1;
+            }
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::println(stderr, "Usage: meow-supergen [--max N] [-o super_ops.h] <profile.txt>...");
+        return 1;
+    }
+    if (max_supers > capacity) {
+        std::println(stderr, "Warning: --max {} exceeds free opcode space, clamped to {}.", max_supers, capacity);
+        max_supers = capacity;
+    }
+
+    const auto names = build_name_map();
+    std::map<std::vector<OpCode>, uint64_t> counts;
+    for (const auto& path : inputs) {
+        if (!read_profile(path, names, counts)) return 1;
+    }
+
+    std::vector<Candidate> candidates;
+    for (const auto& [ops, count] : counts) {
+        bool ok = true;
+        for (size_t k = 0; k < ops.size() && ok; ++k) ok = fusible(ops[k], k + 1 == ops.size());
+        if (ok) candidates.push_back({ops, count});
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.score() > b.score(); });
+    if (candidates.size() > max_supers) candidates.resize(max_supers);
+
+    std::ostringstream out;
+    out << "// Sinh bởi meow-supergen (src/tools/supergen) - đừng sửa tay.\n";
+    out << "// Nguồn:";
+    for (const auto& path : inputs) out << ' ' << path;
+    out << "\n";
+    out << "// Sinh lại: meow-vm --profile-ngrams prof.txt <file> && meow-supergen prof.txt -o include/meow/bytecode/super_ops.h\n";
+    out << "//\n";
+    out << "// X2(NAME, A, A_BYTES, B)                  : A rồi B\n";
+    out << "// X3(NAME, A, A_BYTES, B, B_BYTES, C)      : A rồi B rồi C\n";
+    out << "// *_BYTES = get_op_info(op).operand_bytes (kể cả Inline Cache), kiểm bằng static_assert trong op_codes.cpp\n";
+    out << "\n#pragma once\n\n";
+    out << "#define MEOW_SUPER_OPS(X2, X3)";
+    for (const Candidate& c : candidates) {
+        out << " \\\n    X" << c.ops.size() << '(' << super_name(c.ops);
+        for (size_t k = 0; k < c.ops.size(); ++k) {
+            out << ", " << meow::enum_name(c.ops[k]);
+            if (k + 1 < c.ops.size()) out << ", " << static_cast<int>(get_op_info(c.ops[k]).operand_bytes);
+        }
+        out << ')';
+    }
+    out << "\n";
+
+    if (out_path.empty()) {
+        std::cout << out.str();
+    } else {
+        std::ofstream file(out_path);
+        if (!(file << out.str())) {
+            std::println(stderr, "Error: Cannot write '{}'.", out_path);
+            return 1;
+        }
+    }
+    for (const Candidate& c : candidates) {
+        std::println(stderr, "{:>12} dispatches saved  {}", c.score(), super_name(c.ops));
+    }
+    return 0;
+}
@@ -2,16 +2,201 @@
 #include "vm/handlers/utils.h"
 #include <meow/core/objects.h>
 #include <meow/machine.h>
+#include "jit/jit_compiler.h"
+#include "jit/jit_config.h"
+#include "jit/runtime/deopt.h"
+#include "vm/handlers/inline_cache.h"
+#include "vm/handlers/quickening.h"
 #include <cstring>
 #include <vector>
 
 namespace meow::handlers {
 
-    // Giữ lại CallIC vì nó được patch trực tiếp vào bytecode khi chạy
-    struct CallIC {
-        void* check_tag;
-        void* destination;
-    } __attribute__((packed)); 
+    // Helper: Pop Frame hiện tại và trả quyền điều khiển về caller (dùng chung cho RETURN và JIT)
+    [[gnu::always_inline]]
+    inline static const uint8_t* pop_call_frame(VMState* state, Value result) {
+        size_t base_idx = state->ctx.current_regs_ - state->ctx.stack_;
+        meow::close_upvalues(state->ctx, state->heap, base_idx);
+
+        if (state->ctx.frame_ptr_ == state->ctx.call_stack_) [[unlikely]] return nullptr; 
+
+        CallFrame* popped_frame = state->ctx.frame_ptr_;
+        
+        // Module Execution Flag
+        if (state->current_module) [[likely]] {
+             if (popped_frame->function_->get_proto() == state->current_module->get_main_proto()) [[unlikely]] {
+                 state->current_module->set_executed();
+             }
+        }
+
+        state->ctx.frame_ptr_--;
+        CallFrame* caller = state->ctx.frame_ptr_;
+        
+        state->ctx.stack_top_ = popped_frame->caller_top_;
+        state->ctx.current_regs_ = caller->regs_base_;
+        state->ctx.current_frame_ = caller; 
+        state->update_pointers(); 
+
+        if (popped_frame->ret_dest_ != nullptr) *popped_frame->ret_dest_ = result;
+        return popped_frame->ip_; 
+    }
+
+    // Helper: Mã JIT có hàm được inline dùng register phía sau vùng gốc của proto
+    // (ObjFunctionProto::reserve_registers). Frame push trước khi compile phải được nới ra.
+    [[gnu::always_inline]]
+    inline static bool reserve_jit_frame(VMState* state, proto_t proto) {
+        Value* frame_end = state->ctx.current_regs_ + proto->get_num_registers();
+        if (frame_end <= state->ctx.stack_top_) [[likely]] return true;
+        if (!state->ctx.check_overflow(frame_end - state->ctx.stack_top_)) return false;
+        for (Value* slot = state->ctx.stack_top_; slot < frame_end; ++slot) *slot = Value(null_t{});
+        state->ctx.stack_top_ = frame_end;
+        return true;
+    }
+
+    // Helper: Deopt bên trong hàm được inline. Register của callee đã nằm ở home slot
+    // (closure_slot + 1 + r), closure ở closure_slot -> dựng CallFrame như CALL rồi chạy tiếp trong callee.
+    // Site CALL bị ghi nhận là đã deopt nên lần compile sau không inline nữa.
+    inline static const uint8_t* deopt_inlined_frame(VMState* state, proto_t proto, jit::JitResult result) {
+        const size_t call_offset = result.value;
+        const uint16_t closure_slot = static_cast<uint16_t>(result.deopt_offset >> 32);
+        const size_t callee_offset = static_cast<uint32_t>(result.deopt_offset);
+        jit::deoptimize(proto, call_offset);
+
+        const uint8_t* call_ip = state->instruction_base + call_offset;
+        const OpCode op = static_cast<OpCode>(*call_ip);
+        const uint8_t* ret_ip = call_ip + 1 + get_op_info(op).operand_bytes;
+
+        Value* regs = state->ctx.current_regs_;
+        Value* ret_dest = nullptr;
+        if (generic_op(op) == OpCode::CALL) {
+            uint16_t dst; std::memcpy(&dst, call_ip + 1, 2);
+            if (dst != 0xFFFF) ret_dest = &regs[dst];
+        }
+
+        if (!state->ctx.check_frame_overflow()) [[unlikely]] {
+            state->error("Stack Overflow!", call_ip);
+            return impl_PANIC(call_ip, regs, state->constants, state);
+        }
+
+        function_t closure = regs[closure_slot].as_function();
+        Value* new_base = regs + closure_slot + 1;
+        // Frame callee nằm trong vùng register của caller: RETURN phải trả stack_top_ về cuối frame caller
+        Value* caller_top = state->ctx.stack_top_;
+
+        state->ctx.frame_ptr_++;
+        *state->ctx.frame_ptr_ = CallFrame(closure, new_base, ret_dest, ret_ip, caller_top);
+
+        // Vùng của callee nằm trong frame đã được nới của caller -> không cần check overflow
+        state->ctx.current_regs_ = new_base;
+        state->ctx.stack_top_ = new_base + closure->get_proto()->get_num_registers();
+        state->ctx.current_frame_ = state->ctx.frame_ptr_;
+        state->update_pointers();
+
+        return state->instruction_base + callee_offset;
+    }
+
+    // Mã baseline gặp HALT: Interpreter chạy lệnh này để dừng như bình thường
+    inline constexpr uint8_t HALT_CODE[] = { static_cast<uint8_t>(OpCode::HALT) };
+
+    // Helper: Kết thúc một lần chạy mã máy trên frame hiện tại.
+    // Baseline trả quyền (JIT_BASELINE_EXIT) -> handler đã cập nhật frame, chạy tiếp tại IP trả về.
+    // Deopt -> register đã được ghi về stack, Interpreter chạy tiếp frame này từ offset trả về.
+    // Chạy xong -> pop frame như RETURN.
+    [[gnu::always_inline]]
+    inline static const uint8_t* finish_jit(VMState* state, proto_t proto, jit::JitResult result) {
+        if (result.deopt_offset != jit::JIT_NO_DEOPT) [[unlikely]] {
+            if (result.deopt_offset == jit::JIT_BASELINE_EXIT) {
+                const auto* next_ip = reinterpret_cast<const uint8_t*>(result.value);
+                return next_ip ? next_ip : HALT_CODE;
+            }
+            if (result.deopt_offset & jit::JIT_INLINE_DEOPT) return deopt_inlined_frame(state, proto, result);
+            jit::deoptimize(proto, result.deopt_offset);
+            return state->instruction_base + result.deopt_offset;
+        }
+        return pop_call_frame(state, Value::from_raw(result.value));
+    }
+
+    // Safepoint cho proto đang chờ compile nền: cài các job đã xong rồi đọc lại entry
+    inline static jit::JitFunc poll_background_jit(proto_t proto) {
+        auto& compiler = jit::JitCompiler::instance();
+        if (compiler.has_ready()) compiler.install_ready();
+        return reinterpret_cast<jit::JitFunc>(proto->get_jit_entry());
+    }
+
+    // Helper: Tier-up. Đếm số lần gọi proto, compile khi chạm JIT_THRESHOLD.
+    // Frame của callee phải được push xong trước khi gọi.
+    // Trả về IP của caller nếu hàm đã chạy xong bằng mã máy, IP trong hàm nếu mã máy deopt,
+    // nullptr nếu tiếp tục bằng Interpreter từ đầu hàm.
+    [[gnu::always_inline]]
+    inline static const uint8_t* try_enter_jit(VMState* state, proto_t proto) {
+        auto entry = reinterpret_cast<jit::JitFunc>(proto->get_jit_entry());
+        if (!entry) [[likely]] {
+            if (proto->is_jit_queued()) [[unlikely]] {
+                entry = poll_background_jit(proto);
+            } else {
+                if (proto->tick_hotness() != jit::JIT_THRESHOLD) [[likely]] return nullptr;
+
+                // Chỉ thử compile đúng 1 lần, hàm bị từ chối sẽ ở lại Interpreter
+                // (mã bị evict khỏi Code Cache -> hotness reset, được compile lại khi nóng trở lại).
+                // Compile nền: chạy tiếp bằng Interpreter, mã được cài ở lần gọi sau.
+                entry = jit::JitCompiler::instance().request_compile(proto);
+            }
+            if (!entry) return nullptr;
+        }
+
+        // Frame đáy (script) không có caller để quay về
+        if (state->ctx.frame_ptr_ == state->ctx.call_stack_) [[unlikely]] return nullptr;
+        if (!reserve_jit_frame(state, proto)) [[unlikely]] return nullptr;
+
+        return finish_jit(state, proto, entry(state));
+    }
+
+    // Helper: OSR. Đếm số lần nhảy ngược, khi vòng lặp đủ nóng thì compile proto đang chạy
+    // và chuyển frame hiện tại vào mã máy tại loop header `target`.
+    // Trả về target nếu tiếp tục bằng Interpreter; ngược lại như finish_jit
+    // (nullptr khi frame đáy đã chạy xong).
+    [[gnu::always_inline]]
+    inline static const uint8_t* try_osr(VMState* state, const uint8_t* target) {
+        proto_t proto = state->ctx.frame_ptr_->function_->get_proto();
+        uint32_t count = proto->tick_backedge();
+        if (count < jit::JIT_OSR_THRESHOLD) [[likely]] return target;
+
+        auto& compiler = jit::JitCompiler::instance();
+        if (!proto->get_jit_entry()) {
+            // Chỉ thử compile 1 lần (giống tier-up theo lời gọi); compile nền thì vào ở back-edge sau khi cài xong
+            if (proto->is_jit_queued()) {
+                if (!poll_background_jit(proto)) return target;
+            } else if (count != jit::JIT_OSR_THRESHOLD || !compiler.request_compile(proto)) {
+                return target;
+            }
+        }
+
+        jit::JitFunc entry = compiler.osr_entry(proto, target - state->instruction_base);
+        if (!entry || !reserve_jit_frame(state, proto)) return target;
+
+        return finish_jit(state, proto, entry(state));
+    }
+
+    // Helper: RETURN trong Interpreter quay về frame có mã máy (callee không được JIT).
+    // Mã baseline có điểm vào ngay sau mỗi lệnh gọi -> vào lại thay vì thông dịch phần còn lại.
+    inline static const uint8_t* try_resume_jit(VMState* state, const uint8_t* ip) {
+        proto_t proto = state->ctx.frame_ptr_->function_->get_proto();
+        if (!proto->get_jit_entry()) [[likely]] return ip;
+
+        jit::JitFunc entry = jit::JitCompiler::instance().osr_entry(proto, ip - state->instruction_base);
+        if (!entry || !reserve_jit_frame(state, proto)) return ip;
+        return finish_jit(state, proto, entry(state));
+    }
+
+    // Nhảy tương đối; nhảy ngược là back-edge của vòng lặp -> cơ hội OSR
+    // (bản handler cho baseline JIT - MEOW_JIT_STENCILS - không OSR: vòng lặp đã nằm trong mã máy)
+    [[gnu::always_inline]]
+    inline static const uint8_t* take_jump(VMState* state, const uint8_t* ip, int16_t offset) {
+#ifndef MEOW_JIT_STENCILS
+        if (offset < 0) return try_osr(state, ip + offset);
+#endif
+        return ip + offset;
+    }
 
     // Helper: Push Stack Frame (Giữ nguyên logic nhưng cleanup code)
     [[gnu::always_inline]]
@@ -58,9 +243,9 @@ namespace meow::handlers {
             new_base[i] = Value(null_t{});
         }
 
-        // Push Frame
+        // Push Frame (tham số chép lên đỉnh stack -> caller_top là base mới)
         state->ctx.frame_ptr_++;
-        *state->ctx.frame_ptr_ = CallFrame(closure, new_base, ret_dest, ret_ip);
+        *state->ctx.frame_ptr_ = CallFrame(closure, new_base, ret_dest, ret_ip, new_base);
         
         // Update State Pointers
         state->ctx.current_regs_ = new_base;
@@ -68,6 +253,8 @@ namespace meow::handlers {
         state->ctx.current_frame_ = state->ctx.frame_ptr_;
         state->update_pointers(); 
 
+        if (const uint8_t* ret_ip = try_enter_jit(state, proto)) return ret_ip;
+
         // Jump to function code
         return state->instruction_base; 
     }
@@ -93,7 +280,7 @@ namespace meow::handlers {
             long current_depth = state->ctx.frame_ptr_ - state->ctx.call_stack_;
             while (current_depth > (long)handler.frame_depth_) {
                 size_t reg_idx = state->ctx.frame_ptr_->regs_base_ - state->ctx.stack_;
-                meow::close_upvalues(state->ctx, reg_idx);
+                meow::close_upvalues(state->ctx, state->heap, reg_idx);
                 state->ctx.frame_ptr_--;
                 current_depth--;
             }
@@ -134,7 +321,7 @@ namespace meow::handlers {
     inline static const uint8_t* impl_JUMP(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
         // Load i16 -> IP đã tự tăng 2 byte
         auto [offset] = decode::args<i16>(ip);
-        return ip + offset; 
+        return take_jump(state, ip, offset); 
     }
 
     [[gnu::always_inline]] 
@@ -145,7 +332,7 @@ namespace meow::handlers {
         Value& cond = regs[cond_idx];
         bool truthy = cond.is_bool() ? cond.as_bool() : (cond.is_int() ? (cond.as_int() != 0) : meow::to_bool(cond));
         
-        if (truthy) return ip + offset;
+        if (truthy) return take_jump(state, ip, offset);
         return ip;
     }
 
@@ -156,7 +343,7 @@ namespace meow::handlers {
         Value& cond = regs[cond_idx];
         bool truthy = cond.is_bool() ? cond.as_bool() : (cond.is_int() ? (cond.as_int() != 0) : meow::to_bool(cond));
         
-        if (!truthy) return ip + offset;
+        if (!truthy) return take_jump(state, ip, offset);
         return ip;
     }
 
@@ -170,7 +357,7 @@ namespace meow::handlers {
         Value& cond = regs[cond_idx];
         bool truthy = cond.is_bool() ? cond.as_bool() : (cond.is_int() ? (cond.as_int() != 0) : meow::to_bool(cond));
         
-        if (truthy) return ip + offset;
+        if (truthy) return take_jump(state, ip, offset);
         return ip;
     }
 
@@ -181,7 +368,7 @@ namespace meow::handlers {
         Value& cond = regs[cond_idx];
         bool truthy = cond.is_bool() ? cond.as_bool() : (cond.is_int() ? (cond.as_int() != 0) : meow::to_bool(cond));
         
-        if (!truthy) return ip + offset;
+        if (!truthy) return take_jump(state, ip, offset);
         return ip;
     }
 
@@ -192,36 +379,13 @@ namespace meow::handlers {
         auto [ret_reg_idx] = decode::args<u16>(ip);
         
         Value result = (ret_reg_idx == 0xFFFF) ? Value(null_t{}) : regs[ret_reg_idx];
-
-        size_t base_idx = state->ctx.current_regs_ - state->ctx.stack_;
-        meow::close_upvalues(state->ctx, base_idx);
-
-        if (state->ctx.frame_ptr_ == state->ctx.call_stack_) [[unlikely]] return nullptr; 
-
-        CallFrame* popped_frame = state->ctx.frame_ptr_;
-        
-        // Module Execution Flag
-        if (state->current_module) [[likely]] {
-             if (popped_frame->function_->get_proto() == state->current_module->get_main_proto()) [[unlikely]] {
-                 state->current_module->set_executed();
-             }
-        }
-
-        state->ctx.frame_ptr_--;
-        CallFrame* caller = state->ctx.frame_ptr_;
-        
-        state->ctx.stack_top_ = popped_frame->regs_base_;
-        state->ctx.current_regs_ = caller->regs_base_;
-        state->ctx.current_frame_ = caller; 
-        state->update_pointers(); 
-
-        if (popped_frame->ret_dest_ != nullptr) *popped_frame->ret_dest_ = result;
-        return popped_frame->ip_; 
+        return pop_call_frame(state, result);
     }
 
     // --- CALL INFRASTRUCTURE ---
 
-template <bool IsVoid>
+    // Window: frame callee bắt đầu tại regs[arg_start] (CALL_WINDOW), tham số đã nằm sẵn chỗ
+    template <bool IsVoid, bool Window = false>
     [[gnu::always_inline]] 
     static inline const uint8_t* do_call(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
         u16 dst = 0xFFFF;
@@ -262,6 +426,8 @@ template <bool IsVoid>
         if (callee.is_function()) [[likely]] {
             closure = callee.as_function();
             if (ic->check_tag == closure->get_proto()) [[likely]] goto SETUP_FRAME;
+            // Lần đầu -> site monomorphic; đổi callee -> không còn inline được
+            const_cast<CallIC*>(ic)->destination = ic->check_tag ? nullptr : closure->get_proto();
             const_cast<CallIC*>(ic)->check_tag = closure->get_proto();
             goto SETUP_FRAME;
         }
@@ -269,7 +435,10 @@ template <bool IsVoid>
         // --- B. Native Call ---
         if (callee.is_native()) {
             native_t fn = callee.as_native();
-            if (ic->check_tag != (void*)fn) const_cast<CallIC*>(ic)->check_tag = (void*)fn;
+            if (ic->check_tag != (void*)fn) {
+                const_cast<CallIC*>(ic)->check_tag = (void*)fn;
+                const_cast<CallIC*>(ic)->destination = nullptr;
+            }
             
             Value result = fn(&state->machine, argc, &regs[arg_start]);
             
@@ -310,7 +479,7 @@ template <bool IsVoid>
                 for (size_t i = filled; i < num_params; ++i) new_base[i] = Value(null_t{});
 
                 state->ctx.frame_ptr_++;
-                *state->ctx.frame_ptr_ = CallFrame(closure, new_base, ret_dest_ptr, ip);
+                *state->ctx.frame_ptr_ = CallFrame(closure, new_base, ret_dest_ptr, ip, new_base);
                 
                 state->ctx.current_regs_ = new_base;
                 state->ctx.stack_top_ += num_params;
@@ -367,7 +536,7 @@ template <bool IsVoid>
                 for (size_t i = 1 + copy_cnt; i < num_params; ++i) new_base[i] = Value(null_t{});
                 
                 state->ctx.frame_ptr_++;
-                *state->ctx.frame_ptr_ = CallFrame(closure, new_base, nullptr, ip);
+                *state->ctx.frame_ptr_ = CallFrame(closure, new_base, nullptr, ip, new_base);
                 state->ctx.current_regs_ = new_base;
                 state->ctx.stack_top_ += num_params;
                 state->ctx.current_frame_ = state->ctx.frame_ptr_;
@@ -383,32 +552,49 @@ template <bool IsVoid>
         {
             proto_t proto = closure->get_proto();
             size_t num_params = proto->get_num_registers();
-
-            if (!state->ctx.check_frame_overflow() || !state->ctx.check_overflow(num_params)) [[unlikely]] {
-                return ERROR<ErrOffset>(ip, regs, constants, state, 90, "Stack Overflow");
-            }
-
-            Value* new_base = state->ctx.stack_top_;
-            
             size_t safe_argc = static_cast<size_t>(argc);
-            size_t copy_count = (safe_argc < num_params) ? safe_argc : num_params;
-            
-            if (copy_count > 0) {
-                std::memcpy((void*)new_base, &regs[arg_start], copy_count * sizeof(Value));
-            }
+            Value* caller_top = state->ctx.stack_top_;
+            Value* new_base;
+
+            if constexpr (Window) {
+                // Register từ arg_start trở lên là của callee (masm đã kiểm chúng chết sau lệnh gọi).
+                // stack_top_ chỉ tăng: phần dưới đỉnh cũ vẫn thuộc frame caller, GC phải quét tiếp
+                new_base = regs + arg_start;
+                Value* new_top = new_base + num_params;
+                if (!state->ctx.check_frame_overflow() || new_top > state->ctx.stack_ + ExecutionContext::STACK_SIZE) [[unlikely]] {
+                    return ERROR<ErrOffset>(ip, regs, constants, state, 90, "Stack Overflow");
+                }
+                for (size_t i = safe_argc; i < num_params; ++i) {
+                    new_base[i] = Value(null_t{});
+                }
+                if (new_top > caller_top) state->ctx.stack_top_ = new_top;
+            } else {
+                if (!state->ctx.check_frame_overflow() || !state->ctx.check_overflow(num_params)) [[unlikely]] {
+                    return ERROR<ErrOffset>(ip, regs, constants, state, 90, "Stack Overflow");
+                }
 
-            for (size_t i = copy_count; i < num_params; ++i) {
-                new_base[i] = Value(null_t{});
+                new_base = caller_top;
+                size_t copy_count = (safe_argc < num_params) ? safe_argc : num_params;
+                
+                if (copy_count > 0) {
+                    std::memcpy((void*)new_base, &regs[arg_start], copy_count * sizeof(Value));
+                }
+
+                for (size_t i = copy_count; i < num_params; ++i) {
+                    new_base[i] = Value(null_t{});
+                }
+                state->ctx.stack_top_ += num_params;
             }
 
             state->ctx.frame_ptr_++;
-            *state->ctx.frame_ptr_ = CallFrame(closure, new_base, ret_dest_ptr, ip);
+            *state->ctx.frame_ptr_ = CallFrame(closure, new_base, ret_dest_ptr, ip, caller_top);
             
             state->ctx.current_regs_ = new_base;
-            state->ctx.stack_top_ += num_params;
             state->ctx.current_frame_ = state->ctx.frame_ptr_;
             state->update_pointers(); 
 
+            if (const uint8_t* ret_ip = try_enter_jit(state, proto)) return ret_ip;
+
             return state->instruction_base;
         }
     }
@@ -425,6 +611,16 @@ template <bool IsVoid>
         return do_call<true>(ip, regs, constants, state);
     }
 
+    [[gnu::always_inline]] 
+    inline static const uint8_t* impl_CALL_WINDOW(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
+        return do_call<false, true>(ip, regs, constants, state);
+    }
+
+    [[gnu::always_inline]] 
+    inline static const uint8_t* impl_CALL_VOID_WINDOW(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
+        return do_call<true, true>(ip, regs, constants, state);
+    }
+
     [[gnu::always_inline]] 
     static const uint8_t* impl_TAIL_CALL(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
         // 4 * u16 = 8 bytes
@@ -444,17 +640,20 @@ template <bool IsVoid>
         size_t num_params = proto->get_num_registers();
 
         size_t current_base_idx = regs - state->ctx.stack_;
-        meow::close_upvalues(state->ctx, current_base_idx);
+        meow::close_upvalues(state->ctx, state->heap, current_base_idx);
 
         size_t copy_count = (argc < num_params) ? argc : num_params;
         for (size_t i = 0; i < copy_count; ++i) regs[i] = regs[arg_start + i];
         for (size_t i = copy_count; i < num_params; ++i) regs[i] = Value(null_t{});
 
         CallFrame* current_frame = state->ctx.frame_ptr_;
-        current_frame->function_ = closure;
-        state->ctx.stack_top_ = regs + num_params;
+        current_frame->set_function(closure);
+        // Frame vào bằng register window: không hạ đỉnh xuống dưới vùng của caller
+        state->ctx.stack_top_ = std::max(regs + num_params, current_frame->caller_top_);
         state->update_pointers();
 
+        if (const uint8_t* ret_ip = try_enter_jit(state, proto)) return ret_ip;
+
         return proto->get_chunk().get_code();
     }
 
@@ -463,17 +662,21 @@ template <bool IsVoid>
     #define IMPL_CMP_JUMP(OP_NAME, OP_ENUM, OPERATOR) \
     [[gnu::always_inline]] \
     inline static const uint8_t* impl_##OP_NAME(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        const uint8_t* op_ip = ip; \
         auto [lhs, rhs, offset] = decode::args<u16, u16, i16>(ip); \
         Value& left = regs[lhs]; \
         Value& right = regs[rhs]; \
         bool condition = false; \
-        if (left.holds_both<int_t>(right)) [[likely]] { condition = (left.as_int() OPERATOR right.as_int()); } \
+        if (left.holds_both<int_t>(right)) [[likely]] { \
+            condition = (left.as_int() OPERATOR right.as_int()); \
+            quicken(state, op_ip, OpCode::OP_NAME, OpCode::OP_NAME##_II); \
+        } \
         else if (left.holds_both<float_t>(right)) { condition = (left.as_float() OPERATOR right.as_float()); } \
         else [[unlikely]] { \
             Value res = OperatorDispatcher::find(OpCode::OP_ENUM, left, right)(&state->heap, left, right); \
             condition = meow::to_bool(res); \
         } \
-        if (condition) return ip + offset; \
+        if (condition) return take_jump(state, ip, offset); \
         return ip; \
     }
 
@@ -482,6 +685,7 @@ HOT_HANDLER impl_##OP_NAME##_B(const uint8_t* ip, Value* regs, const Value* cons
     /* 1. Decode siêu tốc */ \
     /* args() đọc [u8 LHS, u8 RHS, i16 Offset] = 4 bytes */ \
     /* ip tự động tăng 4 đơn vị */ \
+    const uint8_t* op_ip = ip; \
     auto [lhs, rhs, offset] = decode::args<u8, u8, i16>(ip); \
     \
     Value& left = regs[lhs]; \
@@ -492,6 +696,7 @@ HOT_HANDLER impl_##OP_NAME##_B(const uint8_t* ip, Value* regs, const Value* cons
     /* 2. Fast Path Comparison */ \
     if (left.holds_both<int_t>(right)) [[likely]] { \
         condition = (left.as_int() OPERATOR right.as_int()); \
+        quicken(state, op_ip, OpCode::OP_NAME##_B, OpCode::OP_NAME##_II_B); \
     } \
     else if (left.holds_both<float_t>(right)) { \
         condition = (left.as_float() OPERATOR right.as_float()); \
@@ -503,7 +708,7 @@ HOT_HANDLER impl_##OP_NAME##_B(const uint8_t* ip, Value* regs, const Value* cons
     \
     /* 3. Zero-Cost Branching */ \
     /* Vì ip đã tăng sẵn tới lệnh kế tiếp, ta chỉ cần cộng offset */ \
-    if (condition) return ip + offset; \
+    if (condition) return take_jump(state, ip, offset); \
     \
     return ip; \
 }
@@ -521,7 +726,71 @@ HOT_HANDLER impl_##OP_NAME##_B(const uint8_t* ip, Value* regs, const Value* cons
     IMPL_CMP_JUMP_B(JUMP_IF_GT, GT, >)
     IMPL_CMP_JUMP_B(JUMP_IF_GE, GE, >=)
 
+    // Bản quickened: chỉ còn so sánh int, sai kiểu thì de-quicken về bản generic
+    #define IMPL_CMP_JUMP_II(OP_NAME, B, REG, OPERATOR) \
+    [[gnu::always_inline]] \
+    inline static const uint8_t* impl_##OP_NAME##_II##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        const uint8_t* op_ip = ip; \
+        auto [lhs, rhs, offset] = decode::args<REG, REG, i16>(ip); \
+        Value& left = regs[lhs]; \
+        Value& right = regs[rhs]; \
+        if (!left.holds_both<int_t>(right)) [[unlikely]] { \
+            dequicken(state, op_ip, OpCode::OP_NAME##B); \
+            return impl_##OP_NAME##B(op_ip, regs, constants, state); \
+        } \
+        if (left.as_int() OPERATOR right.as_int()) return take_jump(state, ip, offset); \
+        return ip; \
+    }
+
+    IMPL_CMP_JUMP_II(JUMP_IF_EQ, , u16, ==)
+    IMPL_CMP_JUMP_II(JUMP_IF_NEQ, , u16, !=)
+    IMPL_CMP_JUMP_II(JUMP_IF_LT, , u16, <)
+    IMPL_CMP_JUMP_II(JUMP_IF_LE, , u16, <=)
+    IMPL_CMP_JUMP_II(JUMP_IF_GT, , u16, >)
+    IMPL_CMP_JUMP_II(JUMP_IF_GE, , u16, >=)
+
+    IMPL_CMP_JUMP_II(JUMP_IF_EQ, _B, u8, ==)
+    IMPL_CMP_JUMP_II(JUMP_IF_NEQ, _B, u8, !=)
+    IMPL_CMP_JUMP_II(JUMP_IF_LT, _B, u8, <)
+    IMPL_CMP_JUMP_II(JUMP_IF_LE, _B, u8, <=)
+    IMPL_CMP_JUMP_II(JUMP_IF_GT, _B, u8, >)
+    IMPL_CMP_JUMP_II(JUMP_IF_GE, _B, u8, >=)
+
+    // Bản immediate: vế phải là hằng int16 trong lệnh.
+    // Ngoài int đều đi qua OperatorDispatcher (float so với epsilon) giống CMP_IMM_IMPL và bản register
+    #define IMPL_CMP_JUMP_I(OP_NAME, OP_ENUM, B, REG, OPERATOR) \
+    [[gnu::always_inline]] \
+    inline static const uint8_t* impl_##OP_NAME##_I##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        auto [lhs, imm, offset] = decode::args<REG, i16, i16>(ip); \
+        Value& left = regs[lhs]; \
+        bool condition = false; \
+        if (left.is_int()) [[likely]] { condition = (left.as_int() OPERATOR static_cast<int_t>(imm)); } \
+        else [[unlikely]] { \
+            Value right(static_cast<int_t>(imm)); \
+            Value res = OperatorDispatcher::find(OpCode::OP_ENUM, left, right)(&state->heap, left, right); \
+            condition = meow::to_bool(res); \
+        } \
+        if (condition) return take_jump(state, ip, offset); \
+        return ip; \
+    }
+
+    IMPL_CMP_JUMP_I(JUMP_IF_EQ, EQ, , u16, ==)
+    IMPL_CMP_JUMP_I(JUMP_IF_NEQ, NEQ, , u16, !=)
+    IMPL_CMP_JUMP_I(JUMP_IF_LT, LT, , u16, <)
+    IMPL_CMP_JUMP_I(JUMP_IF_LE, LE, , u16, <=)
+    IMPL_CMP_JUMP_I(JUMP_IF_GT, GT, , u16, >)
+    IMPL_CMP_JUMP_I(JUMP_IF_GE, GE, , u16, >=)
+
+    IMPL_CMP_JUMP_I(JUMP_IF_EQ, EQ, _B, u8, ==)
+    IMPL_CMP_JUMP_I(JUMP_IF_NEQ, NEQ, _B, u8, !=)
+    IMPL_CMP_JUMP_I(JUMP_IF_LT, LT, _B, u8, <)
+    IMPL_CMP_JUMP_I(JUMP_IF_LE, LE, _B, u8, <=)
+    IMPL_CMP_JUMP_I(JUMP_IF_GT, GT, _B, u8, >)
+    IMPL_CMP_JUMP_I(JUMP_IF_GE, GE, _B, u8, >=)
+
     #undef IMPL_CMP_JUMP
     #undef IMPL_CMP_JUMP_B
+    #undef IMPL_CMP_JUMP_II
+    #undef IMPL_CMP_JUMP_I
 
 } // namespace meow::handlers
\ No newline at end of file
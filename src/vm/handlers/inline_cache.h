@@ -0,0 +1,63 @@
+#pragma once
+#include <meow/core/shape.h>
+#include <cstdint>
+#include <cstring>
+
+namespace meow::handlers {
+
+// Inline Cache của GET_PROP/SET_PROP/INVOKE nằm ngay trong bytecode (sau operand).
+// Dùng chung giữa Interpreter và JIT (mã máy seed shape từ đây, miss handler cập nhật lại).
+
+// Inline Cache của CALL/CALL_VOID/TAIL_CALL (16 byte sau operand)
+struct CallIC {
+    void* check_tag;   // Proto (closure) hoặc native function của lần gọi gần nhất
+    void* destination; // Proto duy nhất site từng gọi, nullptr khi đã thấy callee khác/native (JIT inline theo đây)
+} __attribute__((packed));
+
+static constexpr int IC_CAPACITY = 4;
+
+struct PrimitiveShapes {
+    static inline const Shape* ARRAY  = reinterpret_cast<Shape*>(static_cast<uintptr_t>(0x1));
+    static inline const Shape* STRING = reinterpret_cast<Shape*>(static_cast<uintptr_t>(0x2));
+    static inline const Shape* OBJECT = reinterpret_cast<Shape*>(static_cast<uintptr_t>(0x3));
+
+    // Shape thật của instance (không phải ô trống hay sentinel ở trên)
+    static bool is_real(const Shape* s) noexcept { return reinterpret_cast<uintptr_t>(s) > 0x3; }
+};
+
+struct InlineCacheEntry {
+    const Shape* shape;
+    const Shape* transition;
+    uint32_t offset;
+} __attribute__((packed));
+
+struct InlineCache {
+    InlineCacheEntry entries[IC_CAPACITY];
+} __attribute__((packed));
+
+// Helper cập nhật Inline Cache (giữ nguyên logic Move-to-front)
+inline static void update_inline_cache(InlineCache* ic, const Shape* shape, const Shape* transition, uint32_t offset) {
+    for (int i = 0; i < IC_CAPACITY; ++i) {
+        if (ic->entries[i].shape == shape) {
+            if (i > 0) {
+                InlineCacheEntry temp = ic->entries[i];
+                // Move to front
+                std::memmove(&ic->entries[1], &ic->entries[0], i * sizeof(InlineCacheEntry));
+                ic->entries[0] = temp;
+                ic->entries[0].transition = transition;
+                ic->entries[0].offset = offset;
+            } else {
+                ic->entries[0].transition = transition;
+                ic->entries[0].offset = offset;
+            }
+            return;
+        }
+    }
+    // Shift right & Insert new at front
+    std::memmove(&ic->entries[1], &ic->entries[0], (IC_CAPACITY - 1) * sizeof(InlineCacheEntry));
+    ic->entries[0].shape = shape;
+    ic->entries[0].transition = transition;
+    ic->entries[0].offset = offset;
+}
+
+} // namespace meow::handlers
@@ -1,6 +1,7 @@
 #pragma once
 #include "vm/handlers/utils.h"
 #include "vm/handlers/flow_ops.h"
+#include "vm/handlers/quickening.h"
 
 namespace meow::handlers {
 
@@ -26,55 +27,92 @@ namespace meow::handlers {
         return ip; \
     }
 
-// --- ADD (Specialized Arithmetic) ---
-
-HOT_HANDLER impl_ADD(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
-    // 3 * u16 = 6 bytes. Decoder tự động dùng u64 load.
-    auto [dst, r1, r2] = decode::args<u16, u16, u16>(ip);
-    
-    Value& left = regs[r1];
-    Value& right = regs[r2];
-    
-    if (left.holds_both<int_t>(right)) [[likely]] {
-        regs[dst] = left.as_int() + right.as_int();
-    }
-    else if (left.holds_both<float_t>(right)) {
-        regs[dst] = Value(left.as_float() + right.as_float());
-    }
-    else [[unlikely]] {
-        regs[dst] = OperatorDispatcher::find(OpCode::ADD, left, right)(&state->heap, left, right);
+// --- ADD / SUB / MUL (Fast path + Quickening) ---
+// B rỗng: 16-bit regs, B = _B: 8-bit regs. Bản generic quicken sang _II/_FF theo kiểu vừa thấy,
+// bản quickened chỉ kiểm kiểu: sai thì de-quicken và chạy lại bằng bản generic.
+#define ARITH_FAST_IMPL(NAME, B, REG, OPERATOR) \
+    HOT_HANDLER impl_##NAME##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        const uint8_t* op_ip = ip; \
+        auto [dst, r1, r2] = decode::args<REG, REG, REG>(ip); \
+        Value& left = regs[r1]; \
+        Value& right = regs[r2]; \
+        if (left.holds_both<int_t>(right)) [[likely]] { \
+            regs[dst] = left.as_int() OPERATOR right.as_int(); \
+            quicken(state, op_ip, OpCode::NAME##B, OpCode::NAME##_II##B); \
+        } \
+        else if (left.holds_both<float_t>(right)) { \
+            regs[dst] = Value(left.as_float() OPERATOR right.as_float()); \
+            quicken(state, op_ip, OpCode::NAME##B, OpCode::NAME##_FF##B); \
+        } \
+        else [[unlikely]] { \
+            regs[dst] = OperatorDispatcher::find(OpCode::NAME, left, right)(&state->heap, left, right); \
+        } \
+        return ip; \
+    } \
+    HOT_HANDLER impl_##NAME##_II##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        const uint8_t* op_ip = ip; \
+        auto [dst, r1, r2] = decode::args<REG, REG, REG>(ip); \
+        Value& left = regs[r1]; \
+        Value& right = regs[r2]; \
+        if (!left.holds_both<int_t>(right)) [[unlikely]] { \
+            dequicken(state, op_ip, OpCode::NAME##B); \
+            return impl_##NAME##B(op_ip, regs, constants, state); \
+        } \
+        regs[dst] = left.as_int() OPERATOR right.as_int(); \
+        return ip; \
+    } \
+    HOT_HANDLER impl_##NAME##_FF##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        const uint8_t* op_ip = ip; \
+        auto [dst, r1, r2] = decode::args<REG, REG, REG>(ip); \
+        Value& left = regs[r1]; \
+        Value& right = regs[r2]; \
+        if (!left.holds_both<float_t>(right)) [[unlikely]] { \
+            dequicken(state, op_ip, OpCode::NAME##B); \
+            return impl_##NAME##B(op_ip, regs, constants, state); \
+        } \
+        regs[dst] = Value(left.as_float() OPERATOR right.as_float()); \
+        return ip; \
     }
-    return ip;
-}
 
-HOT_HANDLER impl_ADD_B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
-    // 3 * u8 = 3 bytes. Decoder tự động dùng u32 load.
-    auto [dst, r1, r2] = decode::args<u8, u8, u8>(ip);
-    
-    Value& left = regs[r1];
-    Value& right = regs[r2];
-    
-    if (left.holds_both<int_t>(right)) [[likely]] {
-        regs[dst] = left.as_int() + right.as_int();
-    }
-    else if (left.holds_both<float_t>(right)) {
-        regs[dst] = Value(left.as_float() + right.as_float());
-    }
-    else [[unlikely]] {
-        regs[dst] = OperatorDispatcher::find(OpCode::ADD, left, right)(&state->heap, left, right);
+ARITH_FAST_IMPL(ADD, , u16, +)
+ARITH_FAST_IMPL(SUB, , u16, -)
+ARITH_FAST_IMPL(MUL, , u16, *)
+
+ARITH_FAST_IMPL(ADD, _B, u8, +)
+ARITH_FAST_IMPL(SUB, _B, u8, -)
+ARITH_FAST_IMPL(MUL, _B, u8, *)
+
+// --- ADD_I / SUB_I / MUL_I: toán hạng phải là hằng int16 trong lệnh (không cần register tạm, không quicken) ---
+#define ARITH_IMM_IMPL(NAME, B, REG, OPERATOR) \
+    HOT_HANDLER impl_##NAME##_I##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        auto [dst, r1, imm] = decode::args<REG, REG, i16>(ip); \
+        Value& left = regs[r1]; \
+        if (left.is_int()) [[likely]] { \
+            regs[dst] = left.as_int() OPERATOR static_cast<int_t>(imm); \
+        } \
+        else if (left.is_float()) { \
+            regs[dst] = Value(left.as_float() OPERATOR static_cast<float_t>(imm)); \
+        } \
+        else [[unlikely]] { \
+            Value right(static_cast<int_t>(imm)); \
+            regs[dst] = OperatorDispatcher::find(OpCode::NAME, left, right)(&state->heap, left, right); \
+        } \
+        return ip; \
     }
-    return ip;
-}
+
+ARITH_IMM_IMPL(ADD, , u16, +)
+ARITH_IMM_IMPL(SUB, , u16, -)
+ARITH_IMM_IMPL(MUL, , u16, *)
+
+ARITH_IMM_IMPL(ADD, _B, u8, +)
+ARITH_IMM_IMPL(SUB, _B, u8, -)
+ARITH_IMM_IMPL(MUL, _B, u8, *)
 
 // --- Arithmetic Ops ---
-BINARY_OP_IMPL(SUB, SUB)
-BINARY_OP_IMPL(MUL, MUL)
 BINARY_OP_IMPL(DIV, DIV)
 BINARY_OP_IMPL(MOD, MOD)
 BINARY_OP_IMPL(POW, POW)
 
-BINARY_OP_B_IMPL(SUB, SUB)
-BINARY_OP_B_IMPL(MUL, MUL)
 BINARY_OP_B_IMPL(DIV, DIV)
 BINARY_OP_B_IMPL(MOD, MOD)
 
@@ -93,36 +131,74 @@ BINARY_OP_B_IMPL(RSHIFT, RSHIFT)
 
 // --- Comparison Ops ---
 
-#define CMP_FAST_IMPL(OP_NAME, OP_ENUM, OPERATOR) \
-    HOT_HANDLER impl_##OP_NAME(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
-        auto [dst, r1, r2] = decode::args<u16, u16, u16>(ip); \
+#define CMP_FAST_IMPL(OP_NAME, B, REG, OPERATOR) \
+    HOT_HANDLER impl_##OP_NAME##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        const uint8_t* op_ip = ip; \
+        auto [dst, r1, r2] = decode::args<REG, REG, REG>(ip); \
         Value& left = regs[r1]; \
         Value& right = regs[r2]; \
         if (left.holds_both<int_t>(right)) [[likely]] { \
             regs[dst] = Value(left.as_int() OPERATOR right.as_int()); \
+            quicken(state, op_ip, OpCode::OP_NAME##B, OpCode::OP_NAME##_II##B); \
         } else [[unlikely]] { \
-            regs[dst] = OperatorDispatcher::find(OpCode::OP_ENUM, left, right)(&state->heap, left, right); \
+            regs[dst] = OperatorDispatcher::find(OpCode::OP_NAME, left, right)(&state->heap, left, right); \
         } \
         return ip; \
     } \
-    HOT_HANDLER impl_##OP_NAME##_B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
-        auto [dst, r1, r2] = decode::args<u8, u8, u8>(ip); \
+    HOT_HANDLER impl_##OP_NAME##_II##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        const uint8_t* op_ip = ip; \
+        auto [dst, r1, r2] = decode::args<REG, REG, REG>(ip); \
         Value& left = regs[r1]; \
         Value& right = regs[r2]; \
-        if (left.holds_both<int_t>(right)) [[likely]] { \
-            regs[dst] = Value(left.as_int() OPERATOR right.as_int()); \
+        if (!left.holds_both<int_t>(right)) [[unlikely]] { \
+            dequicken(state, op_ip, OpCode::OP_NAME##B); \
+            return impl_##OP_NAME##B(op_ip, regs, constants, state); \
+        } \
+        regs[dst] = Value(left.as_int() OPERATOR right.as_int()); \
+        return ip; \
+    }
+
+CMP_FAST_IMPL(EQ, , u16, ==)
+CMP_FAST_IMPL(NEQ, , u16, !=)
+CMP_FAST_IMPL(GT, , u16, >)
+CMP_FAST_IMPL(GE, , u16, >=)
+CMP_FAST_IMPL(LT, , u16, <)
+CMP_FAST_IMPL(LE, , u16, <=)
+
+CMP_FAST_IMPL(EQ, _B, u8, ==)
+CMP_FAST_IMPL(NEQ, _B, u8, !=)
+CMP_FAST_IMPL(GT, _B, u8, >)
+CMP_FAST_IMPL(GE, _B, u8, >=)
+CMP_FAST_IMPL(LT, _B, u8, <)
+CMP_FAST_IMPL(LE, _B, u8, <=)
+
+// EQ/NEQ trên float đi qua OperatorDispatcher (so với epsilon) như bản register
+#define CMP_IMM_IMPL(OP_NAME, B, REG, OPERATOR) \
+    HOT_HANDLER impl_##OP_NAME##_I##B(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) { \
+        auto [dst, r1, imm] = decode::args<REG, REG, i16>(ip); \
+        Value& left = regs[r1]; \
+        if (left.is_int()) [[likely]] { \
+            regs[dst] = Value(left.as_int() OPERATOR static_cast<int_t>(imm)); \
         } else [[unlikely]] { \
-            regs[dst] = OperatorDispatcher::find(OpCode::OP_ENUM, left, right)(&state->heap, left, right); \
+            Value right(static_cast<int_t>(imm)); \
+            regs[dst] = OperatorDispatcher::find(OpCode::OP_NAME, left, right)(&state->heap, left, right); \
         } \
         return ip; \
     }
 
-CMP_FAST_IMPL(EQ, EQ, ==)
-CMP_FAST_IMPL(NEQ, NEQ, !=)
-CMP_FAST_IMPL(GT, GT, >)
-CMP_FAST_IMPL(GE, GE, >=)
-CMP_FAST_IMPL(LT, LT, <)
-CMP_FAST_IMPL(LE, LE, <=)
+CMP_IMM_IMPL(EQ, , u16, ==)
+CMP_IMM_IMPL(NEQ, , u16, !=)
+CMP_IMM_IMPL(GT, , u16, >)
+CMP_IMM_IMPL(GE, , u16, >=)
+CMP_IMM_IMPL(LT, , u16, <)
+CMP_IMM_IMPL(LE, , u16, <=)
+
+CMP_IMM_IMPL(EQ, _B, u8, ==)
+CMP_IMM_IMPL(NEQ, _B, u8, !=)
+CMP_IMM_IMPL(GT, _B, u8, >)
+CMP_IMM_IMPL(GE, _B, u8, >=)
+CMP_IMM_IMPL(LT, _B, u8, <)
+CMP_IMM_IMPL(LE, _B, u8, <=)
 
 // --- Unary Ops ---
 
@@ -255,5 +331,8 @@ HOT_HANDLER impl_DEC_B(const uint8_t* ip, Value* regs, const Value* constants, V
 #undef BINARY_OP_IMPL
 #undef BINARY_OP_B_IMPL
 #undef CMP_FAST_IMPL
+#undef ARITH_FAST_IMPL
+#undef ARITH_IMM_IMPL
+#undef CMP_IMM_IMPL
 
 } // namespace meow::handlers
\ No newline at end of file
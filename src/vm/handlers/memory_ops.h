@@ -91,7 +91,7 @@ static const uint8_t* impl_CLOSE_UPVALUES(const uint8_t* ip, Value* regs, const
     auto [last_reg] = decode::args<u16>(ip);
     
     size_t current_base_idx = regs - state->ctx.stack_;
-    close_upvalues(&state->ctx, current_base_idx + last_reg);
+    close_upvalues(&state->ctx, &state->heap, current_base_idx + last_reg);
     return ip;
 }
 
@@ -51,6 +51,7 @@ static const uint8_t* impl_IMPORT_ALL(const uint8_t* ip, Value* regs, const Valu
     
     if (auto src_mod = mod_val.as_if_module()) {
         state->current_module->import_all_export(src_mod);
+        state->heap.write_barrier_bulk(state->current_module);
     } else [[unlikely]] {
         return ERROR<2>(ip, regs, constants, state, ERR_MODULE, "IMPORT_ALL: Register does not contain a Module");
     }
@@ -105,7 +106,8 @@ static const uint8_t* impl_IMPORT_MODULE(const uint8_t* ip, Value* regs, const V
         main_closure,
         new_base,
         nullptr,
-        ip
+        ip,
+        new_base
     );
     
     state->ctx.current_regs_ = new_base;
@@ -1,6 +1,7 @@
 #pragma once
 #include "vm/handlers/utils.h"
 #include "vm/handlers/flow_ops.h"
+#include "vm/handlers/inline_cache.h"
 #include <meow/core/shape.h>
 #include <meow/core/module.h>
 #include <module/module_manager.h>
@@ -16,49 +17,6 @@ constexpr int ERR_PROP = 40;
 constexpr int ERR_METHOD = 41;
 constexpr int ERR_INHERIT = 42;
 
-static constexpr int IC_CAPACITY = 4;
-
-struct PrimitiveShapes {
-    static inline const Shape* ARRAY  = reinterpret_cast<Shape*>(static_cast<uintptr_t>(0x1));
-    static inline const Shape* STRING = reinterpret_cast<Shape*>(static_cast<uintptr_t>(0x2));
-    static inline const Shape* OBJECT = reinterpret_cast<Shape*>(static_cast<uintptr_t>(0x3));
-};
-
-struct InlineCacheEntry {
-    const Shape* shape;
-    const Shape* transition;
-    uint32_t offset;
-} __attribute__((packed));
-
-struct InlineCache {
-    InlineCacheEntry entries[IC_CAPACITY];
-} __attribute__((packed));
-
-// Helper cập nhật Inline Cache (giữ nguyên logic Move-to-front)
-inline static void update_inline_cache(InlineCache* ic, const Shape* shape, const Shape* transition, uint32_t offset) {
-    for (int i = 0; i < IC_CAPACITY; ++i) {
-        if (ic->entries[i].shape == shape) {
-            if (i > 0) {
-                InlineCacheEntry temp = ic->entries[i];
-                // Move to front
-                std::memmove(&ic->entries[1], &ic->entries[0], i * sizeof(InlineCacheEntry));
-                ic->entries[0] = temp;
-                ic->entries[0].transition = transition;
-                ic->entries[0].offset = offset;
-            } else {
-                ic->entries[0].transition = transition;
-                ic->entries[0].offset = offset;
-            }
-            return;
-        }
-    }
-    // Shift right & Insert new at front
-    std::memmove(&ic->entries[1], &ic->entries[0], (IC_CAPACITY - 1) * sizeof(InlineCacheEntry));
-    ic->entries[0].shape = shape;
-    ic->entries[0].transition = transition;
-    ic->entries[0].offset = offset;
-}
-
 enum class CoreModType { ARRAY, STRING, OBJECT };
 
 [[gnu::always_inline]]
@@ -209,6 +167,7 @@ static const uint8_t* impl_NEW_INSTANCE(const uint8_t* ip, Value* regs, const Va
 
 [[gnu::always_inline]] 
 static const uint8_t* impl_GET_PROP(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
+    const uint8_t* op_ip = ip;
     // 1. Decode Args: 3 * u16 = 6 bytes -> Load u64
     auto [dst, obj_reg, name_idx] = decode::args<u16, u16, u16>(ip);
     
@@ -240,8 +199,9 @@ static const uint8_t* impl_GET_PROP(const uint8_t* ip, Value* regs, const Value*
         instance_t inst = obj.as_instance();
         Shape* current_shape = inst->get_shape();
 
-        // IC Hit (Slot 0)
+        // IC Hit (Slot 0). Site chỉ từng thấy một shape -> GET_PROP_MONO
         if (ic->entries[0].shape == current_shape) {
+            if (!ic->entries[1].shape) quicken(state, op_ip, OpCode::GET_PROP, OpCode::GET_PROP_MONO);
             regs[dst] = inst->get_field_at(ic->entries[0].offset);
             return ip;
         }
@@ -258,6 +218,7 @@ static const uint8_t* impl_GET_PROP(const uint8_t* ip, Value* regs, const Value*
         int offset = current_shape->get_offset(name);
         if (offset != -1) {
             update_inline_cache(ic, current_shape, nullptr, static_cast<uint32_t>(offset));
+            if (!ic->entries[1].shape) quicken(state, op_ip, OpCode::GET_PROP, OpCode::GET_PROP_MONO);
             regs[dst] = inst->get_field_at(offset);
             return ip;
         }
@@ -330,6 +291,27 @@ static const uint8_t* impl_GET_PROP(const uint8_t* ip, Value* regs, const Value*
                             "Property '{}' not found on type '{}'.", name->c_str(), to_string(obj));
 }
 
+// GET_PROP đã quicken: instance cùng shape với IC slot 0, ngoài ra de-quicken về GET_PROP
+[[gnu::always_inline]] 
+static const uint8_t* impl_GET_PROP_MONO(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
+    const uint8_t* op_ip = ip;
+    auto [dst, obj_reg, name_idx] = decode::args<u16, u16, u16>(ip);
+    (void)name_idx;
+    const InlineCache* ic = decode::as_struct<InlineCache>(ip);
+
+    Value& obj = regs[obj_reg];
+    if (obj.is_instance()) [[likely]] {
+        instance_t inst = obj.as_instance();
+        if (inst->get_shape() == ic->entries[0].shape) [[likely]] {
+            regs[dst] = inst->get_field_at(ic->entries[0].offset);
+            return ip;
+        }
+    }
+
+    dequicken(state, op_ip, OpCode::GET_PROP);
+    return impl_GET_PROP(op_ip, regs, constants, state);
+}
+
 [[gnu::always_inline]] 
 static const uint8_t* impl_SET_PROP(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
     // 1. Decode: 3 * u16 = 6 bytes -> Load u64
@@ -428,6 +410,7 @@ static const uint8_t* impl_INHERIT(const uint8_t* ip, Value* regs, const Value*
     }
     
     sub_val.as_class()->set_super(super_val.as_class());
+    state->heap.write_barrier(sub_val.as_class(), super_val);
     return ip;
 }
 
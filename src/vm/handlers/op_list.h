@@ -0,0 +1,86 @@
+// Danh sách opcode có handler riêng (handlers::impl_NAME), dùng chung cho bảng dispatch của
+// Interpreter (vm/interpreter.cpp) và bảng stencil của baseline JIT (jit/runtime/stencils.cpp).
+// Thêm opcode mới: thêm vào đây là cả hai bảng cùng có; superinstruction nằm riêng ở super_ops.h.
+//
+// X(NAME) : handlers::impl_NAME
+
+#pragma once
+
+#define MEOW_HANDLER_OPS(X) \
+    X(NOP) \
+    /* --- CORE OPS (Standard 16-bit regs) --- */ \
+    X(LOAD_CONST) X(LOAD_NULL) X(LOAD_TRUE) X(LOAD_FALSE) \
+    X(LOAD_INT) X(LOAD_FLOAT) X(MOVE) \
+    X(INC) X(DEC) \
+    /* --- MATH (Standard 16-bit regs) --- */ \
+    X(ADD) X(SUB) X(MUL) X(DIV) X(MOD) X(POW) \
+    X(EQ) X(NEQ) X(GT) X(GE) X(LT) X(LE) \
+    X(NEG) X(NOT) \
+    /* --- BITWISE (Standard 16-bit regs) --- */ \
+    X(BIT_AND) X(BIT_OR) X(BIT_XOR) X(BIT_NOT) \
+    X(LSHIFT) X(RSHIFT) \
+    /* --- MEMORY & SCOPE --- */ \
+    X(GET_GLOBAL) X(SET_GLOBAL) \
+    X(GET_UPVALUE) X(SET_UPVALUE) \
+    X(CLOSURE) X(CLOSE_UPVALUES) \
+    /* --- FLOW CONTROL --- */ \
+    X(JUMP) X(JUMP_IF_FALSE) X(JUMP_IF_TRUE) \
+    X(CALL) X(CALL_VOID) X(RETURN) X(HALT) \
+    X(TAIL_CALL) \
+    /* --- DATA STRUCTURES --- */ \
+    X(NEW_ARRAY) X(NEW_HASH) \
+    X(GET_INDEX) X(SET_INDEX) \
+    X(GET_KEYS) X(GET_VALUES) \
+    /* --- OOP --- */ \
+    X(NEW_CLASS) X(NEW_INSTANCE) \
+    X(GET_PROP) X(SET_PROP) X(SET_METHOD) \
+    X(INHERIT) X(GET_SUPER) \
+    X(INVOKE) \
+    /* --- EXCEPTION & MODULE --- */ \
+    X(THROW) X(SETUP_TRY) X(POP_TRY) \
+    X(IMPORT_MODULE) X(EXPORT) X(GET_EXPORT) X(IMPORT_ALL) \
+    /* --- MATH & LOGIC _B (8-bit regs) --- */ \
+    X(ADD_B) X(SUB_B) X(MUL_B) X(DIV_B) X(MOD_B) \
+    X(EQ_B) X(NEQ_B) X(GT_B) X(GE_B) X(LT_B) X(LE_B) \
+    /* --- BITWISE _B (8-bit regs) --- */ \
+    X(BIT_AND_B) X(BIT_OR_B) X(BIT_XOR_B) X(BIT_NOT_B) \
+    X(LSHIFT_B) X(RSHIFT_B) \
+    /* --- UNARY & DATA _B (8-bit regs) --- */ \
+    X(INC_B) X(DEC_B) \
+    X(NEG_B) X(NOT_B) \
+    X(MOVE_B) X(LOAD_CONST_B) X(LOAD_INT_B) X(LOAD_FLOAT_B) \
+    X(LOAD_NULL_B) X(LOAD_TRUE_B) X(LOAD_FALSE_B) \
+    /* --- FLOW CONTROL _B (8-bit regs) --- */ \
+    X(JUMP_IF_TRUE_B) X(JUMP_IF_FALSE_B) \
+    /* --- FUSED COMPARE & JUMP --- */ \
+    X(JUMP_IF_EQ) X(JUMP_IF_NEQ) \
+    X(JUMP_IF_GT) X(JUMP_IF_GE) \
+    X(JUMP_IF_LT) X(JUMP_IF_LE) \
+    X(JUMP_IF_EQ_B) X(JUMP_IF_NEQ_B) \
+    X(JUMP_IF_GT_B) X(JUMP_IF_GE_B) \
+    X(JUMP_IF_LT_B) X(JUMP_IF_LE_B) \
+    /* --- QUICKENED (handler generic tự ghi đè, xem handlers/quickening.h) --- */ \
+    X(ADD_II) X(SUB_II) X(MUL_II) X(ADD_FF) X(SUB_FF) X(MUL_FF) \
+    X(ADD_II_B) X(SUB_II_B) X(MUL_II_B) X(ADD_FF_B) X(SUB_FF_B) X(MUL_FF_B) \
+    X(EQ_II) X(NEQ_II) X(GT_II) X(GE_II) X(LT_II) X(LE_II) \
+    X(EQ_II_B) X(NEQ_II_B) X(GT_II_B) X(GE_II_B) X(LT_II_B) X(LE_II_B) \
+    X(JUMP_IF_EQ_II) X(JUMP_IF_NEQ_II) \
+    X(JUMP_IF_GT_II) X(JUMP_IF_GE_II) \
+    X(JUMP_IF_LT_II) X(JUMP_IF_LE_II) \
+    X(JUMP_IF_EQ_II_B) X(JUMP_IF_NEQ_II_B) \
+    X(JUMP_IF_GT_II_B) X(JUMP_IF_GE_II_B) \
+    X(JUMP_IF_LT_II_B) X(JUMP_IF_LE_II_B) \
+    X(GET_PROP_MONO) \
+    /* --- REGISTER WINDOW (masm chọn thay CALL / CALL_VOID) --- */ \
+    X(CALL_WINDOW) X(CALL_VOID_WINDOW) \
+    /* --- IMMEDIATE (hằng int16 trong lệnh, masm gộp từ LOAD_INT) --- */ \
+    X(ADD_I) X(SUB_I) X(MUL_I) \
+    X(ADD_I_B) X(SUB_I_B) X(MUL_I_B) \
+    X(EQ_I) X(NEQ_I) X(GT_I) X(GE_I) X(LT_I) X(LE_I) \
+    X(EQ_I_B) X(NEQ_I_B) X(GT_I_B) X(GE_I_B) X(LT_I_B) X(LE_I_B) \
+    X(JUMP_IF_EQ_I) X(JUMP_IF_NEQ_I) \
+    X(JUMP_IF_GT_I) X(JUMP_IF_GE_I) \
+    X(JUMP_IF_LT_I) X(JUMP_IF_LE_I) \
+    X(JUMP_IF_EQ_I_B) X(JUMP_IF_NEQ_I_B) \
+    X(JUMP_IF_GT_I_B) X(JUMP_IF_GE_I_B) \
+    X(JUMP_IF_LT_I_B) X(JUMP_IF_LE_I_B)
@@ -0,0 +1,47 @@
+/**
+ * @file quickening.h
+ * @brief Quickening: handler generic ghi đè opcode của chính nó bằng bản chuyên biệt theo kiểu vừa thấy
+ *
+ * ADD -> ADD_II / ADD_FF, LT -> LT_II, JUMP_IF_LT -> JUMP_IF_LT_II, GET_PROP -> GET_PROP_MONO...
+ * Bản quickened cùng layout với bản generic, chỉ kiểm kiểu rồi làm thẳng; sai kiểu thì ghi lại
+ * opcode generic (de-quicken) và chạy đường generic. Ai đọc bytecode ngoài Interpreter dùng generic_op().
+ */
+
+#pragma once
+
+#include "vm/handlers/utils.h"
+
+namespace meow::handlers {
+
+    static constexpr bool ENABLE_QUICKENING = true;
+
+    // Quá số lần de-quicken này thì handler generic của proto thôi quicken (site đa hình không ping-pong mãi)
+    static constexpr uint32_t QUICKEN_MAX_MISSES = 16;
+
+    // ip trỏ ngay sau opcode (như lúc handler được gọi)
+    [[gnu::always_inline]]
+    inline static void rewrite_op(const uint8_t* ip, OpCode op) {
+        *const_cast<uint8_t*>(ip - 1) = static_cast<uint8_t>(op);
+    }
+
+    // Chỉ ghi đè khi opcode trong bytecode đúng là bản generic `from`: handler chạy bên trong
+    // superinstruction (opcode là SUPER_*) hay đã được quicken thì giữ nguyên.
+    // Bản stencil của baseline JIT luôn gọi handler generic: ghi đè chỉ tốn thêm một store mỗi lệnh
+    [[gnu::always_inline]]
+    inline static void quicken([[maybe_unused]] VMState* state, [[maybe_unused]] const uint8_t* ip,
+                               [[maybe_unused]] OpCode from, [[maybe_unused]] OpCode to) {
+#ifndef MEOW_JIT_STENCILS
+        if constexpr (ENABLE_QUICKENING) {
+            if (ip[-1] != static_cast<uint8_t>(from)) return;
+            if (state->ctx.frame_ptr_->function_->get_proto()->get_dequicken_count() < QUICKEN_MAX_MISSES) rewrite_op(ip, to);
+        }
+#endif
+    }
+
+    [[gnu::cold, gnu::noinline]]
+    inline static void dequicken(VMState* state, const uint8_t* ip, OpCode generic) {
+        rewrite_op(ip, generic);
+        state->ctx.frame_ptr_->function_->get_proto()->record_dequicken();
+    }
+
+} // namespace meow::handlers
@@ -6,6 +6,11 @@
 #include "vm/handlers/oop_ops.h"
 #include "vm/handlers/module_ops.h"
 #include "vm/handlers/exception_ops.h"
+#include "vm/handlers/op_list.h"
+#include <meow/diagnostics/ngram_profile.h>
+#include <meow/diagnostics/op_profile.h>
+#include <meow/diagnostics/sampling_profile.h>
+#include <algorithm>
 
 namespace meow {
 
@@ -13,12 +18,28 @@ namespace {
     using OpHandler = void (*)(const uint8_t*, Value*, const Value*, VMState*);
     using OpImpl    = const uint8_t* (*)(const uint8_t*, Value*, const Value*, VMState*);
 
-    static OpHandler dispatch_table[256];
+    // Kiểu bảng dispatch: Timed vẫn dispatch qua dispatch_table (bảng đo được chép đè lên khi bật)
+    enum class Mode { Normal, Ngram, Timed };
 
+    static OpHandler dispatch_table[256];
+    static OpHandler normal_table[256];
+    // --profile-ngrams: đếm n-gram trước mỗi lệnh, superinstruction chỉ chạy lệnh đầu (lệnh sau dispatch riêng)
+    static OpHandler ngram_table[256];
+    // --profile-ops / system.profile(): đo count + TSC từng opcode
+    static OpHandler timed_table[256];
+    // Bảng đang dùng (normal / timed): stub lấy mẫu chép lại bảng này
+    static const OpHandler* volatile active_table = normal_table;
+
+    template <Mode M = Mode::Normal>
     [[gnu::always_inline, gnu::hot]]
     static void dispatch(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
+        if constexpr (M == Mode::Ngram) diagnostics::record_ngram(ip);
         uint8_t opcode = *ip++;
-        [[clang::musttail]] return dispatch_table[opcode](ip, regs, constants, state);
+        if constexpr (M == Mode::Ngram) {
+            [[clang::musttail]] return ngram_table[opcode](ip, regs, constants, state);
+        } else {
+            [[clang::musttail]] return dispatch_table[opcode](ip, regs, constants, state);
+        }
     }
 
     template <OpCode Op>
@@ -26,112 +47,168 @@ namespace {
 
     template <> constexpr bool IsFrameChange<OpCode::CALL>          = true;
     template <> constexpr bool IsFrameChange<OpCode::CALL_VOID>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::CALL_WINDOW>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::CALL_VOID_WINDOW> = true;
     template <> constexpr bool IsFrameChange<OpCode::TAIL_CALL>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::INVOKE>        = true;
     template <> constexpr bool IsFrameChange<OpCode::RETURN>        = true;
     template <> constexpr bool IsFrameChange<OpCode::IMPORT_MODULE> = true;
     template <> constexpr bool IsFrameChange<OpCode::THROW>         = true; 
+
+    // Nhảy ngược có thể OSR vào mã máy và chạy xong cả frame -> quay về caller
+    template <> constexpr bool IsFrameChange<OpCode::JUMP>            = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_TRUE>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_FALSE>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_TRUE_B>  = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_FALSE_B> = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_EQ>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_NEQ>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LT>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LE>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GT>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GE>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_EQ_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_NEQ_B>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LT_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LE_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GT_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GE_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_EQ_II>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_NEQ_II>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LT_II>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LE_II>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GT_II>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GE_II>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_EQ_II_B>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_NEQ_II_B>  = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LT_II_B>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LE_II_B>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GT_II_B>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GE_II_B>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_EQ_I>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_NEQ_I>     = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LT_I>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LE_I>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GT_I>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GE_I>      = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_EQ_I_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_NEQ_I_B>   = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LT_I_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_LE_I_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GT_I_B>    = true;
+    template <> constexpr bool IsFrameChange<OpCode::JUMP_IF_GE_I_B>    = true;
+
+    // Superinstruction đổi frame nếu một lệnh bất kỳ trong chuỗi đổi frame
+    #define MEOW_SUPER_FRAME2(NAME, A, A_BYTES, B) \
+        template <> constexpr bool IsFrameChange<OpCode::NAME> = IsFrameChange<OpCode::A> || IsFrameChange<OpCode::B>;
+    #define MEOW_SUPER_FRAME3(NAME, A, A_BYTES, B, B_BYTES, C) \
+        template <> constexpr bool IsFrameChange<OpCode::NAME> = \
+            IsFrameChange<OpCode::A> || IsFrameChange<OpCode::B> || IsFrameChange<OpCode::C>;
+    MEOW_SUPER_OPS(MEOW_SUPER_FRAME2, MEOW_SUPER_FRAME3)
+    #undef MEOW_SUPER_FRAME2
+    #undef MEOW_SUPER_FRAME3
     
-    template <OpCode Op, OpImpl ImplFn>
+    template <OpCode Op, OpImpl ImplFn, Mode M = Mode::Normal>
     static void op_wrapper(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
-        const uint8_t* next_ip = ImplFn(ip, regs, constants, state);
+        const uint8_t* next_ip;
+        if constexpr (M == Mode::Timed) {
+            if (diagnostics::detail::op_per_site) [[unlikely]] {
+                diagnostics::record_op_site(state->ctx.frame_ptr_->function_->get_proto(), ip - 1);
+            }
+            const uint64_t start = diagnostics::op_clock();
+            next_ip = ImplFn(ip, regs, constants, state);
+            diagnostics::record_op(static_cast<uint8_t>(Op), diagnostics::op_clock() - start);
+        } else {
+            next_ip = ImplFn(ip, regs, constants, state);
+        }
+        // Về lại frame của caller: nếu caller có mã baseline thì chạy tiếp bằng mã máy
+        if constexpr (Op == OpCode::RETURN) {
+            if (next_ip) [[likely]] next_ip = handlers::try_resume_jit(state, next_ip);
+        }
         if (next_ip) [[likely]] {
             if constexpr (IsFrameChange<Op>) {
                 regs = state->registers;
                 constants = state->constants;
             }
-            [[clang::musttail]] return dispatch(next_ip, regs, constants, state);
+            [[clang::musttail]] return dispatch<M>(next_ip, regs, constants, state);
         }
     }
 
+    // Một lệnh trong superinstruction: Bytes = operand_bytes của lệnh (bỏ qua ở lệnh cuối)
+    template <OpCode Op, OpImpl ImplFn, size_t Bytes = 0>
+    struct Step {
+        static constexpr OpCode op = Op;
+        static constexpr OpImpl impl = ImplFn;
+        static constexpr size_t bytes = Bytes;
+    };
+
+    // Chạy liền các handler của chuỗi, bỏ qua opcode của lệnh sau (vẫn nằm trong bytecode).
+    // Lệnh trước nhảy / gọi hàm / lỗi (IP trả về khác lệnh kế) -> dừng chuỗi, dispatch như thường.
+    template <typename First, typename... Rest>
+    [[gnu::always_inline]]
+    static const uint8_t* run_super(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
+        const uint8_t* next_ip = First::impl(ip, regs, constants, state);
+        if constexpr (sizeof...(Rest) == 0) {
+            return next_ip;
+        } else {
+            if (next_ip != ip + First::bytes) [[unlikely]] return next_ip;
+            if constexpr (IsFrameChange<First::op>) {
+                regs = state->registers;
+                constants = state->constants;
+            }
+            return run_super<Rest...>(next_ip + 1, regs, constants, state);
+        }
+    }
+
+    // SIGPROF đã chép stub này lên mọi ô của dispatch_table: trả bảng cũ, lấy mẫu stack rồi chạy lệnh
+    static void sample_stub(const uint8_t* ip, Value* regs, const Value* constants, VMState* state) {
+        std::copy(active_table, active_table + 256, dispatch_table);
+        diagnostics::record_sample(state->ctx, ip - 1);
+        [[clang::musttail]] return dispatch(ip - 1, regs, constants, state);
+    }
+
+    // Danh sách handler được baseline JIT dùng lại (jit/runtime/stencils.cpp): thêm opcode thì đăng ký ở cả hai nơi
     struct TableInitializer {
         TableInitializer() {
             for (int i = 0; i < 256; ++i) {
                 dispatch_table[i] = op_wrapper<OpCode::HALT, handlers::impl_UNIMPL>;
+                ngram_table[i] = op_wrapper<OpCode::HALT, handlers::impl_UNIMPL, Mode::Ngram>;
+                timed_table[i] = op_wrapper<OpCode::HALT, handlers::impl_UNIMPL, Mode::Timed>;
             }
 
-            // Macro helper để đăng ký nhanh
-            #define reg(NAME) dispatch_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, handlers::impl_##NAME>
-            
-            reg(NOP);
-
-            // --- CORE OPS (Standard 16-bit regs) ---
-            reg(LOAD_CONST); reg(LOAD_NULL); reg(LOAD_TRUE); reg(LOAD_FALSE);
-            reg(LOAD_INT); reg(LOAD_FLOAT); reg(MOVE);
-            reg(INC); reg(DEC);
-
-            // --- MATH (Standard 16-bit regs) ---
-            reg(ADD); reg(SUB); reg(MUL); reg(DIV); reg(MOD); reg(POW);
-            reg(EQ); reg(NEQ); reg(GT); reg(GE); reg(LT); reg(LE);
-            reg(NEG); reg(NOT);
-            
-            // --- BITWISE (Standard 16-bit regs) ---
-            reg(BIT_AND); reg(BIT_OR); reg(BIT_XOR); reg(BIT_NOT);
-            reg(LSHIFT); reg(RSHIFT);
-
-            // --- MEMORY & SCOPE ---
-            reg(GET_GLOBAL); reg(SET_GLOBAL);
-            reg(GET_UPVALUE); reg(SET_UPVALUE);
-            reg(CLOSURE); reg(CLOSE_UPVALUES);
-
-            // --- FLOW CONTROL ---
-            reg(JUMP); reg(JUMP_IF_FALSE); reg(JUMP_IF_TRUE);
-            reg(CALL); reg(CALL_VOID); reg(RETURN); reg(HALT);
-            reg(TAIL_CALL);
-
-            // --- DATA STRUCTURES ---
-            reg(NEW_ARRAY); reg(NEW_HASH);
-            reg(GET_INDEX); reg(SET_INDEX);
-            reg(GET_KEYS); reg(GET_VALUES);
-
-            // --- OOP ---
-            reg(NEW_CLASS); reg(NEW_INSTANCE);
-            reg(GET_PROP); reg(SET_PROP); reg(SET_METHOD);
-            reg(INHERIT); reg(GET_SUPER);
-            reg(INVOKE);
-
-            // --- EXCEPTION & MODULE ---
-            reg(THROW); reg(SETUP_TRY); reg(POP_TRY);
-            reg(IMPORT_MODULE); reg(EXPORT); reg(GET_EXPORT); reg(IMPORT_ALL);
-
-            // ============================================================
-            //                 OPTIMIZED OPCODES (Byte Operands)
-            // ============================================================
-
-            // --- OPT 1: MATH & LOGIC _B (8-bit regs) ---
-            reg(ADD_B); reg(SUB_B); reg(MUL_B); reg(DIV_B); reg(MOD_B);
-            reg(EQ_B); reg(NEQ_B); reg(GT_B); reg(GE_B); reg(LT_B); reg(LE_B);
-            
-            // --- OPT 2: BITWISE _B (8-bit regs) ---
-            reg(BIT_AND_B); reg(BIT_OR_B); reg(BIT_XOR_B); reg(BIT_NOT_B);
-            reg(LSHIFT_B); reg(RSHIFT_B);
-
-            // --- OPT 3: UNARY & DATA _B (8-bit regs) ---
-            reg(INC_B); reg(DEC_B);
-            reg(NEG_B); reg(NOT_B);
-            
-            // Các lệnh di chuyển & nạp dữ liệu tối ưu
-            reg(MOVE_B); 
-            reg(LOAD_CONST_B);
-            reg(LOAD_INT_B);
-            reg(LOAD_FLOAT_B);
-            reg(LOAD_NULL_B);
-            reg(LOAD_TRUE_B);
-            reg(LOAD_FALSE_B);
-
-            // --- OPT 4: FLOW CONTROL _B (8-bit regs) ---
-            reg(JUMP_IF_TRUE_B); reg(JUMP_IF_FALSE_B);
-
-            // --- OPT 5: FUSED COMPARE & JUMP (Standard 16-bit) ---
-            reg(JUMP_IF_EQ); reg(JUMP_IF_NEQ);
-            reg(JUMP_IF_GT); reg(JUMP_IF_GE);
-            reg(JUMP_IF_LT); reg(JUMP_IF_LE);
-
-            // --- OPT 6: FUSED COMPARE & JUMP _B (8-bit regs) ---
-            reg(JUMP_IF_EQ_B); reg(JUMP_IF_NEQ_B);
-            reg(JUMP_IF_GT_B); reg(JUMP_IF_GE_B);
-            reg(JUMP_IF_LT_B); reg(JUMP_IF_LE_B);
+            // Mọi opcode có handler riêng (vm/handlers/op_list.h, dùng chung với bảng stencil của JIT)
+            #define reg(NAME) \
+                dispatch_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, handlers::impl_##NAME>; \
+                ngram_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, handlers::impl_##NAME, Mode::Ngram>; \
+                timed_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, handlers::impl_##NAME, Mode::Timed>;
+
+            MEOW_HANDLER_OPS(reg)
 
             #undef reg
+
+            // --- SUPERINSTRUCTION (include/meow/bytecode/super_ops.h, sinh bởi meow-supergen) ---
+            // Bản đo tính cả chuỗi vào opcode SUPER_*
+            #define reg_super2(NAME, A, A_BYTES, B) \
+                dispatch_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, run_super< \
+                    Step<OpCode::A, handlers::impl_##A, A_BYTES>, Step<OpCode::B, handlers::impl_##B>>>; \
+                timed_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, run_super< \
+                    Step<OpCode::A, handlers::impl_##A, A_BYTES>, Step<OpCode::B, handlers::impl_##B>>, Mode::Timed>; \
+                ngram_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, handlers::impl_##A, Mode::Ngram>;
+            #define reg_super3(NAME, A, A_BYTES, B, B_BYTES, C) \
+                dispatch_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, run_super< \
+                    Step<OpCode::A, handlers::impl_##A, A_BYTES>, Step<OpCode::B, handlers::impl_##B, B_BYTES>, \
+                    Step<OpCode::C, handlers::impl_##C>>>; \
+                timed_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, run_super< \
+                    Step<OpCode::A, handlers::impl_##A, A_BYTES>, Step<OpCode::B, handlers::impl_##B, B_BYTES>, \
+                    Step<OpCode::C, handlers::impl_##C>>, Mode::Timed>; \
+                ngram_table[static_cast<size_t>(OpCode::NAME)] = op_wrapper<OpCode::NAME, handlers::impl_##A, Mode::Ngram>;
+
+            MEOW_SUPER_OPS(reg_super2, reg_super3)
+
+            #undef reg_super2
+            #undef reg_super3
+
+            std::copy(std::begin(dispatch_table), std::end(dispatch_table), normal_table);
         }
     };
 
@@ -139,6 +216,16 @@ namespace {
 
 } // namespace anonymous
 
+void Interpreter::select_dispatch(bool timed) noexcept {
+    active_table = timed ? timed_table : normal_table;
+    std::copy(active_table, active_table + 256, dispatch_table);
+}
+
+// Gọi trong signal handler: chỉ ghi con trỏ, không cấp phát / khóa
+void Interpreter::arm_sample() noexcept {
+    for (auto& handler : dispatch_table) handler = sample_stub;
+}
+
 void Interpreter::run(VMState state) noexcept {
     MemoryManager::set_current(&state.heap);
     if (!state.ctx.current_frame_) return;
@@ -149,6 +236,7 @@ void Interpreter::run(VMState state) noexcept {
     const Value* constants = state.constants;
     const uint8_t* ip = state.ctx.current_frame_->ip_;
     
+    if (diagnostics::ngram_profile_enabled()) [[unlikely]] return dispatch<Mode::Ngram>(ip, regs, constants, &state);
     dispatch(ip, regs, constants, &state);
 }
 
@@ -8,6 +8,12 @@ namespace meow {
 class Interpreter {
 public:
     static void run(VMState state) noexcept;
+
+    // true: chép bảng dispatch có đo (diagnostics/op_profile.h) đè lên bảng thường, false: trả lại
+    static void select_dispatch(bool timed) noexcept;
+
+    // Signal-safe: lệnh kế tiếp đi qua stub lấy mẫu stack (diagnostics/sampling_profile.h)
+    static void arm_sample() noexcept;
 };
 
 }
\ No newline at end of file
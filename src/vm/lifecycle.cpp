@@ -60,6 +60,7 @@ bool Machine::prepare() noexcept {
     
     if (native_res.ok()) [[likely]] {
         main_module->import_all_global(native_res.value());
+        heap_->write_barrier_bulk(main_module);
     } else {
         std::println("Warning: Could not inject 'native' module. Standard library may be missing.");
     }
@@ -79,7 +80,8 @@ bool Machine::prepare() noexcept {
         main_func, 
         context_->stack_,
         nullptr,
-        main_proto->get_chunk().get_code()
+        main_proto->get_chunk().get_code(),
+        context_->stack_
     );
 
     context_->current_regs_ = context_->stack_;
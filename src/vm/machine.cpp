@@ -67,7 +67,8 @@ Value Machine::call_callable(Value callable, const std::vector<Value>& args) noe
         closure,
         base,
         &return_val,
-        proto->get_chunk().get_code()
+        proto->get_chunk().get_code(),
+        base
     );
 
     context_->current_regs_ = base;
@@ -108,7 +109,8 @@ void Machine::execute(function_t func) {
         func, 
         context_->stack_, 
         nullptr,          
-        proto->get_chunk().get_code()
+        proto->get_chunk().get_code(),
+        context_->stack_
     );
 
     context_->current_regs_ = context_->stack_;
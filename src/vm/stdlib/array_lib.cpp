@@ -29,6 +29,7 @@ static Value push(Machine* vm, int argc, Value* argv) {
 
     for (int i = 1; i < argc; ++i) {
         self->push(argv[i]);
+        vm->get_heap()->write_barrier(self, argv[i]);
     }
     return Value((int64_t)self->size());
 }
@@ -92,6 +93,7 @@ static Value resize(Machine* vm, int argc, Value* argv) {
         for(size_t i = old_size; i < new_size; ++i) {
             self->set(i, fill_val);
         }
+        vm->get_heap()->write_barrier(self, fill_val);
     }
 
     return Value(null_t{});
@@ -5,6 +5,7 @@
 #include <meow/memory/memory_manager.h>
 #include <meow/cast.h>
 #include <meow/core/module.h>
+#include <meow/diagnostics/op_profile.h>
 
 namespace meow::natives::sys {
 
@@ -51,6 +52,29 @@ static Value get_env(Machine* vm, int argc, Value* argv) {
     return Value(null_t{});
 }
 
+// system.profile(enabled, [per_site]) -> bật / tắt profiler theo opcode, lệnh kế tiếp đã đổi bảng dispatch
+static Value set_profile(Machine*, int argc, Value* argv) {
+    bool enabled = argc > 0 && to_bool(argv[0]);
+    bool per_site = argc > 1 && to_bool(argv[1]);
+    diagnostics::set_op_profile(enabled, per_site);
+    return Value(null_t{});
+}
+
+// system.profile_report([format]) -> string, format = "table" (mặc định) | "json"
+static Value profile_report(Machine* vm, int argc, Value* argv) {
+    auto format = diagnostics::ProfileFormat::Table;
+    if (argc > 0 && argv[0].is_string() && std::string_view(argv[0].as_string()->c_str()) == "json") {
+        format = diagnostics::ProfileFormat::Json;
+    }
+    return Value(vm->get_heap()->new_string(diagnostics::op_profile_report(format)));
+}
+
+// system.profile_reset()
+static Value profile_reset(Machine*, int, Value*) {
+    diagnostics::reset_op_profile();
+    return Value(null_t{});
+}
+
 } // namespace meow::natives::sys
 
 namespace meow::stdlib {
@@ -69,6 +93,9 @@ module_t create_system_module(Machine* vm, MemoryManager* heap) noexcept {
     reg("exec", exec_cmd);
     reg("time", time_now);
     reg("env", get_env);
+    reg("profile", set_profile);
+    reg("profile_report", profile_report);
+    reg("profile_reset", profile_reset);
 
     return mod;
 }
@@ -57,12 +57,11 @@ struct VMState {
     inline void update_pointers() noexcept {
         registers = ctx.current_regs_;
         
-        auto proto = ctx.frame_ptr_->function_->get_proto();
-        
-        constants = proto->get_chunk().get_constants_raw();
-        instruction_base = proto->get_chunk().get_code();
-        
-        current_module = proto->get_module();
+        // Cache trong CallFrame: một lần load thay vì function -> proto -> chunk
+        const CallFrame* frame = ctx.frame_ptr_;
+        constants = frame->constants_;
+        instruction_base = frame->code_;
+        current_module = frame->module_;
     }
 
     [[gnu::always_inline]] 